@@ -9,7 +9,9 @@ void X(destroy_triangular_banded)(X(triangular_banded) * A) {
 }
 
 void X(destroy_tb_eigen_FMM)(X(tb_eigen_FMM) * F) {
-    if (F->n < TB_EIGEN_BLOCKSIZE) {
+    if (F->T != NULL)
+        X(destroy_triangular_banded)(F->T);
+    else if (F->n < TB_EIGEN_BLOCKSIZE) {
         free(F->V);
         free(F->lambda);
     }
@@ -28,7 +30,9 @@ void X(destroy_tb_eigen_FMM)(X(tb_eigen_FMM) * F) {
 
 size_t X(summary_size_tb_eigen_FMM)(X(tb_eigen_FMM) * F) {
     size_t S = 0;
-    if (F->n < TB_EIGEN_BLOCKSIZE)
+    if (F->T != NULL)
+        S += sizeof(FLT)*F->n*(F->T->b+1);
+    else if (F->n < TB_EIGEN_BLOCKSIZE)
         S += sizeof(FLT)*F->n*(F->n+1);
     else {
         S += X(summary_size_hierarchicalmatrix)(F->F0);
@@ -39,6 +43,16 @@ size_t X(summary_size_tb_eigen_FMM)(X(tb_eigen_FMM) * F) {
     return S;
 }
 
+// The number of entries of scratch that X(bfmv_work) and X(bfsv_work) need. The temporaries
+// of a level are dead by the time its children run, so the children share them.
+int X(work_size_tb_eigen_FMM)(X(tb_eigen_FMM) * F) {
+    if (F->T != NULL || F->n < TB_EIGEN_BLOCKSIZE)
+        return 0;
+    int W = F->n + X(work_size_hierarchicalmatrix)(F->F0);
+    W = MAX(W, X(work_size_tb_eigen_FMM)(F->F1));
+    return MAX(W, X(work_size_tb_eigen_FMM)(F->F2));
+}
+
 X(banded) * X(malloc_banded)(const int m, const int n, const int l, const int u) {
     FLT * data = malloc(n*(l+u+1)*sizeof(FLT));
     X(banded) * A = malloc(sizeof(X(banded)));
@@ -212,19 +226,43 @@ void X(triangular_banded_eigenvalues)(X(triangular_banded) * A, X(triangular_ban
         lambda[j] = X(get_triangular_banded_index)(A, j, j)/X(get_triangular_banded_index)(B, j, j);
 }
 
+static inline void X(triangular_banded_eigenvector)(X(triangular_banded) * A, X(triangular_banded) * B, FLT * V, const int j, const int b) {
+    int n = A->n;
+    FLT t, lam = X(get_triangular_banded_index)(A, j, j)/X(get_triangular_banded_index)(B, j, j);
+    for (int i = j-1; i >= 0; i--) {
+        t = 0;
+        for (int k = i+1; k < MIN(i+b+1, n); k++)
+            t += (X(get_triangular_banded_index)(A, i, k) - lam*X(get_triangular_banded_index)(B, i, k))*V[k+j*n];
+        V[i+j*n] = t/(lam*X(get_triangular_banded_index)(B, i, i) - X(get_triangular_banded_index)(A, i, i));
+    }
+}
+
+// The columns are independent, so large problems spread them over the threads as tasks. These
+// join the enclosing team if there is one, so that several plans may be built concurrently.
+static void X(triangular_banded_eigenvectors_tasks)(X(triangular_banded) * A, X(triangular_banded) * B, FLT * V, const int j0, const int b) {
+    #pragma omp taskloop grainsize(TB_EIGEN_BLOCKSIZE/4)
+    for (int j = A->n-1; j >= j0; j--)
+        X(triangular_banded_eigenvector)(A, B, V, j, b);
+}
+
 // Assumes eigenvectors are initialized by V[i,j] = 0 for i > j and V[j,j] ≠ 0.
 void X(triangular_banded_eigenvectors)(X(triangular_banded) * A, X(triangular_banded) * B, FLT * V) {
+    X(triangular_banded_eigenvectors_columns)(A, B, V, 1);
+}
+
+// Only the columns j0 <= j < n, such as those that extend a plan of degree j0.
+void X(triangular_banded_eigenvectors_columns)(X(triangular_banded) * A, X(triangular_banded) * B, FLT * V, const int j0) {
     int n = A->n, b1 = A->b, b2 = B->b;
-    int b = MAX(b1, b2);
-    FLT t, lam;
-    for (int j = 1; j < n; j++) {
-        lam = X(get_triangular_banded_index)(A, j, j)/X(get_triangular_banded_index)(B, j, j);
-        for (int i = j-1; i >= 0; i--) {
-            t = 0;
-            for (int k = i+1; k < MIN(i+b+1, n); k++)
-                t += (X(get_triangular_banded_index)(A, i, k) - lam*X(get_triangular_banded_index)(B, i, k))*V[k+j*n];
-            V[i+j*n] = t/(lam*X(get_triangular_banded_index)(B, i, i) - X(get_triangular_banded_index)(A, i, i));
-        }
+    int b = MAX(b1, b2), j1 = MAX(j0, 1);
+    if (n-j1 < TB_EIGEN_BLOCKSIZE)
+        for (int j = j1; j < n; j++)
+            X(triangular_banded_eigenvector)(A, B, V, j, b);
+    else if (FT_IN_PARALLEL())
+        X(triangular_banded_eigenvectors_tasks)(A, B, V, j1, b);
+    else {
+        #pragma omp parallel
+        #pragma omp single
+        X(triangular_banded_eigenvectors_tasks)(A, B, V, j1, b);
     }
 }
 
@@ -252,10 +290,13 @@ void X(triangular_banded_eigenvectors_3arg)(X(triangular_banded) * A, X(triangul
     }
 }
 
-X(tb_eigen_FMM) * X(tb_eig_FMM)(X(triangular_banded) * A, X(triangular_banded) * B) {
+X(tb_eigen_FMM) * X(tb_eig_FMM)(X(triangular_banded) * A, X(triangular_banded) * B) {return X(tb_eig_FMM_tol)(A, B, Y(eps)());}
+
+// The Cauchy matrices that couple the halves are resolved to the tolerance tol.
+X(tb_eigen_FMM) * X(tb_eig_FMM_tol)(X(triangular_banded) * A, X(triangular_banded) * B, const FLT tol) {
     int n = A->n, b1 = A->b, b2 = B->b;
     int b = MAX(b1, b2);
-    X(tb_eigen_FMM) * F = malloc(sizeof(X(tb_eigen_FMM)));
+    X(tb_eigen_FMM) * F = calloc(1, sizeof(X(tb_eigen_FMM)));
     if (n < TB_EIGEN_BLOCKSIZE) {
         FLT * V = calloc(n*n, sizeof(FLT));
         for (int i = 0; i < n; i++)
@@ -295,8 +336,8 @@ X(tb_eigen_FMM) * X(tb_eig_FMM)(X(triangular_banded) * A, X(triangular_banded) *
         A2->b = b1;
         B2->b = b2;
 
-        F->F1 = X(tb_eig_FMM)(A1, B1);
-        F->F2 = X(tb_eig_FMM)(A2, B2);
+        F->F1 = X(tb_eig_FMM_tol)(A1, B1, tol);
+        F->F2 = X(tb_eig_FMM_tol)(A2, B2, tol);
 
         FLT * lambda1 = F->F1->lambda;
         FLT * lambda2 = F->F2->lambda;
@@ -328,7 +369,7 @@ X(tb_eigen_FMM) * X(tb_eig_FMM)(X(triangular_banded) * A, X(triangular_banded) *
             for (int i = 0; i < n-s; i++)
                 Y[i+j*(n-s)] = Y[i+j*(n-s)]-Y2[i+j*(n-s)];
 
-        F->F0 = X(sample_hierarchicalmatrix)(X(cauchykernel), lambda1, lambda2, (unitrange) {0, s}, (unitrange) {0, n-s}, 'G');
+        F->F0 = X(sample_hierarchicalmatrix_tol)(X(cauchykernel), lambda1, lambda2, (unitrange) {0, s}, (unitrange) {0, n-s}, 'G', tol);
         F->X = X;
         F->Y = Y;
         F->t1 = calloc(s*FT_GET_MAX_THREADS(), sizeof(FLT));
@@ -344,9 +385,385 @@ X(tb_eigen_FMM) * X(tb_eig_FMM)(X(triangular_banded) * A, X(triangular_banded) *
     return F;
 }
 
+// The columns j0 <= j < j1 of A, with the entries above them.
+static X(triangular_banded) * X(triangular_banded_block)(X(triangular_banded) * A, const int j0, const int j1) {
+    int b = A->b;
+    X(triangular_banded) * A1 = X(calloc_triangular_banded)(j1-j0, b);
+    for (int j = 0; j < j1-j0; j++)
+        for (int k = 0; k < b+1; k++)
+            A1->data[k+j*(b+1)] = A->data[k+(j+j0)*(b+1)];
+    return A1;
+}
+
+// The entries i0 <= i <= j of the eigenvector of AV + BVΛ = CVΩ with v[j] = 1.
+static void X(triangular_banded_eigenvector_3arg)(X(triangular_banded) * A, X(triangular_banded) * B, FLT lam, X(triangular_banded) * C, FLT omeg, FLT * v, const int j, const int i0) {
+    int b1 = A->b, b2 = B->b, b3 = C->b, b = MAX(MAX(b1, b2), b3);
+    FLT * a = A->data, * bb = B->data, * c = C->data, t;
+    v[j] = 1;
+    for (int i = j-1; i >= i0; i--) {
+        t = 0;
+        for (int k = i+1; k <= MIN(i+b, j); k++)
+            t += ((k-i <= b1 ? a[i+(k+1)*b1] : 0) + lam*(k-i <= b2 ? bb[i+(k+1)*b2] : 0) - omeg*(k-i <= b3 ? c[i+(k+1)*b3] : 0))*v[k];
+        v[i] = t/(omeg*c[i+(i+1)*b3] - lam*bb[i+(i+1)*b2] - a[i+(i+1)*b1]);
+    }
+}
+
+// Solves A X = B by Gaussian elimination with partial pivoting, overwriting A and B.
+static void X(gesv)(const int n, FLT * A, FLT * B, const int N) {
+    for (int k = 0; k < n; k++) {
+        int p = k;
+        for (int i = k+1; i < n; i++)
+            if (Y(fabs)(A[i+k*n]) > Y(fabs)(A[p+k*n]))
+                p = i;
+        for (int j = k; j < n; j++) {FLT t = A[k+j*n]; A[k+j*n] = A[p+j*n]; A[p+j*n] = t;}
+        for (int j = 0; j < N; j++) {FLT t = B[k+j*n]; B[k+j*n] = B[p+j*n]; B[p+j*n] = t;}
+        for (int i = k+1; i < n; i++) {
+            FLT l = A[i+k*n]/A[k+k*n];
+            for (int j = k+1; j < n; j++)
+                A[i+j*n] -= l*A[k+j*n];
+            for (int j = 0; j < N; j++)
+                B[i+j*n] -= l*B[k+j*n];
+        }
+    }
+    for (int j = 0; j < N; j++)
+        for (int i = n-1; i >= 0; i--) {
+            for (int k = i+1; k < n; k++)
+                B[i+j*n] -= A[i+k*n]*B[k+j*n];
+            B[i+j*n] /= A[i+i*n];
+        }
+}
+
+/*
+An upper-triangular V = [V₁ V₁₂; 0 V₂] whose coupling V₁₂ is numerically of low rank, but not
+necessarily through a Cauchy matrix, is compressed by an interpolative decomposition: a pivoted QR
+factorization of a sample of its columns gives an orthonormal basis Q, Gaussian elimination on Q
+selects as many rows, and every column of V₁₂ is interpolated from those rows. The coupling
+V₁⁻¹V₁₂ is stored as a single low-rank block F0 with b = 1 and unit X and Y. The columns come from
+column(data, v, j, i0), which sets the entries i0 <= i <= j of the jth column of V in v, and each
+is interpolated to the tolerance relative to its norm. Finding the rows of all columns then costs
+n columns but no more than O(n) storage at a time besides the samples. If block is not NULL, it is
+used instead: block(data, A, idx, m, 'N') sets the m columns idx[k] of V in the n x m array A, and
+block(data, A, idx, m, 'T') its m rows idx[k], so that the samples are computed together and only
+r rows are computed for the interpolation, in O(nr) storage.
+*/
+static void X(tb_lowrank_coupling)(X(tb_eigen_FMM) * F, void (*column)(const void * data, FLT * v, const int j, const int i0), void (*block)(const void * data, FLT * A, const int * idx, const int m, const char TRANS), const void * data, const FLT tol) {
+    int n = F->n, s = n>>1;
+    // Sample columns of V₁₂, half evenly spaced and half geometrically graded towards the diagonal,
+    // until their numerical rank is at most half their number.
+    int nc = MIN(4*BLOCKRANK, n-s), r;
+    int * jc = malloc((n-s)*sizeof(int)), * ip = malloc((n-s)*sizeof(int));
+    FLT * Q = NULL;
+    while (1) {
+        int m = 0;
+        for (int k = 0; k < nc; k++) {
+            int j = k < nc/2 ? (int) ((long) k*(n-s-1)/MAX(nc/2-1, 1)) : (int) floor(pow(n-s, (k-nc/2)/(double) MAX(nc-nc/2-1, 1)))-1;
+            jc[m++] = MIN(MAX(j, 0), n-s-1);
+        }
+        if (nc == n-s)
+            for (int k = 0; k < nc; k++)
+                jc[k] = k;
+        // Sort and remove duplicates.
+        for (int k = 1; k < m; k++)
+            for (int l = k; l > 0 && jc[l-1] > jc[l]; l--) {int t = jc[l]; jc[l] = jc[l-1]; jc[l-1] = t;}
+        nc = 0;
+        for (int k = 0; k < m; k++)
+            if (nc == 0 || jc[k] != jc[nc-1])
+                jc[nc++] = jc[k];
+        Q = realloc(Q, s*nc*sizeof(FLT));
+        FLT * W = malloc(n*nc*sizeof(FLT));
+        for (int k = 0; k < nc; k++)
+            ip[k] = s+jc[k];
+        if (block != NULL)
+            block(data, W, ip, nc, 'N');
+        else {
+            #pragma omp parallel for schedule(dynamic)
+            for (int k = 0; k < nc; k++)
+                column(data, W+k*n, ip[k], 0);
+        }
+        #pragma omp parallel for
+        for (int k = 0; k < nc; k++) {
+            FLT nrm = 0, * v = W+k*n;
+            for (int i = 0; i <= ip[k]; i++)
+                nrm += v[i]*v[i];
+            nrm = Y(sqrt)(nrm);
+            for (int i = 0; i < s; i++)
+                Q[i+k*s] = nrm > 0 ? v[i]/nrm : 0;
+        }
+        free(W);
+        // Modified Gram--Schmidt with column pivoting on the normalized samples.
+        for (r = 0; r < nc; r++) {
+            int p = r;
+            FLT nrmp = 0;
+            for (int k = r; k < nc; k++) {
+                FLT nrm = 0;
+                for (int i = 0; i < s; i++)
+                    nrm += Q[i+k*s]*Q[i+k*s];
+                if (nrm > nrmp) {
+                    nrmp = nrm;
+                    p = k;
+                }
+            }
+            if (Y(sqrt)(nrmp) <= tol)
+                break;
+            for (int i = 0; i < s; i++) {FLT t = Q[i+r*s]; Q[i+r*s] = Q[i+p*s]; Q[i+p*s] = t;}
+            nrmp = Y(sqrt)(nrmp);
+            for (int i = 0; i < s; i++)
+                Q[i+r*s] /= nrmp;
+            for (int k = r+1; k < nc; k++) {
+                FLT t = 0;
+                for (int i = 0; i < s; i++)
+                    t += Q[i+r*s]*Q[i+k*s];
+                for (int i = 0; i < s; i++)
+                    Q[i+k*s] -= t*Q[i+r*s];
+            }
+        }
+        if (2*r <= nc || nc == n-s)
+            break;
+        nc = MIN(2*nc, n-s);
+    }
+
+    // Rows of Q selected by Gaussian elimination with partial pivoting.
+    FLT * G = malloc(s*r*sizeof(FLT));
+    char * used = calloc(s, sizeof(char));
+    for (int i = 0; i < s*r; i++)
+        G[i] = Q[i];
+    for (int k = 0; k < r; k++) {
+        int p = 0;
+        while (used[p])
+            p++;
+        for (int i = p+1; i < s; i++)
+            if (!used[i] && Y(fabs)(G[i+k*s]) > Y(fabs)(G[p+k*s]))
+                p = i;
+        ip[k] = p;
+        used[p] = 1;
+        for (int i = 0; i < s; i++)
+            if (!used[i]) {
+                FLT l = G[i+k*s]/G[p+k*s];
+                for (int j = k+1; j < r; j++)
+                    G[i+j*s] -= l*G[p+j*s];
+            }
+    }
+    int i0 = s;
+    for (int k = 0; k < r; k++)
+        i0 = MIN(i0, ip[k]);
+
+    // T = Q[ip, :]⁻¹ V₁₂[ip, :], so that V₁₂ ≈ QT.
+    FLT * T = malloc(r*(n-s)*sizeof(FLT));
+    if (block != NULL) {
+        FLT * W = malloc(n*r*sizeof(FLT));
+        block(data, W, ip, r, 'T');
+        for (int j = s; j < n; j++)
+            for (int k = 0; k < r; k++)
+                T[k+(j-s)*r] = W[j+k*n];
+        free(W);
+    }
+    else {
+        #pragma omp parallel
+        {
+            FLT * v = malloc(n*sizeof(FLT));
+            #pragma omp for schedule(dynamic)
+            for (int j = s; j < n; j++) {
+                column(data, v, j, i0);
+                for (int k = 0; k < r; k++)
+                    T[k+(j-s)*r] = v[ip[k]];
+            }
+            free(v);
+        }
+    }
+    for (int k = 0; k < r; k++)
+        for (int j = 0; j < r; j++)
+            G[k+j*r] = Q[ip[k]+j*s];
+    X(gesv)(r, G, T, n-s);
+
+    // V₁⁻¹V₁₂ ≈ (V₁⁻¹Q)T, stored with the sign that bfmv expects.
+    X(lowrankmatrix) * L = X(malloc_lowrankmatrix)('2', s, n-s, r);
+    for (int k = 0; k < r; k++) {
+        X(bfsv)('N', F->F1, Q+k*s);
+        for (int i = 0; i < s; i++)
+            L->U[i+k*s] = -Q[i+k*s];
+        for (int j = 0; j < n-s; j++)
+            L->V[j+k*(n-s)] = T[k+j*r];
+        L->S[k] = 1;
+    }
+    F->F0 = X(malloc_hierarchicalmatrix)(1, 1);
+    F->F0->lowrankmatrices[0] = L;
+    F->F0->hash[0] = 3;
+    F->F0->m = s;
+    F->F0->n = n-s;
+    F->X = malloc(s*sizeof(FLT));
+    for (int i = 0; i < s; i++)
+        F->X[i] = 1;
+    F->Y = malloc((n-s)*sizeof(FLT));
+    for (int i = 0; i < n-s; i++)
+        F->Y[i] = 1;
+    F->t1 = calloc(s*FT_GET_MAX_THREADS(), sizeof(FLT));
+    F->t2 = calloc((n-s)*FT_GET_MAX_THREADS(), sizeof(FLT));
+    F->b = 1;
+    free(jc);
+    free(ip);
+    free(Q);
+    free(G);
+    free(used);
+    free(T);
+}
+
+typedef struct {
+    X(triangular_banded) * A;
+    X(triangular_banded) * B;
+    X(triangular_banded) * C;
+    FLT * lambda;
+    FLT * omega;
+} X(pencil_3arg);
+
+static void X(pencil_3arg_column)(const void * data, FLT * v, const int j, const int i0) {
+    const X(pencil_3arg) * P = data;
+    X(triangular_banded_eigenvector_3arg)(P->A, P->B, P->lambda[j], P->C, P->omega[j], v, j, i0);
+}
+
+// AV + BVΛ = CVΩ with Λ prescribed. As the pencil changes from column to column, the eigenvectors
+// do not couple the two halves through a Cauchy matrix, and the coupling is compressed as above.
+X(tb_eigen_FMM) * X(tb_eig_FMM_3arg)(X(triangular_banded) * A, X(triangular_banded) * B, FLT * lambda, X(triangular_banded) * C, const FLT tol) {
+    int n = A->n, b = MAX(MAX(A->b, B->b), C->b);
+    X(tb_eigen_FMM) * F = calloc(1, sizeof(X(tb_eigen_FMM)));
+    FLT * omega = F->lambda = malloc(n*sizeof(FLT));
+    X(triangular_banded_eigenvalues_3arg)(A, B, lambda, C, omega);
+    F->n = n;
+    if (n < TB_EIGEN_BLOCKSIZE) {
+        FLT * V = calloc(n*n, sizeof(FLT));
+        for (int i = 0; i < n; i++)
+            V[i+i*n] = 1;
+        X(triangular_banded_eigenvectors_3arg)(A, B, lambda, C, V);
+        F->V = V;
+        F->b = b;
+        return F;
+    }
+    int s = n>>1;
+    X(triangular_banded) * A1 = X(triangular_banded_block)(A, 0, s), * A2 = X(triangular_banded_block)(A, s, n);
+    X(triangular_banded) * B1 = X(triangular_banded_block)(B, 0, s), * B2 = X(triangular_banded_block)(B, s, n);
+    X(triangular_banded) * C1 = X(triangular_banded_block)(C, 0, s), * C2 = X(triangular_banded_block)(C, s, n);
+    F->F1 = X(tb_eig_FMM_3arg)(A1, B1, lambda, C1, tol);
+    F->F2 = X(tb_eig_FMM_3arg)(A2, B2, lambda+s, C2, tol);
+    X(pencil_3arg) P = {A, B, C, lambda, omega};
+    X(tb_lowrank_coupling)(F, X(pencil_3arg_column), NULL, &P, tol);
+    X(destroy_triangular_banded)(A1);
+    X(destroy_triangular_banded)(A2);
+    X(destroy_triangular_banded)(B1);
+    X(destroy_triangular_banded)(B2);
+    X(destroy_triangular_banded)(C1);
+    X(destroy_triangular_banded)(C2);
+    return F;
+}
+
+// A plan that is the upper-triangular banded matrix T, which it takes over. Its products and solves
+// cost O(n*T->b).
+X(tb_eigen_FMM) * X(tb_banded_FMM)(X(triangular_banded) * T) {
+    X(tb_eigen_FMM) * F = calloc(1, sizeof(X(tb_eigen_FMM)));
+    F->T = T;
+    F->n = T->n;
+    F->b = T->b;
+    return F;
+}
+
+typedef struct {
+    int k;
+    X(tb_eigen_FMM) ** F;
+    FLT ** D;
+} X(chain);
+
+// The columns idx[k] of V = D[k-1]F[k-1]⋯D[0]F[0] in those of A, or its rows idx[k] through the
+// transposed chain, all of them, with the level-3 kernels.
+static void X(chain_block)(const void * data, FLT * A, const int * idx, const int m, const char TRANS) {
+    const X(chain) * C = data;
+    int n = C->F[0]->n;
+    for (size_t i = 0; i < (size_t) n*m; i++)
+        A[i] = 0;
+    for (int k = 0; k < m; k++)
+        A[idx[k]+k*n] = 1;
+    for (int q = 0; q < C->k; q++) {
+        int l = TRANS == 'N' ? q : C->k-1-q;
+        if (TRANS == 'N')
+            X(bfmv_many)('N', C->F[l], A, 1, n, m);
+        if (C->D[l] != NULL)
+            for (int k = 0; k < m; k++)
+                for (int i = 0; i < n; i++)
+                    A[i+k*n] *= C->D[l][i];
+        if (TRANS == 'T')
+            X(bfmv_many)('T', C->F[l], A, 1, n, m);
+    }
+}
+
+// The diagonal blocks of a product of upper-triangular matrices are the products of their diagonal
+// blocks, so the halves of the composite are the composites of the halves of the plans: F1 and F2,
+// or the blocks of a banded plan. The coupling is then compressed from a few columns and rows of the
+// chain, applied together, so that a node of size n takes O(rn) storage.
+static X(tb_eigen_FMM) * X(tb_compose_FMM_node)(const int k, X(tb_eigen_FMM) ** F, FLT ** D, const FLT tol) {
+    int n = F[0]->n;
+    X(chain) C = {k, F, D};
+    X(tb_eigen_FMM) * G = calloc(1, sizeof(X(tb_eigen_FMM)));
+    G->lambda = calloc(n, sizeof(FLT));
+    G->n = n;
+    G->b = 1;
+    if (n < TB_EIGEN_BLOCKSIZE) {
+        int * idx = malloc(n*sizeof(int));
+        for (int j = 0; j < n; j++)
+            idx[j] = j;
+        G->V = malloc(n*n*sizeof(FLT));
+        X(chain_block)(&C, G->V, idx, n, 'N');
+        free(idx);
+        return G;
+    }
+    int s = n>>1;
+    X(tb_eigen_FMM) ** F1 = malloc(k*sizeof(X(tb_eigen_FMM) *)), ** F2 = malloc(k*sizeof(X(tb_eigen_FMM) *));
+    FLT ** D2 = malloc(k*sizeof(FLT *));
+    for (int l = 0; l < k; l++) {
+        if (F[l]->T != NULL) {
+            F1[l] = X(tb_banded_FMM)(X(triangular_banded_block)(F[l]->T, 0, s));
+            F2[l] = X(tb_banded_FMM)(X(triangular_banded_block)(F[l]->T, s, n));
+        }
+        else if (F[l]->F1 != NULL) {
+            F1[l] = F[l]->F1;
+            F2[l] = F[l]->F2;
+        }
+        else {
+            printf(RED("FastTransforms: tb_compose_FMM: the plans are not split alike.")"\n");
+            exit(EXIT_FAILURE);
+        }
+        D2[l] = D[l] == NULL ? NULL : D[l]+s;
+    }
+    G->F1 = X(tb_compose_FMM_node)(k, F1, D, tol);
+    G->F2 = X(tb_compose_FMM_node)(k, F2, D2, tol);
+    for (int l = 0; l < k; l++)
+        if (F[l]->T != NULL) {
+            X(destroy_tb_eigen_FMM)(F1[l]);
+            X(destroy_tb_eigen_FMM)(F2[l]);
+        }
+    free(F1);
+    free(F2);
+    free(D2);
+    X(tb_lowrank_coupling)(G, NULL, X(chain_block), &C, tol);
+    return G;
+}
+
+// D[k-1]F[k-1]⋯D[0]F[0], where D[i] scales the rows or is NULL. The product is never formed: it is
+// built level by level in O(rn) storage besides the plan, as above.
+X(tb_eigen_FMM) * X(tb_compose_FMM)(const int k, X(tb_eigen_FMM) ** F, FLT ** D, const FLT tol) {
+    int n = F[0]->n;
+    for (int l = 1; l < k; l++)
+        if (F[l]->n != n) {
+            printf(RED("FastTransforms: tb_compose_FMM: sizes are off.")"\n");
+            exit(EXIT_FAILURE);
+        }
+    return X(tb_compose_FMM_node)(k, F, D, tol);
+}
+
 void X(scale_rows_tb_eigen_FMM)(FLT alpha, FLT * x, X(tb_eigen_FMM) * F) {
     int n = F->n;
-    if (n < TB_EIGEN_BLOCKSIZE) {
+    if (F->T != NULL) {
+        for (int j = 0; j < n; j++)
+            for (int i = MAX(j-F->T->b, 0); i <= j; i++)
+                X(set_triangular_banded_index)(F->T, alpha*x[i]*X(get_triangular_banded_index)(F->T, i, j), i, j);
+    }
+    else if (n < TB_EIGEN_BLOCKSIZE) {
         FLT * V = F->V;
         for (int j = 0; j < n; j++)
             for (int i = 0; i <= j; i++)
@@ -361,7 +778,12 @@ void X(scale_rows_tb_eigen_FMM)(FLT alpha, FLT * x, X(tb_eigen_FMM) * F) {
 
 void X(scale_columns_tb_eigen_FMM)(FLT alpha, FLT * x, X(tb_eigen_FMM) * F) {
     int n = F->n;
-    if (n < TB_EIGEN_BLOCKSIZE) {
+    if (F->T != NULL) {
+        for (int j = 0; j < n; j++)
+            for (int i = MAX(j-F->T->b, 0); i <= j; i++)
+                X(set_triangular_banded_index)(F->T, alpha*x[j]*X(get_triangular_banded_index)(F->T, i, j), i, j);
+    }
+    else if (n < TB_EIGEN_BLOCKSIZE) {
         FLT scl, * V = F->V;
         for (int j = 0; j < n; j++) {
             scl = alpha*x[j];
@@ -383,40 +805,52 @@ void X(scale_columns_tb_eigen_FMM)(FLT alpha, FLT * x, X(tb_eigen_FMM) * F) {
 }
 
 // x ← A*x, x ← Aᵀ*x
-void X(trmv)(char TRANS, int n, FLT * A, int LDA, FLT * x) {
-    if (TRANS == 'N') {
-        for (int j = 0; j < n; j++) {
-            for (int i = 0; i < j; i++)
-                x[i] += A[i+j*LDA]*x[j];
-            x[j] *= A[j+j*LDA];
-        }
+#if defined(FT_USE_DDOUBLE)
+    void X(trmv)(char TRANS, int n, FLT * A, int LDA, FLT * x) {
+        ddtrmvq(TRANS, n, A, LDA, x);
     }
-    else if (TRANS == 'T') {
-        for (int i = n-1; i >= 0; i--) {
-            x[i] *= A[i+i*LDA];
-            for (int j = i-1; j >= 0; j--)
-                x[i] += A[j+i*LDA]*x[j];
+#else
+    void X(trmv)(char TRANS, int n, FLT * A, int LDA, FLT * x) {
+        if (TRANS == 'N') {
+            for (int j = 0; j < n; j++) {
+                for (int i = 0; i < j; i++)
+                    x[i] += A[i+j*LDA]*x[j];
+                x[j] *= A[j+j*LDA];
+            }
+        }
+        else if (TRANS == 'T') {
+            for (int i = n-1; i >= 0; i--) {
+                x[i] *= A[i+i*LDA];
+                for (int j = i-1; j >= 0; j--)
+                    x[i] += A[j+i*LDA]*x[j];
+            }
         }
     }
-}
+#endif
 
 // x ← A⁻¹*x, x ← A⁻ᵀ*x
-void X(trsv)(char TRANS, int n, FLT * A, int LDA, FLT * x) {
-    if (TRANS == 'N') {
-        for (int j = n-1; j >= 0; j--) {
-            x[j] /= A[j+j*LDA];
-            for (int i = 0; i < j; i++)
-                x[i] -= A[i+j*LDA]*x[j];
-        }
+#if defined(FT_USE_DDOUBLE)
+    void X(trsv)(char TRANS, int n, FLT * A, int LDA, FLT * x) {
+        ddtrsvq(TRANS, n, A, LDA, x);
     }
-    else if (TRANS == 'T') {
-        for (int i = 0; i < n; i++) {
-            for (int j = 0; j < i; j++)
-                x[i] -= A[j+i*LDA]*x[j];
-            x[i] /= A[i+i*LDA];
+#else
+    void X(trsv)(char TRANS, int n, FLT * A, int LDA, FLT * x) {
+        if (TRANS == 'N') {
+            for (int j = n-1; j >= 0; j--) {
+                x[j] /= A[j+j*LDA];
+                for (int i = 0; i < j; i++)
+                    x[i] -= A[i+j*LDA]*x[j];
+            }
+        }
+        else if (TRANS == 'T') {
+            for (int i = 0; i < n; i++) {
+                for (int j = 0; j < i; j++)
+                    x[i] -= A[j+i*LDA]*x[j];
+                x[i] /= A[i+i*LDA];
+            }
         }
     }
-}
+#endif
 
 // B ← A*B, B ← Aᵀ*B
 #if defined(FT_USE_CBLAS_S)
@@ -466,32 +900,40 @@ void X(trsv)(char TRANS, int n, FLT * A, int LDA, FLT * x) {
 
 // x ← A*x, x ← Aᵀ*x
 void X(bfmv)(char TRANS, X(tb_eigen_FMM) * F, FLT * x) {
+    X(bfmv_work)(TRANS, F, x, NULL);
+}
+
+// As X(bfmv), with the temporaries in the X(work_size_tb_eigen_FMM)(F) entries of w, or in the
+// per-thread temporaries of F if w is NULL.
+void X(bfmv_work)(char TRANS, X(tb_eigen_FMM) * F, FLT * x, FLT * w) {
     int n = F->n;
-    if (n < TB_EIGEN_BLOCKSIZE)
+    if (F->T != NULL)
+        X(tbmv)(TRANS, F->T, x);
+    else if (n < TB_EIGEN_BLOCKSIZE)
         X(trmv)(TRANS, n, F->V, n, x);
     else {
         int s = n>>1, b = F->b;
-        FLT * t1 = F->t1+s*FT_GET_THREAD_NUM(), * t2 = F->t2+(n-s)*FT_GET_THREAD_NUM();
+        FLT * t1 = w != NULL ? w : F->t1+s*FT_GET_THREAD_NUM(), * t2 = w != NULL ? w+s : F->t2+(n-s)*FT_GET_THREAD_NUM();
         if (TRANS == 'N') {
             // C(Λ₁, Λ₂) ∘ (-XYᵀ)
             for (int k = 0; k < b; k++) {
                 for (int i = 0; i < n-s; i++)
                     t2[i] = F->Y[i+k*(n-s)]*x[i+s];
-                X(ghmv)(TRANS, -1, F->F0, t2, 0, t1);
+                X(ghmv_work)(TRANS, -1, F->F0, t2, 0, t1, w != NULL ? w+n : NULL);
                 for (int i = 0; i < s; i++)
                     x[i] += t1[i]*F->X[i+k*s];
             }
-            X(bfmv)(TRANS, F->F1, x);
-            X(bfmv)(TRANS, F->F2, x+s);
+            X(bfmv_work)(TRANS, F->F1, x, w);
+            X(bfmv_work)(TRANS, F->F2, x+s, w);
         }
         else if (TRANS == 'T') {
-            X(bfmv)(TRANS, F->F1, x);
-            X(bfmv)(TRANS, F->F2, x+s);
+            X(bfmv_work)(TRANS, F->F1, x, w);
+            X(bfmv_work)(TRANS, F->F2, x+s, w);
             // C(Λ₁, Λ₂) ∘ (-XYᵀ)
             for (int k = 0; k < b; k++) {
                 for (int i = 0; i < s; i++)
                     t1[i] = F->X[i+k*s]*x[i];
-                X(ghmv)(TRANS, -1, F->F0, t1, 0, t2);
+                X(ghmv_work)(TRANS, -1, F->F0, t1, 0, t2, w != NULL ? w+n : NULL);
                 for (int i = 0; i < n-s; i++)
                     x[i+s] += t2[i]*F->Y[i+k*(n-s)];
             }
@@ -501,20 +943,28 @@ void X(bfmv)(char TRANS, X(tb_eigen_FMM) * F, FLT * x) {
 
 // x ← A⁻¹*x, x ← A⁻ᵀ*x
 void X(bfsv)(char TRANS, X(tb_eigen_FMM) * F, FLT * x) {
+    X(bfsv_work)(TRANS, F, x, NULL);
+}
+
+// As X(bfsv), with the temporaries in the X(work_size_tb_eigen_FMM)(F) entries of w, or in the
+// per-thread temporaries of F if w is NULL.
+void X(bfsv_work)(char TRANS, X(tb_eigen_FMM) * F, FLT * x, FLT * w) {
     int n = F->n;
-    if (n < TB_EIGEN_BLOCKSIZE)
+    if (F->T != NULL)
+        X(tbsv)(TRANS, F->T, x);
+    else if (n < TB_EIGEN_BLOCKSIZE)
         X(trsv)(TRANS, n, F->V, n, x);
     else {
         int s = n>>1, b = F->b;
-        FLT * t1 = F->t1+s*FT_GET_THREAD_NUM(), * t2 = F->t2+(n-s)*FT_GET_THREAD_NUM();
+        FLT * t1 = w != NULL ? w : F->t1+s*FT_GET_THREAD_NUM(), * t2 = w != NULL ? w+s : F->t2+(n-s)*FT_GET_THREAD_NUM();
         if (TRANS == 'N') {
-            X(bfsv)(TRANS, F->F1, x);
-            X(bfsv)(TRANS, F->F2, x+s);
+            X(bfsv_work)(TRANS, F->F1, x, w);
+            X(bfsv_work)(TRANS, F->F2, x+s, w);
             // C(Λ₁, Λ₂) ∘ (-XYᵀ)
             for (int k = 0; k < b; k++) {
                 for (int i = 0; i < n-s; i++)
                     t2[i] = F->Y[i+k*(n-s)]*x[i+s];
-                X(ghmv)(TRANS, 1, F->F0, t2, 0, t1);
+                X(ghmv_work)(TRANS, 1, F->F0, t2, 0, t1, w != NULL ? w+n : NULL);
                 for (int i = 0; i < s; i++)
                     x[i] += t1[i]*F->X[i+k*s];
             }
@@ -524,12 +974,12 @@ void X(bfsv)(char TRANS, X(tb_eigen_FMM) * F, FLT * x) {
             for (int k = 0; k < b; k++) {
                 for (int i = 0; i < s; i++)
                     t1[i] = F->X[i+k*s]*x[i];
-                X(ghmv)(TRANS, 1, F->F0, t1, 0, t2);
+                X(ghmv_work)(TRANS, 1, F->F0, t1, 0, t2, w != NULL ? w+n : NULL);
                 for (int i = 0; i < n-s; i++)
                     x[i+s] += t2[i]*F->Y[i+k*(n-s)];
             }
-            X(bfsv)(TRANS, F->F1, x);
-            X(bfsv)(TRANS, F->F2, x+s);
+            X(bfsv_work)(TRANS, F->F1, x, w);
+            X(bfsv_work)(TRANS, F->F2, x+s, w);
         }
     }
 }
@@ -546,6 +996,113 @@ void X(bfsm)(char TRANS, X(tb_eigen_FMM) * F, FLT * B, int LDB, int N) {
         X(bfsv)(TRANS, F, B+j*LDB);
 }
 
+// B ← F*B, B ← Fᵀ*B, and their solves, on N columns at once. The b terms of the low-rank
+// correction go through one hierarchical matrix-matrix product of N*b columns.
+static void X(bfmm_blocked)(char TRANS, X(tb_eigen_FMM) * F, FLT * B, int LDB, int N, int solve) {
+    int n = F->n;
+    if (F->T != NULL) {
+        #pragma omp parallel for
+        for (int j = 0; j < N; j++) {
+            if (solve)
+                X(tbsv)(TRANS, F->T, B+j*LDB);
+            else
+                X(tbmv)(TRANS, F->T, B+j*LDB);
+        }
+        return;
+    }
+    if (n < TB_EIGEN_BLOCKSIZE) {
+        if (solve)
+            X(trsm)(TRANS, n, F->V, n, B, LDB, N);
+        else
+            X(trmm)(TRANS, n, F->V, n, B, LDB, N);
+        return;
+    }
+    int s = n>>1, b = F->b;
+    FLT * T1 = malloc(s*N*b*sizeof(FLT)), * T2 = malloc((n-s)*N*b*sizeof(FLT));
+    FLT alpha = solve ? 1 : -1;
+    if ((TRANS == 'N') == (solve != 0)) {
+        X(bfmm_blocked)(TRANS, F->F1, B, LDB, N, solve);
+        X(bfmm_blocked)(TRANS, F->F2, B+s, LDB, N, solve);
+    }
+    // C(Λ₁, Λ₂) ∘ (-XYᵀ)
+    if (TRANS == 'N') {
+        for (int k = 0; k < b; k++)
+            for (int j = 0; j < N; j++)
+                for (int i = 0; i < n-s; i++)
+                    T2[i+(j+k*N)*(n-s)] = F->Y[i+k*(n-s)]*B[i+s+j*LDB];
+        X(ghmm)(TRANS, N*b, alpha, F->F0, T2, n-s, 0, T1, s);
+        for (int k = 0; k < b; k++)
+            for (int j = 0; j < N; j++)
+                for (int i = 0; i < s; i++)
+                    B[i+j*LDB] += T1[i+(j+k*N)*s]*F->X[i+k*s];
+    }
+    else if (TRANS == 'T') {
+        for (int k = 0; k < b; k++)
+            for (int j = 0; j < N; j++)
+                for (int i = 0; i < s; i++)
+                    T1[i+(j+k*N)*s] = F->X[i+k*s]*B[i+j*LDB];
+        X(ghmm)(TRANS, N*b, alpha, F->F0, T1, s, 0, T2, n-s);
+        for (int k = 0; k < b; k++)
+            for (int j = 0; j < N; j++)
+                for (int i = 0; i < n-s; i++)
+                    B[i+s+j*LDB] += T2[i+(j+k*N)*(n-s)]*F->Y[i+k*(n-s)];
+    }
+    if ((TRANS == 'N') != (solve != 0)) {
+        X(bfmm_blocked)(TRANS, F->F1, B, LDB, N, solve);
+        X(bfmm_blocked)(TRANS, F->F2, B+s, LDB, N, solve);
+    }
+    free(T1);
+    free(T2);
+}
+
+// A lone vector goes through bfmv or bfsv. Batches go through the level-3 kernels in blocks of
+// columns, which are copied to contiguous storage unless stride = 1; already at two columns this
+// beats as many matrix-vector products.
+static void X(bf_many)(char TRANS, X(tb_eigen_FMM) * F, FLT * A, int stride, int dist, int howmany, int solve) {
+    int n = F->n;
+    if (howmany < FT_BATCH_MIN) {
+        FLT * x = stride == 1 ? NULL : malloc(n*sizeof(FLT));
+        for (int j = 0; j < howmany; j++) {
+            FLT * y = stride == 1 ? A+j*dist : x;
+            if (stride != 1)
+                for (int i = 0; i < n; i++)
+                    x[i] = A[j*dist+i*stride];
+            if (solve)
+                X(bfsv)(TRANS, F, y);
+            else
+                X(bfmv)(TRANS, F, y);
+            if (stride != 1)
+                for (int i = 0; i < n; i++)
+                    A[j*dist+i*stride] = x[i];
+        }
+        free(x);
+        return;
+    }
+    int p = MIN(howmany, FT_BATCH_BLOCK);
+    FLT * W = stride == 1 ? NULL : malloc(n*p*sizeof(FLT));
+    for (int j0 = 0; j0 < howmany; j0 += p) {
+        int N = MIN(p, howmany-j0);
+        if (stride != 1) {
+            #pragma omp parallel for
+            for (int j = 0; j < N; j++)
+                for (int i = 0; i < n; i++)
+                    W[i+j*n] = A[(j0+j)*dist+i*stride];
+        }
+        X(bfmm_blocked)(TRANS, F, stride == 1 ? A+j0*dist : W, stride == 1 ? dist : n, N, solve);
+        if (stride != 1) {
+            #pragma omp parallel for
+            for (int j = 0; j < N; j++)
+                for (int i = 0; i < n; i++)
+                    A[(j0+j)*dist+i*stride] = W[i+j*n];
+        }
+    }
+    free(W);
+}
+
+void X(bfmv_many)(char TRANS, X(tb_eigen_FMM) * F, FLT * A, int stride, int dist, int howmany) {X(bf_many)(TRANS, F, A, stride, dist, howmany, 0);}
+
+void X(bfsv_many)(char TRANS, X(tb_eigen_FMM) * F, FLT * A, int stride, int dist, int howmany) {X(bf_many)(TRANS, F, A, stride, dist, howmany, 1);}
+
 
 #define delta(k) (((k)%2) ? 1 : 0)
 
@@ -631,6 +1188,50 @@ X(banded) * X(create_jacobi_raising)(const int m, const int n, const FLT alpha,
     return A;
 }
 
+// P^{(α,β)} ↗ P^{(α+1,β)}
+X(banded) * X(create_jacobi_raising_alpha)(const int m, const int n, const FLT alpha, const FLT beta) {
+    X(banded) * A = X(calloc_banded)(m, n, 0, 1);
+    FLT v;
+    for (int j = 0; j < n; j++) {
+        v = -(j+beta)/(2*j+alpha+beta+1);
+        X(set_banded_index)(A, v, j-1, j);
+        if (j == 0)
+            v = 1;
+        else
+            v = (j+alpha+beta+1)/(2*j+alpha+beta+1);
+        X(set_banded_index)(A, v, j, j);
+    }
+    return A;
+}
+
+// P^{(α,β)} ↗ P^{(α,β+1)}
+X(banded) * X(create_jacobi_raising_beta)(const int m, const int n, const FLT alpha, const FLT beta) {
+    X(banded) * A = X(calloc_banded)(m, n, 0, 1);
+    FLT v;
+    for (int j = 0; j < n; j++) {
+        v = (j+alpha)/(2*j+alpha+beta+1);
+        X(set_banded_index)(A, v, j-1, j);
+        if (j == 0)
+            v = 1;
+        else
+            v = (j+alpha+beta+1)/(2*j+alpha+beta+1);
+        X(set_banded_index)(A, v, j, j);
+    }
+    return A;
+}
+
+// C^{(λ)} ↗ C^{(λ+1)}
+X(banded) * X(create_ultraspherical_raising)(const int m, const int n, const FLT lambda) {
+    X(banded) * A = X(calloc_banded)(m, n, 0, 2);
+    FLT v;
+    for (int j = 0; j < n; j++) {
+        v = j == 0 ? 1 : lambda/(j+lambda);
+        X(set_banded_index)(A, -v, j-2, j);
+        X(set_banded_index)(A, v, j, j);
+    }
+    return A;
+}
+
 // (1-x²) P^{(α+1,β+1)} ↘ P^{(α,β)}
 X(banded) * X(create_jacobi_lowering)(const int m, const int n, const FLT alpha, const FLT beta) {
     X(banded) * A = X(calloc_banded)(m, n, 2, 0);
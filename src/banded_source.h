@@ -24,6 +24,7 @@ struct X(tbstruct_FMM) {
     FLT * t1;
     FLT * t2;
     FLT * lambda;
+    X(triangular_banded) * T;
     int n;
     int b;
 };
@@ -33,6 +34,7 @@ void X(destroy_triangular_banded)(X(triangular_banded) * A);
 void X(destroy_tb_eigen_FMM)(X(tb_eigen_FMM) * F);
 
 size_t X(summary_size_tb_eigen_FMM)(X(tb_eigen_FMM) * F);
+int X(work_size_tb_eigen_FMM)(X(tb_eigen_FMM) * F);
 
 X(banded) * X(malloc_banded)(const int m, const int n, const int l, const int u);
 X(banded) * X(calloc_banded)(const int m, const int n, const int l, const int u);
@@ -55,11 +57,16 @@ void X(tbsv)(char TRANS, X(triangular_banded) * A, FLT * x);
 
 void X(triangular_banded_eigenvalues)(X(triangular_banded) * A, X(triangular_banded) * B, FLT * lambda);
 void X(triangular_banded_eigenvectors)(X(triangular_banded) * A, X(triangular_banded) * B, FLT * V);
+void X(triangular_banded_eigenvectors_columns)(X(triangular_banded) * A, X(triangular_banded) * B, FLT * V, const int j0);
 
 void X(triangular_banded_eigenvalues_3arg)(X(triangular_banded) * A, X(triangular_banded) * B, FLT * lambda, X(triangular_banded) * C, FLT * omega);
 void X(triangular_banded_eigenvectors_3arg)(X(triangular_banded) * A, X(triangular_banded) * B, FLT * lambda, X(triangular_banded) * C, FLT * V);
 
 X(tb_eigen_FMM) * X(tb_eig_FMM)(X(triangular_banded) * A, X(triangular_banded) * B);
+X(tb_eigen_FMM) * X(tb_eig_FMM_tol)(X(triangular_banded) * A, X(triangular_banded) * B, const FLT tol);
+X(tb_eigen_FMM) * X(tb_eig_FMM_3arg)(X(triangular_banded) * A, X(triangular_banded) * B, FLT * lambda, X(triangular_banded) * C, const FLT tol);
+X(tb_eigen_FMM) * X(tb_compose_FMM)(const int k, X(tb_eigen_FMM) ** F, FLT ** D, const FLT tol);
+X(tb_eigen_FMM) * X(tb_banded_FMM)(X(triangular_banded) * T);
 
 void X(scale_rows_tb_eigen_FMM)(FLT alpha, FLT * x, X(tb_eigen_FMM) * F);
 void X(scale_columns_tb_eigen_FMM)(FLT alpha, FLT * x, X(tb_eigen_FMM) * F);
@@ -72,10 +79,17 @@ void X(trsm)(char TRANS, int n, FLT * A, int LDA, FLT * B, int LDB, int N);
 
 void X(bfmv)(char TRANS, X(tb_eigen_FMM) * A, FLT * x);
 void X(bfsv)(char TRANS, X(tb_eigen_FMM) * A, FLT * x);
+void X(bfmv_work)(char TRANS, X(tb_eigen_FMM) * A, FLT * x, FLT * w);
+void X(bfsv_work)(char TRANS, X(tb_eigen_FMM) * A, FLT * x, FLT * w);
 
 void X(bfmm)(char TRANS, X(tb_eigen_FMM) * F, FLT * X, int LDX, int N);
 void X(bfsm)(char TRANS, X(tb_eigen_FMM) * F, FLT * X, int LDX, int N);
 
+// x ← F*x, x ← Fᵀ*x, and their solves, for the howmany vectors A+j*dist, 0 ≤ j < howmany, whose
+// entries lie stride apart, in the manner of the advanced interface of FFTW.
+void X(bfmv_many)(char TRANS, X(tb_eigen_FMM) * F, FLT * A, int stride, int dist, int howmany);
+void X(bfsv_many)(char TRANS, X(tb_eigen_FMM) * F, FLT * A, int stride, int dist, int howmany);
+
 X(triangular_banded) * X(create_A_konoplev_to_jacobi)(const int n, const FLT alpha, const FLT beta);
 X(triangular_banded) * X(create_B_konoplev_to_jacobi)(const int n, const FLT alpha);
 
@@ -83,6 +97,9 @@ X(banded) * X(create_jacobi_derivative)(const int m, const int n, const int orde
 X(banded) * X(create_jacobi_multiplication)(const int m, const int n, const FLT alpha, const FLT beta);
 X(banded) * X(create_jacobi_raising)(const int m, const int n, const FLT alpha, const FLT beta);
 X(banded) * X(create_jacobi_lowering)(const int m, const int n, const FLT alpha, const FLT beta);
+X(banded) * X(create_jacobi_raising_alpha)(const int m, const int n, const FLT alpha, const FLT beta);
+X(banded) * X(create_jacobi_raising_beta)(const int m, const int n, const FLT alpha, const FLT beta);
+X(banded) * X(create_ultraspherical_raising)(const int m, const int n, const FLT lambda);
 
 X(triangular_banded) * X(create_A_associated_jacobi_to_jacobi)(const int n, const FLT alpha, const FLT beta, const FLT gamma, const FLT delta);
 X(triangular_banded) * X(create_B_associated_jacobi_to_jacobi)(const int n, const FLT gamma, const FLT delta);
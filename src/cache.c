@@ -0,0 +1,162 @@
+// A process-wide cache of the read-only components shared by plans with equal parameters.
+
+#include "fasttransforms.h"
+#include "ftinternal.h"
+
+// Every entry is reference counted. Entries that no plan holds stay in the cache until the bytes
+// they occupy exceed the budget, at which point the least recently used are destroyed first.
+
+typedef struct ft_cache_entry {
+    ft_cache_key K;
+    void * data;
+    size_t bytes;
+    int refs;
+    unsigned long stamp;
+    void (*destroy)(void * data);
+    struct ft_cache_entry * next;
+} ft_cache_entry;
+
+static ft_cache_entry * cache_head = NULL;
+static size_t cache_budget = 0;
+static size_t cache_bytes = 0;
+static size_t cache_idle = 0;
+static unsigned long cache_clock = 0;
+
+static int cache_key_equal(const ft_cache_key * K1, const ft_cache_key * K2) {
+    if (K1->kind != K2->kind || K1->n != K2->n)
+        return 0;
+    for (int k = 0; k < 3; k++)
+        if (K1->i[k] != K2->i[k])
+            return 0;
+    for (int k = 0; k < 6; k++)
+        if (K1->p[k] != K2->p[k])
+            return 0;
+    return 1;
+}
+
+// The callers below hold the lock.
+
+static ft_cache_entry * cache_find(const ft_cache_key * K) {
+    for (ft_cache_entry * E = cache_head; E != NULL; E = E->next)
+        if (cache_key_equal(&E->K, K))
+            return E;
+    return NULL;
+}
+
+static void * cache_hold(ft_cache_entry * E) {
+    if (E->refs++ == 0)
+        cache_idle -= E->bytes;
+    E->stamp = ++cache_clock;
+    return E->data;
+}
+
+// Unlinks the least recently used idle entries until the idle bytes fit in the budget, and
+// returns them so that they are destroyed outside the lock.
+static ft_cache_entry * cache_evict(void) {
+    ft_cache_entry * evicted = NULL;
+    while (cache_idle > cache_budget) {
+        ft_cache_entry ** lru = NULL;
+        for (ft_cache_entry ** E = &cache_head; *E != NULL; E = &(*E)->next)
+            if ((*E)->refs == 0 && (lru == NULL || (*E)->stamp < (*lru)->stamp))
+                lru = E;
+        ft_cache_entry * E = *lru;
+        *lru = E->next;
+        cache_bytes -= E->bytes;
+        cache_idle -= E->bytes;
+        E->next = evicted;
+        evicted = E;
+    }
+    return evicted;
+}
+
+static void cache_destroy(ft_cache_entry * E) {
+    while (E != NULL) {
+        ft_cache_entry * next = E->next;
+        E->destroy(E->data);
+        free(E);
+        E = next;
+    }
+}
+
+void * ft_cache_acquire(const ft_cache_key * K, void * (*build)(const ft_cache_key * K), size_t (*bytes)(const ft_cache_key * K), void (*destroy)(void * data)) {
+    void * data = NULL;
+    int enabled;
+    #pragma omp critical (ft_plan_cache)
+    {
+        enabled = cache_budget > 0;
+        ft_cache_entry * E = enabled ? cache_find(K) : NULL;
+        if (E != NULL)
+            data = cache_hold(E);
+    }
+    if (data != NULL)
+        return data;
+    // The component is built outside the lock. If another thread has registered an equal one in
+    // the meantime, that one is shared and ours is discarded.
+    data = build(K);
+    if (!enabled)
+        return data;
+    ft_cache_entry * N = malloc(sizeof(ft_cache_entry));
+    N->K = *K;
+    N->data = data;
+    N->bytes = bytes(K);
+    N->refs = 1;
+    N->stamp = 0;
+    N->destroy = destroy;
+    #pragma omp critical (ft_plan_cache)
+    {
+        ft_cache_entry * E = cache_find(K);
+        if (E != NULL) {
+            data = cache_hold(E);
+        }
+        else {
+            N->stamp = ++cache_clock;
+            N->next = cache_head;
+            cache_head = N;
+            cache_bytes += N->bytes;
+            N = NULL;
+        }
+    }
+    if (N != NULL) {
+        destroy(N->data);
+        free(N);
+    }
+    return data;
+}
+
+void ft_cache_release(void * data, void (*destroy)(void * data)) {
+    if (data == NULL)
+        return;
+    ft_cache_entry * evicted = NULL;
+    int found = 0;
+    #pragma omp critical (ft_plan_cache)
+    {
+        for (ft_cache_entry * E = cache_head; E != NULL; E = E->next)
+            if (E->data == data) {
+                if (--E->refs == 0)
+                    cache_idle += E->bytes;
+                found = 1;
+                break;
+            }
+        evicted = cache_evict();
+    }
+    cache_destroy(evicted);
+    if (!found)
+        destroy(data);
+}
+
+void ft_set_plan_cache_budget(const size_t bytes) {
+    ft_cache_entry * evicted;
+    #pragma omp critical (ft_plan_cache)
+    {
+        cache_budget = bytes;
+        evicted = cache_evict();
+    }
+    cache_destroy(evicted);
+}
+
+size_t ft_get_plan_cache_size(void) {
+    size_t bytes;
+    #pragma omp critical (ft_plan_cache)
+    bytes = cache_bytes;
+    return bytes;
+}
@@ -0,0 +1,212 @@
+// Double-double kernels for the quadruple-precision stage of plan construction.
+
+#include "ftinternal.h"
+
+// A quadruple x is held as the unevaluated sum hi + lo of two doubles with |lo| ≤ ulp(hi),
+// which carries 106 of its 113 bits. Products use the fused multiply-add for their rounding
+// errors, so every operation below is a handful of hardware flops in place of a software-emulated
+// quadruple one. The operands stay quadruple in memory; only the kernels compute in pairs.
+
+#define DD_BLOCK 256
+
+static inline void dd_two_sum(const double a, const double b, double * s, double * e) {
+    double t = a+b, bb = t-a;
+    *e = (a-(t-bb))+(b-bb);
+    *s = t;
+}
+
+static inline void dd_fast_two_sum(const double a, const double b, double * s, double * e) {
+    double t = a+b;
+    *e = b-(t-a);
+    *s = t;
+}
+
+// Splits x by its bits: hi takes the leading 53 bits and lo the rounded remainder. Zeros,
+// subnormals, and anything outside the range of the remainder go through the conversions.
+static inline void dd_split(const quadruple x, double * hi, double * lo) {
+    #if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        uint64_t w[2];
+        memcpy(w, &x, sizeof(quadruple));
+        int e = (int) ((w[1] >> 48) & 0x7fff) - 16383 + 1023;
+        if (e > 113 && e < 2047) {
+            uint64_t s = w[1] & 0x8000000000000000ULL;
+            uint64_t h = s | ((uint64_t) e << 52) | ((w[1] & 0x0000ffffffffffffULL) << 4) | (w[0] >> 60);
+            uint64_t p = (uint64_t) (e-112) << 52;
+            double scl;
+            memcpy(hi, &h, sizeof(double));
+            memcpy(&scl, &p, sizeof(double));
+            *lo = (double) (w[0] & 0x0fffffffffffffffULL)*scl;
+            if (s)
+                *lo = -*lo;
+            return;
+        }
+    #endif
+    *hi = (double) x;
+    *lo = (double) (x - *hi);
+}
+
+static inline quadruple dd_join(const double hi, const double lo) {return (quadruple) hi + (quadruple) lo;}
+
+// (hi, lo) ← (hi, lo) + (ah, al)*(bh, bl)
+static inline void dd_fma(double * hi, double * lo, const double ah, const double al, const double bh, const double bl) {
+    double p = ah*bh, q = fma(ah, bh, -p) + (ah*bl + al*bh), s, e;
+    dd_two_sum(*hi, p, &s, &e);
+    dd_fast_two_sum(s, e + (*lo + q), hi, lo);
+}
+
+// (hi, lo) ← (ah, al)*(bh, bl)
+static inline void dd_mul(double * hi, double * lo, const double ah, const double al, const double bh, const double bl) {
+    double p = ah*bh, q = fma(ah, bh, -p) + (ah*bl + al*bh);
+    dd_fast_two_sum(p, q, hi, lo);
+}
+
+// (hi, lo) ← (ah, al)/(bh, bl)
+static inline void dd_div(double * hi, double * lo, const double ah, const double al, const double bh, const double bl) {
+    double q = ah/bh, rh, rl;
+    dd_mul(&rh, &rl, q, 0.0, bh, bl);
+    dd_fast_two_sum(q, ((ah-rh) - rl + al)/bh, hi, lo);
+}
+
+// Splits the n entries of x into the pairs (xh, xl).
+static inline void dd_load(const int n, const quadruple * x, double * xh, double * xl) {
+    for (int i = 0; i < n; i++)
+        dd_split(x[i], xh+i, xl+i);
+}
+
+// y ← β*y + α*(th, tl)
+static inline quadruple dd_axpby(const quadruple alpha, const double th, const double tl, const quadruple beta, const quadruple y) {
+    double ah, al, bh, bl, yh, yl, rh, rl;
+    dd_split(alpha, &ah, &al);
+    dd_mul(&rh, &rl, ah, al, th, tl);
+    if (beta != 0) {
+        dd_split(beta, &bh, &bl);
+        dd_split(y, &yh, &yl);
+        dd_fma(&rh, &rl, bh, bl, yh, yl);
+    }
+    return dd_join(rh, rl);
+}
+
+void ddgemvq(char TRANS, int m, int n, quadruple alpha, quadruple * A, int LDA, quadruple * x, quadruple beta, quadruple * y) {
+    double ah, al, bh, bl, th, tl;
+    if (TRANS == 'N') {
+        double yh[DD_BLOCK], yl[DD_BLOCK];
+        dd_split(alpha, &ah, &al);
+        for (int ib = 0; ib < m; ib += DD_BLOCK) {
+            int mb = MIN(DD_BLOCK, m-ib);
+            if (beta == 0)
+                for (int i = 0; i < mb; i++)
+                    yh[i] = yl[i] = 0.0;
+            else {
+                dd_split(beta, &bh, &bl);
+                for (int i = 0; i < mb; i++) {
+                    dd_split(y[ib+i], &th, &tl);
+                    dd_mul(yh+i, yl+i, bh, bl, th, tl);
+                }
+            }
+            for (int j = 0; j < n; j++) {
+                dd_split(x[j], &bh, &bl);
+                dd_mul(&th, &tl, ah, al, bh, bl);
+                quadruple * Aj = A+ib+j*LDA;
+                for (int i = 0; i < mb; i++) {
+                    dd_split(Aj[i], &bh, &bl);
+                    dd_fma(yh+i, yl+i, bh, bl, th, tl);
+                }
+            }
+            for (int i = 0; i < mb; i++)
+                y[ib+i] = dd_join(yh[i], yl[i]);
+        }
+    }
+    else if (TRANS == 'T') {
+        double xh[DD_BLOCK], xl[DD_BLOCK];
+        if (beta != 1) {
+            if (beta == 0)
+                for (int i = 0; i < n; i++)
+                    y[i] = 0;
+            else
+                for (int i = 0; i < n; i++)
+                    y[i] = beta*y[i];
+        }
+        for (int jb = 0; jb < m; jb += DD_BLOCK) {
+            int mb = MIN(DD_BLOCK, m-jb);
+            dd_load(mb, x+jb, xh, xl);
+            for (int i = 0; i < n; i++) {
+                th = tl = 0.0;
+                quadruple * Ai = A+jb+i*LDA;
+                for (int j = 0; j < mb; j++) {
+                    dd_split(Ai[j], &bh, &bl);
+                    dd_fma(&th, &tl, bh, bl, xh[j], xl[j]);
+                }
+                y[i] = dd_axpby(alpha, th, tl, 1, y[i]);
+            }
+        }
+    }
+}
+
+void ddgemmq(char TRANS, int m, int n, int p, quadruple alpha, quadruple * A, int LDA, quadruple * B, int LDB, quadruple beta, quadruple * C, int LDC) {
+    for (int k = 0; k < p; k++)
+        ddgemvq(TRANS, m, n, alpha, A, LDA, B+k*LDB, beta, C+k*LDC);
+}
+
+// The triangular kernels hold all of x in pairs, on the stack when it fits.
+#define DD_ALLOC(n) ((n) > DD_BLOCK ? malloc(2*(n)*sizeof(double)) : buf)
+#define DD_FREE(p) if ((p) != buf) free(p)
+
+void ddtrmvq(char TRANS, int n, quadruple * A, int LDA, quadruple * x) {
+    double buf[2*DD_BLOCK], * xh = DD_ALLOC(n), * xl = xh+n, ah, al;
+    dd_load(n, x, xh, xl);
+    if (TRANS == 'N') {
+        for (int j = 0; j < n; j++) {
+            for (int i = 0; i < j; i++) {
+                dd_split(A[i+j*LDA], &ah, &al);
+                dd_fma(xh+i, xl+i, ah, al, xh[j], xl[j]);
+            }
+            dd_split(A[j+j*LDA], &ah, &al);
+            dd_mul(xh+j, xl+j, ah, al, xh[j], xl[j]);
+        }
+    }
+    else if (TRANS == 'T') {
+        for (int i = n-1; i >= 0; i--) {
+            dd_split(A[i+i*LDA], &ah, &al);
+            dd_mul(xh+i, xl+i, ah, al, xh[i], xl[i]);
+            for (int j = i-1; j >= 0; j--) {
+                dd_split(A[j+i*LDA], &ah, &al);
+                dd_fma(xh+i, xl+i, ah, al, xh[j], xl[j]);
+            }
+        }
+    }
+    for (int i = 0; i < n; i++)
+        x[i] = dd_join(xh[i], xl[i]);
+    DD_FREE(xh);
+}
+
+void ddtrsvq(char TRANS, int n, quadruple * A, int LDA, quadruple * x) {
+    double buf[2*DD_BLOCK], * xh = DD_ALLOC(n), * xl = xh+n, ah, al;
+    dd_load(n, x, xh, xl);
+    if (TRANS == 'N') {
+        for (int j = n-1; j >= 0; j--) {
+            dd_split(A[j+j*LDA], &ah, &al);
+            dd_div(xh+j, xl+j, xh[j], xl[j], ah, al);
+            for (int i = 0; i < j; i++) {
+                dd_split(A[i+j*LDA], &ah, &al);
+                dd_fma(xh+i, xl+i, -ah, -al, xh[j], xl[j]);
+            }
+        }
+    }
+    else if (TRANS == 'T') {
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < i; j++) {
+                dd_split(A[j+i*LDA], &ah, &al);
+                dd_fma(xh+i, xl+i, -ah, -al, xh[j], xl[j]);
+            }
+            dd_split(A[i+i*LDA], &ah, &al);
+            dd_div(xh+i, xl+i, xh[i], xl[i], ah, al);
+        }
+    }
+    for (int i = 0; i < n; i++)
+        x[i] = dd_join(xh[i], xl[i]);
+    DD_FREE(xh);
+}
+
+#undef DD_ALLOC
+#undef DD_FREE
+#undef DD_BLOCK
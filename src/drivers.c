@@ -3,75 +3,382 @@
 #include "fasttransforms.h"
 #include "ftinternal.h"
 
-static void chebyshev_normalization_2d(double * A, const int N, const int M) {
-    for (int i = 0; i < N; i++)
-        A[i] *= M_SQRT1_2;
-    for (int j = 0; j < M; j++) {
-        A[j*N] *= M_SQRT1_2;
-        for (int i = 0; i < N; i++)
-            A[i+j*N] *= M_2_PI;
-    }
-}
-
-static void chebyshev_normalization_2d_t(double * A, const int N, const int M) {
-    for (int i = 0; i < N; i++)
-        A[i] *= M_SQRT2;
-    for (int j = 0; j < M; j++) {
-        A[j*N] *= M_SQRT2;
-        for (int i = 0; i < N; i++)
-            A[i+j*N] *= M_PI_2;
-    }
-}
-
-static void chebyshev_normalization_3d(double * A, const int N, const int L, const int M) {
-    for (int j = 0; j < L; j++)
-        for (int i = 0; i < N; i++)
-            A[i+j*N] *= M_SQRT1_2;
-    for (int k = 0; k < M; k++) {
-        for (int i = 0; i < N; i++)
-            A[i+k*L*N] *= M_SQRT1_2;
-        for (int j = 0; j < L; j++) {
-            A[(j+k*L)*N] *= M_SQRT1_2;
+// Scales A[i+LDA*(j+L*k)] by c, and additionally by ci, cj, ck on the planes i = 0, j = 0, k = 0.
+static void chebyshev_normalization(double * A, const int N, const int L, const int M, const int LDA, const double ci, const double cj, const double ck, const double c) {
+    if (ci != 1.0)
+        for (int k = 0; k < M; k++)
+            for (int j = 0; j < L; j++)
+                A[LDA*(j+k*L)] *= ci;
+    if (cj != 1.0)
+        for (int k = 0; k < M; k++)
             for (int i = 0; i < N; i++)
-                A[i+(j+k*L)*N] *= M_2_PI_POW_1P5;
+                A[i+k*L*LDA] *= cj;
+    if (ck != 1.0)
+        for (int j = 0; j < L; j++)
+            for (int i = 0; i < N; i++)
+                A[i+j*LDA] *= ck;
+    if (c != 1.0)
+        for (int j = 0; j < L*M; j++)
+            for (int i = 0; i < N; i++)
+                A[i+j*LDA] *= c;
+}
+
+// Scales the rows of an n x n upper-triangular matrix by c, and the first row additionally by c0.
+static double * scale_rows_upper(double * P, const int n, const double c0, const double c) {
+    for (int j = 0; j < n; j++) {
+        P[j*n] *= c0;
+        for (int i = 0; i <= j; i++)
+            P[i+j*n] *= c;
+    }
+    return P;
+}
+
+// Scales the columns of an n x n upper-triangular matrix by c, and the first column additionally by c0.
+static double * scale_columns_upper(double * P, const int n, const double c0, const double c) {
+    P[0] *= c0;
+    for (int j = 0; j < n; j++)
+        for (int i = 0; i <= j; i++)
+            P[i+j*n] *= c;
+    return P;
+}
+
+// Whether a harmonic plan of degree n with the given planner flags uses FMM connections.
+static int use_fmm(const int n, const int flags) {return flags & FT_HARMONIC_FMM || (!(flags & FT_HARMONIC_DENSE) && n >= FT_HARMONIC_FMM_THRESHOLD);}
+
+// The FMM counterparts of scale_rows_upper and scale_columns_upper.
+static void scale_rows_fmm(ft_tb_eigen_FMM * F, const int n, const double c0, const double c) {
+    double * x = malloc(n*sizeof(double));
+    for (int i = 0; i < n; i++)
+        x[i] = c;
+    x[0] *= c0;
+    ft_scale_rows_tb_eigen_FMM(1.0, x, F);
+    free(x);
+}
+
+static void scale_columns_fmm(ft_tb_eigen_FMM * F, const int n, const double c0, const double c) {
+    double * x = malloc(n*sizeof(double));
+    for (int i = 0; i < n; i++)
+        x[i] = c;
+    x[0] *= c0;
+    ft_scale_columns_tb_eigen_FMM(1.0, x, F);
+    free(x);
+}
+
+static void destroy_fmm(ft_tb_eigen_FMM * F) {
+    if (F != NULL)
+        ft_destroy_tb_eigen_FMM(F);
+}
+
+// The rotations and the packed connection matrices are read-only once built, so plans with equal
+// parameters share them through the plan cache. The FMM factorizations carry per-thread workspace
+// and are never shared. A connection matrix is keyed on its builder, the normalizations i[0] and
+// i[1], the parameters p[0..3], and the scaling of its rows, or its columns if i[2] is set, by
+// p[5] and of the first by p[4].
+enum {ROTSPHERE, ROTTRIANGLE, ROTDISK, LEG2CHEB, CHEB2LEG, ULTRA2ULTRA, JAC2JAC};
+
+static ft_cache_key rotation_key(const int kind, const int n, const double alpha, const double beta, const double gamma) {
+    return (ft_cache_key) {kind, n, {0, 0, 0}, {alpha, beta, gamma, 0.0, 0.0, 0.0}};
+}
+
+static ft_cache_key connection_key(const int kind, const int n, const int norm1, const int norm2, const double alpha, const double beta, const double gamma, const double delta, const int columns, const double c0, const double c) {
+    return (ft_cache_key) {kind, n, {norm1, norm2, columns}, {alpha, beta, gamma, delta, c0, c}};
+}
+
+// Builds the component K of degree K->n, copying the entries it shares with the component old of
+// degree n0 < K->n and computing only the others. Its connection matrices are nested, as the
+// coefficients of a degree do not depend on the largest one.
+static void * extend_component(const ft_cache_key * K, const void * old, const int n0) {
+    const int n = K->n;
+    const double * p = K->p;
+    double * V;
+    switch (K->kind) {
+        case ROTSPHERE: return extend_rotsphere(old, n);
+        case ROTTRIANGLE: return extend_rottriangle(old, n, p[0], p[1], p[2]);
+        case ROTDISK: return extend_rotdisk(old, n);
+        case LEG2CHEB: V = plan_legendre_to_chebyshev_columns(K->i[0], K->i[1], n, n0); break;
+        case CHEB2LEG: V = plan_chebyshev_to_legendre_columns(K->i[0], K->i[1], n, n0); break;
+        case ULTRA2ULTRA: V = plan_ultraspherical_to_ultraspherical_columns(K->i[0], K->i[1], n, p[0], p[1], n0); break;
+        default: V = plan_jacobi_to_jacobi_columns(K->i[0], K->i[1], n, p[0], p[1], p[2], p[3], n0);
+    }
+    if (p[4] != 1.0 || p[5] != 1.0) {
+        if (K->i[2])
+            scale_columns_upper(V, n, p[4], p[5]);
+        else
+            scale_rows_upper(V, n, p[4], p[5]);
+    }
+    double * P = extend_packed_upper(old, n0, V, n);
+    free(V);
+    return P;
+}
+
+static void * build_component(const ft_cache_key * K) {return extend_component(K, NULL, 0);}
+
+static size_t component_bytes(const ft_cache_key * K) {
+    const size_t n = K->n;
+    switch (K->kind) {
+        case ROTSPHERE: case ROTTRIANGLE: return n*(n+1)*sizeof(double);
+        case ROTDISK: return 2*n*n*sizeof(double);
+        default: return packed_size(n)*sizeof(double);
+    }
+}
+
+// The FMM factorization of the connection K.
+static ft_tb_eigen_FMM * build_fmm(const ft_cache_key * K) {
+    const int n = K->n;
+    const double * p = K->p;
+    ft_tb_eigen_FMM * F;
+    switch (K->kind) {
+        case LEG2CHEB: F = ft_plan_legendre_to_chebyshev(K->i[0], K->i[1], n); break;
+        case CHEB2LEG: F = ft_plan_chebyshev_to_legendre(K->i[0], K->i[1], n); break;
+        case ULTRA2ULTRA: F = ft_plan_ultraspherical_to_ultraspherical(K->i[0], K->i[1], n, p[0], p[1]); break;
+        default: F = ft_plan_jacobi_to_jacobi(K->i[0], K->i[1], n, p[0], p[1], p[2], p[3]);
+    }
+    if (p[4] != 1.0 || p[5] != 1.0) {
+        if (K->i[2])
+            scale_columns_fmm(F, n, p[4], p[5]);
+        else
+            scale_rows_fmm(F, n, p[4], p[5]);
+    }
+    return F;
+}
+
+static void destroy_rotation(void * RP) {ft_destroy_rotation_plan(RP);}
+
+static ft_rotation_plan * acquire_rotation(const ft_cache_key * K) {return ft_cache_acquire(K, build_component, component_bytes, destroy_rotation);}
+static double * acquire_connection(const ft_cache_key * K) {return ft_cache_acquire(K, build_component, component_bytes, free);}
+
+static void release_rotation(ft_rotation_plan * RP) {ft_cache_release(RP, destroy_rotation);}
+static void release_connection(double * P) {ft_cache_release(P, free);}
+
+// The extensions of components that a plan holds through the cache are new allocations, so that
+// the plans that share the old ones are unaffected. The old components of a plan loaded from a
+// plan file are left to the file, which is given the new ones.
+static ft_rotation_plan * extend_rotation(const ft_cache_key * K, ft_rotation_plan * RP, ft_plan_file * PF) {
+    ft_rotation_plan * RE = extend_component(K, RP, RP->ns);
+    if (PF == NULL)
+        release_rotation(RP);
+    else {
+        #pragma omp critical(ft_extend_plan_file)
+        ft_plan_file_own(PF, RE, destroy_rotation);
+    }
+    return RE;
+}
+
+static double * extend_connection(const ft_cache_key * K, double * P, const int n0, ft_plan_file * PF) {
+    if (P == NULL)
+        return NULL;
+    double * PE = extend_component(K, P, n0);
+    if (PF == NULL)
+        release_connection(P);
+    else {
+        #pragma omp critical(ft_extend_plan_file)
+        ft_plan_file_own(PF, PE, free);
+    }
+    return PE;
+}
+
+static void destroy_fmm_component(void * F) {ft_destroy_tb_eigen_FMM(F);}
+
+// The components of the harmonic plans of degree n, in the order of their rotations, their
+// connections, and the inverses of the connections. The Chebyshev normalization is absorbed into
+// the connection coefficients.
+
+static void sph2fourier_components(ft_cache_key * K, const int n) {
+    K[0] = rotation_key(ROTSPHERE, n, 0.0, 0.0, 0.0);
+    K[1] = connection_key(LEG2CHEB, n, 1, 0, 0.0, 0.0, 0.0, 0.0, 0, 1.0, 1.0);
+    K[2] = connection_key(ULTRA2ULTRA, n, 1, 0, 1.5, 1.0, 0.0, 0.0, 0, 1.0, 1.0);
+    K[3] = connection_key(CHEB2LEG, n, 0, 1, 0.0, 0.0, 0.0, 0.0, 0, 1.0, 1.0);
+    K[4] = connection_key(ULTRA2ULTRA, n, 0, 1, 1.0, 1.5, 0.0, 0.0, 0, 1.0, 1.0);
+}
+
+static void tri2cheb_components(ft_cache_key * K, const int n, const double alpha, const double beta, const double gamma) {
+    K[0] = rotation_key(ROTTRIANGLE, n, alpha, beta, gamma);
+    K[1] = connection_key(JAC2JAC, n, 1, 1, beta + gamma + 1.0, alpha, -0.5, -0.5, 0, M_SQRT1_2, 1.0);
+    K[2] = connection_key(JAC2JAC, n, 1, 1, gamma, beta, -0.5, -0.5, 0, M_SQRT1_2, M_2_PI);
+    K[3] = connection_key(JAC2JAC, n, 1, 1, -0.5, -0.5, beta + gamma + 1.0, alpha, 1, M_SQRT2, 1.0);
+    K[4] = connection_key(JAC2JAC, n, 1, 1, -0.5, -0.5, gamma, beta, 1, M_SQRT2, M_PI_2);
+}
+
+static void disk2cxf_components(ft_cache_key * K, const int n) {
+    K[0] = rotation_key(ROTDISK, n, 0.0, 0.0, 0.0);
+    K[1] = connection_key(LEG2CHEB, n, 1, 0, 0.0, 0.0, 0.0, 0.0, 0, 1.0, 2.0);
+    K[2] = connection_key(JAC2JAC, n, 1, 1, 0.0, 1.0, -0.5, 0.5, 0, 1.0, 2.0*M_2_PI_POW_0P5);
+    K[3] = connection_key(CHEB2LEG, n, 0, 1, 0.0, 0.0, 0.0, 0.0, 0, 1.0, 0.5);
+    K[4] = connection_key(JAC2JAC, n, 1, 1, -0.5, 0.5, 0.0, 1.0, 0, 1.0, 0.5*M_PI_2_POW_0P5);
+}
+
+static void tet2cheb_components(ft_cache_key * K, const int n, const double alpha, const double beta, const double gamma, const double delta) {
+    K[0] = rotation_key(ROTTRIANGLE, n, alpha, beta, gamma + delta + 1.0);
+    K[1] = rotation_key(ROTTRIANGLE, n, beta, gamma, delta);
+    K[2] = connection_key(JAC2JAC, n, 1, 1, beta + gamma + delta + 2.0, alpha, -0.5, -0.5, 0, M_SQRT1_2, 1.0);
+    K[3] = connection_key(JAC2JAC, n, 1, 1, gamma + delta + 1.0, beta, -0.5, -0.5, 0, M_SQRT1_2, 1.0);
+    K[4] = connection_key(JAC2JAC, n, 1, 1, delta, gamma, -0.5, -0.5, 1, M_SQRT1_2, M_2_PI_POW_1P5);
+    K[5] = connection_key(JAC2JAC, n, 1, 1, -0.5, -0.5, beta + gamma + delta + 2.0, alpha, 1, M_SQRT2, 1.0);
+    K[6] = connection_key(JAC2JAC, n, 1, 1, -0.5, -0.5, gamma + delta + 1.0, beta, 1, M_SQRT2, 1.0);
+    K[7] = connection_key(JAC2JAC, n, 1, 1, -0.5, -0.5, delta, gamma, 0, M_SQRT2, M_PI_2_POW_1P5);
+}
+
+// Applies the FMM factorization F, or its inverse if solve is set, to the m vectors A+i*inc,
+// 0 <= i < m, whose entries lie ld apart. Strided vectors go through a per-thread copy, and
+// every thread has its own scratch for F, so that F may be shared by concurrent callers.
+static void fmm_vectors(const char TRANS, ft_tb_eigen_FMM * F, const int solve, double * A, const int m, const int inc, const int ld) {
+    int n = F->n, nw = ft_work_size_tb_eigen_FMM(F);
+    #pragma omp parallel
+    {
+        double * x = ld == 1 ? NULL : malloc(n*sizeof(double));
+        double * w = malloc(nw*sizeof(double));
+        #pragma omp for schedule(dynamic)
+        for (int i = 0; i < m; i++) {
+            double * y = ld == 1 ? A+i*inc : x;
+            if (ld != 1)
+                for (int k = 0; k < n; k++)
+                    x[k] = A[i*inc+k*ld];
+            if (solve)
+                ft_bfsv_work(TRANS, F, y, w);
+            else
+                ft_bfmv_work(TRANS, F, y, w);
+            if (ld != 1)
+                for (int k = 0; k < n; k++)
+                    A[i*inc+k*ld] = x[k];
         }
+        free(x);
+        free(w);
     }
 }
 
-static void chebyshev_normalization_3d_t(double * A, const int N, const int L, const int M) {
-    for (int j = 0; j < L; j++)
-        for (int i = 0; i < N; i++)
-            A[i+j*N] *= M_SQRT2;
-    for (int k = 0; k < M; k++) {
-        for (int i = 0; i < N; i++)
-            A[i+k*L*N] *= M_SQRT2;
-        for (int j = 0; j < L; j++) {
-            A[(j+k*L)*N] *= M_SQRT2;
-            for (int i = 0; i < N; i++)
-                A[i+(j+k*L)*N] *= M_PI_2_POW_1P5;
+// A connection stage that multiplies column j of a harmonic array by the packed upper-triangular
+// matrix P[j%4] of dimension np, or through the FMM factorization F[j%4] if it is not NULL, or
+// by the inverse if solve is set. Classes 0, 3 and 1, 2 share a matrix in every caller, so they
+// are applied back to back while its panels are in cache.
+typedef struct {
+    const double * P[4];
+    ft_tb_eigen_FMM * F[4];
+    int np;
+    int solve;
+} connection_mod4;
+
+// The scratch that the FMM factorizations of the connection stage C need.
+static int connection_work_size(const connection_mod4 * C) {
+    int W = 0;
+    for (int c = 0; c < 4; c++)
+        if (C->F[c] != NULL)
+            W = MAX(W, ft_work_size_tb_eigen_FMM(C->F[c]));
+    return W;
+}
+
+// Applies the connection stage C to the columns j0 <= j < j1 of an N x M array whose columns
+// from jA on are stored at A. The FMM factorizations may be shared by concurrent callers, so
+// their scratch is allocated here rather than taken from the plan. The packed matrices are read
+// one FT_PACKED_BLOCK panel at a time, once per call: the drivers call it on each block of
+// orders just after its rotations, so the columns it multiplies are still in cache.
+static void connect_mod4_from(const connection_mod4 * C, double * A, const int N, const int j0, const int j1, const int LDA, const int jA) {
+    const int order[4] = {0, 3, 1, 2};
+    double * w = NULL;
+    for (int q = 0; q < 4; q++) {
+        int c = order[q];
+        int j = j0 + (c-j0%4+4)%4;
+        if (j >= j1)
+            continue;
+        int nj = (j1-j+3)/4;
+        if (C->F[c] != NULL) {
+            if (w == NULL)
+                w = malloc(connection_work_size(C)*sizeof(double));
+            for (int k = 0; k < nj; k++) {
+                if (C->solve)
+                    ft_bfsv_work('N', C->F[c], A+LDA*(j-jA+4*k), w);
+                else
+                    ft_bfmv_work('N', C->F[c], A+LDA*(j-jA+4*k), w);
+            }
         }
+        else if (C->solve)
+            packed_dtrsm(CblasLeft, CblasNoTrans, N, nj, C->P[c], C->np, A+LDA*(j-jA), 4*LDA);
+        else
+            packed_dtrmm(CblasLeft, CblasNoTrans, N, nj, C->P[c], C->np, A+LDA*(j-jA), 4*LDA);
     }
+    free(w);
+}
+
+// Applies the connection stage C to the columns j0 <= j < j1 of the N x M array A.
+static void connect_mod4(const connection_mod4 * C, double * A, const int N, const int j0, const int j1, const int LDA) {
+    connect_mod4_from(C, A, N, j0, j1, LDA, 0);
+}
+
+// Every thread of a parallel region that fuses a connection stage calls the BLAS, so it runs
+// serially until serial_blas_pop unless the caller is itself in a parallel region.
+static int serial_blas_push(void) {
+    int blas = FT_BLAS_GET_NUM_THREADS();
+    if (!FT_IN_PARALLEL() && blas != 1)
+        FT_BLAS_SET_NUM_THREADS(1);
+    return blas;
 }
 
-static void partial_chebyshev_normalization(double * A, const int N, const int M) {
-    for (int j = 1; j < M; j += 4)
-        for (int i = 0; i < N; i++)
-            A[i+j*N] *= M_2_PI_POW_0P5;
-    for (int j = 2; j < M; j += 4)
-        for (int i = 0; i < N; i++)
-            A[i+j*N] *= M_2_PI_POW_0P5;
+static void serial_blas_pop(const int blas) {
+    if (!FT_IN_PARALLEL() && blas != 1)
+        FT_BLAS_SET_NUM_THREADS(blas);
 }
 
-static void partial_chebyshev_normalization_t(double * A, const int N, const int M) {
-    for (int j = 1; j < M; j += 4)
-        for (int i = 0; i < N; i++)
-            A[i+j*N] *= M_PI_2_POW_0P5;
-    for (int j = 2; j < M; j += 4)
-        for (int i = 0; i < N; i++)
-            A[i+j*N] *= M_PI_2_POW_0P5;
+static int ft_num_threads = 0;
+
+void ft_set_num_threads(const int n) {
+    ft_num_threads = n;
+    FT_SET_NUM_THREADS(n);
+    FT_BLAS_SET_NUM_THREADS(n);
+    ft_fftw_init_threads();
+    ft_fftw_plan_with_nthreads(n);
+}
+
+int ft_get_num_threads(void) {return ft_num_threads > 0 ? ft_num_threads : FT_GET_MAX_THREADS();}
+
+typedef struct {
+    int omp;
+    int blas;
+} ft_thread_state;
+
+// Callers in parallel regions share the process-wide BLAS setting, so the first of them to
+// arrive makes the BLAS serial and the last to leave restores it.
+static int ft_nested_calls = 0;
+static int ft_nested_blas = 1;
+
+// Runs OpenMP and the BLAS on n threads (0 for the library default) until pop_num_threads.
+// Inside a parallel region the caller already owns the cores, so both run serially.
+static ft_thread_state push_num_threads(const int n) {
+    ft_thread_state s = {FT_GET_MAX_THREADS(), FT_BLAS_GET_NUM_THREADS()};
+    if (FT_IN_PARALLEL()) {
+        FT_SET_NUM_THREADS(1);
+        #pragma omp critical(ft_nested_blas)
+        if (ft_nested_calls++ == 0) {
+            ft_nested_blas = FT_BLAS_GET_NUM_THREADS();
+            if (ft_nested_blas != 1)
+                FT_BLAS_SET_NUM_THREADS(1);
+        }
+    }
+    else {
+        int nt = n > 0 ? n : ft_get_num_threads();
+        if (nt != s.omp)
+            FT_SET_NUM_THREADS(nt);
+        if (nt != s.blas)
+            FT_BLAS_SET_NUM_THREADS(nt);
+    }
+    return s;
+}
+
+static void pop_num_threads(const ft_thread_state s) {
+    if (FT_GET_MAX_THREADS() != s.omp)
+        FT_SET_NUM_THREADS(s.omp);
+    if (FT_IN_PARALLEL()) {
+        #pragma omp critical(ft_nested_blas)
+        if (--ft_nested_calls == 0 && ft_nested_blas != 1)
+            FT_BLAS_SET_NUM_THREADS(ft_nested_blas);
+    }
+    else if (FT_BLAS_GET_NUM_THREADS() != s.blas)
+        FT_BLAS_SET_NUM_THREADS(s.blas);
 }
 
-void ft_set_num_threads(const int n) {FT_SET_NUM_THREADS(n);}
+// A plan's workspace is shared by every call, so callers in a parallel region stream through
+// per-thread buffers instead.
+static double * harmonic_workspace(double * B) {
+    return FT_IN_PARALLEL() ? NULL : B;
+}
 
 void ft_execute_sph_hi2lo(const ft_rotation_plan * RP, double * A, const int M) {
     int N = RP->n;
@@ -143,50 +450,146 @@ void ft_execute_sph_lo2hi_AVX(const ft_rotation_plan * RP, double * A, double *
     warp(A, N, M, 2);
 }
 
-void ft_execute_sph_hi2lo_AVX512(const ft_rotation_plan * RP, double * A, double * B, const int M) {
+// The AVX-512 drivers permute each block of orders into B and back. If B is NULL, every
+// thread streams its blocks through a private buffer of a few columns instead. If C is not
+// NULL, each block also goes through the connection stage right after its rotations (hi2lo)
+// or right before them (lo2hi), so the two stages overlap across the blocks of one transform.
+// The spherical drivers rotate only the rows of one parity if asked to. Otherwise, when there
+// are fewer blocks than threads, the even and odd chains of a block run as two tasks.
+// They may also transform only the columns j0 <= j < j1 of A, stored from A on, where j0 is 0 or
+// the first column of a block; B is then offset alike. The head of M%16 columns goes with j0 = 0.
+static void execute_sph_hi2lo_AVX512_window(const ft_rotation_plan * RP, double * A, double * B, const int M, const int LDA, const connection_mod4 * C, const int parity, const int j0, const int j1) {
     int N = RP->n;
     int NB = VALIGN(N);
     int M_star = M%16;
-    warp(A, N, M, 4);
-    warp(A, N, M_star, 2);
-    permute_sph(A, B, N, M, 8);
-    for (int m = 2; m <= (M_star%8)/2; m++)
-        ft_kernel_sph_hi2lo_SSE(RP, m, B + NB*(2*m-1));
-    for (int m = (M_star%8+1)/2; m <= M_star/2; m += 4) {
-        ft_kernel_sph_hi2lo_AVX(RP, m, B + NB*(2*m-1));
-        ft_kernel_sph_hi2lo_AVX(RP, m+1, B + NB*(2*m+3));
-    }
+    int p = parity == FT_PARITY_EVEN ? 0 : parity == FT_PARITY_ODD ? 1 : -1;
+    int blas = C == NULL ? 1 : serial_blas_push();
     #pragma omp parallel
-    for (int m = (M_star+1)/2 + 8*FT_GET_THREAD_NUM(); m <= M/2; m += 8*FT_GET_NUM_THREADS()) {
-        ft_kernel_sph_hi2lo_AVX512(RP, m, B + NB*(2*m-1));
-        ft_kernel_sph_hi2lo_AVX512(RP, m+1, B + NB*(2*m+7));
+    {
+        double * W = B == NULL ? VMALLOC(NB*16*sizeof(double)) : NULL;
+        int split = p < 0 && (j1-MAX(j0, M_star))/16 < FT_GET_NUM_THREADS();
+        #pragma omp single nowait
+        if (j0 == 0) {
+            double * Bh = W == NULL ? B : W;
+            warp_lda(A, N, M_star, 2, LDA);
+            permute_sph_lda(A, Bh, N, M_star, 4, LDA);
+            for (int m = 2; m <= (M_star%8)/2; m++)
+                ft_kernel_sph_hi2lo_SSE_parity(RP, m, Bh + NB*(2*m-1), p);
+            for (int m = (M_star%8+1)/2; m <= M_star/2; m += 4) {
+                ft_kernel_sph_hi2lo_AVX_parity(RP, m, Bh + NB*(2*m-1), p);
+                ft_kernel_sph_hi2lo_AVX_parity(RP, m+1, Bh + NB*(2*m+3), p);
+            }
+            permute_t_sph_lda(A, Bh, N, M_star, 4, LDA);
+            warp_lda(A, N, M_star, 2, LDA);
+            if (C != NULL)
+                connect_mod4(C, A, N, 0, M_star, LDA);
+        }
+        #pragma omp for schedule(dynamic) nowait
+        for (int m = (M_star+1)/2; m <= M/2; m += 8) {
+            if (2*m-1 < j0 || 2*m-1 >= j1)
+                continue;
+            double * Am = A+LDA*(2*m-1-j0);
+            double * Bm = W == NULL ? B + NB*(2*m-1-j0) : W;
+            warp_lda(Am, N, 16, 4, LDA);
+            permute_lda(Am, Bm, N, 16, 8, LDA);
+            if (split) {
+                #pragma omp task
+                {
+                    ft_kernel_sph_hi2lo_AVX512_parity(RP, m, Bm, 0);
+                    ft_kernel_sph_hi2lo_AVX512_parity(RP, m+1, Bm + 8*NB, 0);
+                }
+                ft_kernel_sph_hi2lo_AVX512_parity(RP, m, Bm, 1);
+                ft_kernel_sph_hi2lo_AVX512_parity(RP, m+1, Bm + 8*NB, 1);
+                #pragma omp taskwait
+            }
+            else {
+                ft_kernel_sph_hi2lo_AVX512_parity(RP, m, Bm, p);
+                ft_kernel_sph_hi2lo_AVX512_parity(RP, m+1, Bm + 8*NB, p);
+            }
+            permute_t_lda(Am, Bm, N, 16, 8, LDA);
+            warp_t_lda(Am, N, 16, 4, LDA);
+            if (C != NULL)
+                connect_mod4_from(C, A, N, 2*m-1, 2*m-1+16, LDA, j0);
+        }
+        VFREE(W);
     }
-    permute_t_sph(A, B, N, M, 8);
-    warp(A, N, M_star, 2);
-    warp_t(A, N, M, 4);
+    if (C != NULL)
+        serial_blas_pop(blas);
 }
 
-void ft_execute_sph_lo2hi_AVX512(const ft_rotation_plan * RP, double * A, double * B, const int M) {
+static void execute_sph_hi2lo_AVX512(const ft_rotation_plan * RP, double * A, double * B, const int M, const int LDA, const connection_mod4 * C, const int parity) {
+    execute_sph_hi2lo_AVX512_window(RP, A, B, M, LDA, C, parity, 0, M);
+}
+
+void ft_execute_sph_hi2lo_AVX512(const ft_rotation_plan * RP, double * A, double * B, const int M) {
+    execute_sph_hi2lo_AVX512(RP, A, B, M, RP->n, NULL, FT_PARITY_BOTH);
+}
+
+static void execute_sph_lo2hi_AVX512_window(const ft_rotation_plan * RP, double * A, double * B, const int M, const int LDA, const connection_mod4 * C, const int parity, const int j0, const int j1) {
     int N = RP->n;
     int NB = VALIGN(N);
     int M_star = M%16;
-    warp(A, N, M, 4);
-    warp(A, N, M_star, 2);
-    permute_sph(A, B, N, M, 8);
-    for (int m = 2; m <= (M_star%8)/2; m++)
-        ft_kernel_sph_lo2hi_SSE(RP, m, B + NB*(2*m-1));
-    for (int m = (M_star%8+1)/2; m <= M_star/2; m += 4) {
-        ft_kernel_sph_lo2hi_AVX(RP, m, B + NB*(2*m-1));
-        ft_kernel_sph_lo2hi_AVX(RP, m+1, B + NB*(2*m+3));
-    }
+    int p = parity == FT_PARITY_EVEN ? 0 : parity == FT_PARITY_ODD ? 1 : -1;
+    int blas = C == NULL ? 1 : serial_blas_push();
     #pragma omp parallel
-    for (int m = (M_star+1)/2 + 8*FT_GET_THREAD_NUM(); m <= M/2; m += 8*FT_GET_NUM_THREADS()) {
-        ft_kernel_sph_lo2hi_AVX512(RP, m, B + NB*(2*m-1));
-        ft_kernel_sph_lo2hi_AVX512(RP, m+1, B + NB*(2*m+7));
+    {
+        double * W = B == NULL ? VMALLOC(NB*16*sizeof(double)) : NULL;
+        int split = p < 0 && (j1-MAX(j0, M_star))/16 < FT_GET_NUM_THREADS();
+        #pragma omp single nowait
+        if (j0 == 0) {
+            double * Bh = W == NULL ? B : W;
+            if (C != NULL)
+                connect_mod4(C, A, N, 0, M_star, LDA);
+            warp_lda(A, N, M_star, 2, LDA);
+            permute_sph_lda(A, Bh, N, M_star, 4, LDA);
+            for (int m = 2; m <= (M_star%8)/2; m++)
+                ft_kernel_sph_lo2hi_SSE_parity(RP, m, Bh + NB*(2*m-1), p);
+            for (int m = (M_star%8+1)/2; m <= M_star/2; m += 4) {
+                ft_kernel_sph_lo2hi_AVX_parity(RP, m, Bh + NB*(2*m-1), p);
+                ft_kernel_sph_lo2hi_AVX_parity(RP, m+1, Bh + NB*(2*m+3), p);
+            }
+            permute_t_sph_lda(A, Bh, N, M_star, 4, LDA);
+            warp_lda(A, N, M_star, 2, LDA);
+        }
+        #pragma omp for schedule(dynamic) nowait
+        for (int m = (M_star+1)/2; m <= M/2; m += 8) {
+            if (2*m-1 < j0 || 2*m-1 >= j1)
+                continue;
+            double * Am = A+LDA*(2*m-1-j0);
+            double * Bm = W == NULL ? B + NB*(2*m-1-j0) : W;
+            if (C != NULL)
+                connect_mod4_from(C, A, N, 2*m-1, 2*m-1+16, LDA, j0);
+            warp_lda(Am, N, 16, 4, LDA);
+            permute_lda(Am, Bm, N, 16, 8, LDA);
+            if (split) {
+                #pragma omp task
+                {
+                    ft_kernel_sph_lo2hi_AVX512_parity(RP, m, Bm, 0);
+                    ft_kernel_sph_lo2hi_AVX512_parity(RP, m+1, Bm + 8*NB, 0);
+                }
+                ft_kernel_sph_lo2hi_AVX512_parity(RP, m, Bm, 1);
+                ft_kernel_sph_lo2hi_AVX512_parity(RP, m+1, Bm + 8*NB, 1);
+                #pragma omp taskwait
+            }
+            else {
+                ft_kernel_sph_lo2hi_AVX512_parity(RP, m, Bm, p);
+                ft_kernel_sph_lo2hi_AVX512_parity(RP, m+1, Bm + 8*NB, p);
+            }
+            permute_t_lda(Am, Bm, N, 16, 8, LDA);
+            warp_t_lda(Am, N, 16, 4, LDA);
+        }
+        VFREE(W);
     }
-    permute_t_sph(A, B, N, M, 8);
-    warp(A, N, M_star, 2);
-    warp_t(A, N, M, 4);
+    if (C != NULL)
+        serial_blas_pop(blas);
+}
+
+static void execute_sph_lo2hi_AVX512(const ft_rotation_plan * RP, double * A, double * B, const int M, const int LDA, const connection_mod4 * C, const int parity) {
+    execute_sph_lo2hi_AVX512_window(RP, A, B, M, LDA, C, parity, 0, M);
+}
+
+void ft_execute_sph_lo2hi_AVX512(const ft_rotation_plan * RP, double * A, double * B, const int M) {
+    execute_sph_lo2hi_AVX512(RP, A, B, M, RP->n, NULL, FT_PARITY_BOTH);
 }
 
 void ft_execute_sphv_hi2lo(const ft_rotation_plan * RP, double * A, const int M) {
@@ -259,50 +662,98 @@ void ft_execute_sphv_lo2hi_AVX(const ft_rotation_plan * RP, double * A, double *
     warp(A+2*N, N, M-2, 2);
 }
 
-void ft_execute_sphv_hi2lo_AVX512(const ft_rotation_plan * RP, double * A, double * B, const int M) {
+static void execute_sphv_hi2lo_AVX512(const ft_rotation_plan * RP, double * A, double * B, const int M, const int LDA, const connection_mod4 * C) {
     int N = RP->n;
     int NB = VALIGN(N);
     int M_star = (M-2)%16;
-    warp(A+2*N, N, M-2, 4);
-    warp(A+2*N, N, M_star, 2);
-    permute_sph(A+2*N, B+2*NB, N, M-2, 8);
-    for (int m = 2; m <= (M_star%8)/2; m++)
-        ft_kernel_sph_hi2lo_SSE(RP, m, B + NB*(2*m+1));
-    for (int m = (M_star%8+1)/2; m <= M_star/2; m += 4) {
-        ft_kernel_sph_hi2lo_AVX(RP, m, B + NB*(2*m+1));
-        ft_kernel_sph_hi2lo_AVX(RP, m+1, B + NB*(2*m+5));
-    }
+    int blas = C == NULL ? 1 : serial_blas_push();
     #pragma omp parallel
-    for (int m = (M_star+1)/2 + 8*FT_GET_THREAD_NUM(); m <= M/2-1; m += 8*FT_GET_NUM_THREADS()) {
-        ft_kernel_sph_hi2lo_AVX512(RP, m, B + NB*(2*m+1));
-        ft_kernel_sph_hi2lo_AVX512(RP, m+1, B + NB*(2*m+9));
+    {
+        double * W = B == NULL ? VMALLOC(NB*18*sizeof(double)) : NULL;
+        #pragma omp single nowait
+        {
+            double * Bh = W == NULL ? B : W;
+            warp_lda(A+2*LDA, N, M_star, 2, LDA);
+            permute_sph_lda(A+2*LDA, Bh+2*NB, N, M_star, 4, LDA);
+            for (int m = 2; m <= (M_star%8)/2; m++)
+                ft_kernel_sph_hi2lo_SSE(RP, m, Bh + NB*(2*m+1));
+            for (int m = (M_star%8+1)/2; m <= M_star/2; m += 4) {
+                ft_kernel_sph_hi2lo_AVX(RP, m, Bh + NB*(2*m+1));
+                ft_kernel_sph_hi2lo_AVX(RP, m+1, Bh + NB*(2*m+5));
+            }
+            permute_t_sph_lda(A+2*LDA, Bh+2*NB, N, M_star, 4, LDA);
+            warp_lda(A+2*LDA, N, M_star, 2, LDA);
+            if (C != NULL)
+                connect_mod4(C, A, N, 0, 2+M_star, LDA);
+        }
+        #pragma omp for schedule(dynamic) nowait
+        for (int m = (M_star+1)/2; m <= M/2-1; m += 8) {
+            double * Am = A+LDA*(2*m+1);
+            double * Bm = W == NULL ? B + NB*(2*m+1) : W;
+            warp_lda(Am, N, 16, 4, LDA);
+            permute_lda(Am, Bm, N, 16, 8, LDA);
+            ft_kernel_sph_hi2lo_AVX512(RP, m, Bm);
+            ft_kernel_sph_hi2lo_AVX512(RP, m+1, Bm + 8*NB);
+            permute_t_lda(Am, Bm, N, 16, 8, LDA);
+            warp_t_lda(Am, N, 16, 4, LDA);
+            if (C != NULL)
+                connect_mod4(C, A, N, 2*m+1, 2*m+1+16, LDA);
+        }
+        VFREE(W);
     }
-    permute_t_sph(A+2*N, B+2*NB, N, M-2, 8);
-    warp(A+2*N, N, M_star, 2);
-    warp_t(A+2*N, N, M-2, 4);
+    if (C != NULL)
+        serial_blas_pop(blas);
 }
 
-void ft_execute_sphv_lo2hi_AVX512(const ft_rotation_plan * RP, double * A, double * B, const int M) {
+void ft_execute_sphv_hi2lo_AVX512(const ft_rotation_plan * RP, double * A, double * B, const int M) {
+    execute_sphv_hi2lo_AVX512(RP, A, B, M, RP->n, NULL);
+}
+
+static void execute_sphv_lo2hi_AVX512(const ft_rotation_plan * RP, double * A, double * B, const int M, const int LDA, const connection_mod4 * C) {
     int N = RP->n;
     int NB = VALIGN(N);
     int M_star = (M-2)%16;
-    warp(A+2*N, N, M-2, 4);
-    warp(A+2*N, N, M_star, 2);
-    permute_sph(A+2*N, B+2*NB, N, M-2, 8);
-    for (int m = 2; m <= (M_star%8)/2; m++)
-        ft_kernel_sph_lo2hi_SSE(RP, m, B + NB*(2*m+1));
-    for (int m = (M_star%8+1)/2; m <= M_star/2; m += 4) {
-        ft_kernel_sph_lo2hi_AVX(RP, m, B + NB*(2*m+1));
-        ft_kernel_sph_lo2hi_AVX(RP, m+1, B + NB*(2*m+5));
-    }
+    int blas = C == NULL ? 1 : serial_blas_push();
     #pragma omp parallel
-    for (int m = (M_star+1)/2 + 8*FT_GET_THREAD_NUM(); m <= M/2-1; m += 8*FT_GET_NUM_THREADS()) {
-        ft_kernel_sph_lo2hi_AVX512(RP, m, B + NB*(2*m+1));
-        ft_kernel_sph_lo2hi_AVX512(RP, m+1, B + NB*(2*m+9));
+    {
+        double * W = B == NULL ? VMALLOC(NB*18*sizeof(double)) : NULL;
+        #pragma omp single nowait
+        {
+            double * Bh = W == NULL ? B : W;
+            if (C != NULL)
+                connect_mod4(C, A, N, 0, 2+M_star, LDA);
+            warp_lda(A+2*LDA, N, M_star, 2, LDA);
+            permute_sph_lda(A+2*LDA, Bh+2*NB, N, M_star, 4, LDA);
+            for (int m = 2; m <= (M_star%8)/2; m++)
+                ft_kernel_sph_lo2hi_SSE(RP, m, Bh + NB*(2*m+1));
+            for (int m = (M_star%8+1)/2; m <= M_star/2; m += 4) {
+                ft_kernel_sph_lo2hi_AVX(RP, m, Bh + NB*(2*m+1));
+                ft_kernel_sph_lo2hi_AVX(RP, m+1, Bh + NB*(2*m+5));
+            }
+            permute_t_sph_lda(A+2*LDA, Bh+2*NB, N, M_star, 4, LDA);
+            warp_lda(A+2*LDA, N, M_star, 2, LDA);
+        }
+        #pragma omp for schedule(dynamic) nowait
+        for (int m = (M_star+1)/2; m <= M/2-1; m += 8) {
+            double * Am = A+LDA*(2*m+1);
+            double * Bm = W == NULL ? B + NB*(2*m+1) : W;
+            if (C != NULL)
+                connect_mod4(C, A, N, 2*m+1, 2*m+1+16, LDA);
+            warp_lda(Am, N, 16, 4, LDA);
+            permute_lda(Am, Bm, N, 16, 8, LDA);
+            ft_kernel_sph_lo2hi_AVX512(RP, m, Bm);
+            ft_kernel_sph_lo2hi_AVX512(RP, m+1, Bm + 8*NB);
+            permute_t_lda(Am, Bm, N, 16, 8, LDA);
+            warp_t_lda(Am, N, 16, 4, LDA);
+        }
+        VFREE(W);
     }
-    permute_t_sph(A+2*N, B+2*NB, N, M-2, 8);
-    warp(A+2*N, N, M_star, 2);
-    warp_t(A+2*N, N, M-2, 4);
+    if (C != NULL)
+        serial_blas_pop(blas);
+}
+
+void ft_execute_sphv_lo2hi_AVX512(const ft_rotation_plan * RP, double * A, double * B, const int M) {
+    execute_sphv_lo2hi_AVX512(RP, A, B, M, RP->n, NULL);
 }
 
 void ft_execute_tri_hi2lo(const ft_rotation_plan * RP, double * A, const int M) {
@@ -361,32 +812,64 @@ void ft_execute_tri_lo2hi_AVX(const ft_rotation_plan * RP, double * A, double *
     permute_t_tri(A, B, N, M, 4);
 }
 
-void ft_execute_tri_hi2lo_AVX512(const ft_rotation_plan * RP, double * A, double * B, const int M) {
+static void execute_tri_hi2lo_AVX512(const ft_rotation_plan * RP, double * A, double * B, const int M, const int LDA) {
     int N = RP->n;
     int NB = VALIGN(N);
-    permute_tri(A, B, N, M, 8);
-    for (int m = M%2; m < M%8; m += 2)
-        ft_kernel_tri_hi2lo_SSE(RP, m, B+NB*m);
-    for (int m = M%8; m < M%16; m += 4)
-        ft_kernel_tri_hi2lo_AVX(RP, m, B+NB*m);
     #pragma omp parallel
-    for (int m = M%16 + 8*FT_GET_THREAD_NUM(); m < M; m += 8*FT_GET_NUM_THREADS())
-        ft_kernel_tri_hi2lo_AVX512(RP, m, B+NB*m);
-    permute_t_tri(A, B, N, M, 8);
+    {
+        double * W = B == NULL ? VMALLOC(NB*16*sizeof(double)) : NULL;
+        #pragma omp single nowait
+        {
+            double * Bh = W == NULL ? B : W;
+            permute_tri_lda(A, Bh, N, M%16, 4, LDA);
+            for (int m = M%2; m < M%8; m += 2)
+                ft_kernel_tri_hi2lo_SSE(RP, m, Bh+NB*m);
+            for (int m = M%8; m < M%16; m += 4)
+                ft_kernel_tri_hi2lo_AVX(RP, m, Bh+NB*m);
+            permute_t_tri_lda(A, Bh, N, M%16, 4, LDA);
+        }
+        for (int m = M%16 + 8*FT_GET_THREAD_NUM(); m < M; m += 8*FT_GET_NUM_THREADS()) {
+            double * Bm = W == NULL ? B+NB*m : W;
+            permute_lda(A+LDA*m, Bm, N, 8, 8, LDA);
+            ft_kernel_tri_hi2lo_AVX512(RP, m, Bm);
+            permute_t_lda(A+LDA*m, Bm, N, 8, 8, LDA);
+        }
+        VFREE(W);
+    }
 }
 
-void ft_execute_tri_lo2hi_AVX512(const ft_rotation_plan * RP, double * A, double * B, const int M) {
+void ft_execute_tri_hi2lo_AVX512(const ft_rotation_plan * RP, double * A, double * B, const int M) {
+    execute_tri_hi2lo_AVX512(RP, A, B, M, RP->n);
+}
+
+static void execute_tri_lo2hi_AVX512(const ft_rotation_plan * RP, double * A, double * B, const int M, const int LDA) {
     int N = RP->n;
     int NB = VALIGN(N);
-    permute_tri(A, B, N, M, 8);
-    for (int m = M%2; m < M%8; m += 2)
-        ft_kernel_tri_lo2hi_SSE(RP, m, B+NB*m);
-    for (int m = M%8; m < M%16; m += 4)
-        ft_kernel_tri_lo2hi_AVX(RP, m, B+NB*m);
     #pragma omp parallel
-    for (int m = M%16 + 8*FT_GET_THREAD_NUM(); m < M; m += 8*FT_GET_NUM_THREADS())
-        ft_kernel_tri_lo2hi_AVX512(RP, m, B+NB*m);
-    permute_t_tri(A, B, N, M, 8);
+    {
+        double * W = B == NULL ? VMALLOC(NB*16*sizeof(double)) : NULL;
+        #pragma omp single nowait
+        {
+            double * Bh = W == NULL ? B : W;
+            permute_tri_lda(A, Bh, N, M%16, 4, LDA);
+            for (int m = M%2; m < M%8; m += 2)
+                ft_kernel_tri_lo2hi_SSE(RP, m, Bh+NB*m);
+            for (int m = M%8; m < M%16; m += 4)
+                ft_kernel_tri_lo2hi_AVX(RP, m, Bh+NB*m);
+            permute_t_tri_lda(A, Bh, N, M%16, 4, LDA);
+        }
+        for (int m = M%16 + 8*FT_GET_THREAD_NUM(); m < M; m += 8*FT_GET_NUM_THREADS()) {
+            double * Bm = W == NULL ? B+NB*m : W;
+            permute_lda(A+LDA*m, Bm, N, 8, 8, LDA);
+            ft_kernel_tri_lo2hi_AVX512(RP, m, Bm);
+            permute_t_lda(A+LDA*m, Bm, N, 8, 8, LDA);
+        }
+        VFREE(W);
+    }
+}
+
+void ft_execute_tri_lo2hi_AVX512(const ft_rotation_plan * RP, double * A, double * B, const int M) {
+    execute_tri_lo2hi_AVX512(RP, A, B, M, RP->n);
 }
 
 
@@ -460,50 +943,98 @@ void ft_execute_disk_lo2hi_AVX(const ft_rotation_plan * RP, double * A, double *
     warp(A, N, M, 2);
 }
 
-void ft_execute_disk_hi2lo_AVX512(const ft_rotation_plan * RP, double * A, double * B, const int M) {
+static void execute_disk_hi2lo_AVX512(const ft_rotation_plan * RP, double * A, double * B, const int M, const int LDA, const connection_mod4 * C) {
     int N = RP->n;
     int NB = VALIGN(N);
     int M_star = M%16;
-    warp(A, N, M, 4);
-    warp(A, N, M_star, 2);
-    permute_disk(A, B, N, M, 8);
-    for (int m = 2; m <= (M_star%8)/2; m++)
-        ft_kernel_disk_hi2lo_SSE(RP, m, B + NB*(2*m-1));
-    for (int m = (M_star%8+1)/2; m <= M_star/2; m += 4) {
-        ft_kernel_disk_hi2lo_AVX(RP, m, B + NB*(2*m-1));
-        ft_kernel_disk_hi2lo_AVX(RP, m+1, B + NB*(2*m+3));
-    }
+    int blas = C == NULL ? 1 : serial_blas_push();
     #pragma omp parallel
-    for (int m = (M_star+1)/2 + 8*FT_GET_THREAD_NUM(); m <= M/2; m += 8*FT_GET_NUM_THREADS()) {
-        ft_kernel_disk_hi2lo_AVX512(RP, m, B + NB*(2*m-1));
-        ft_kernel_disk_hi2lo_AVX512(RP, m+1, B + NB*(2*m+7));
+    {
+        double * W = B == NULL ? VMALLOC(NB*16*sizeof(double)) : NULL;
+        #pragma omp single nowait
+        {
+            double * Bh = W == NULL ? B : W;
+            warp_lda(A, N, M_star, 2, LDA);
+            permute_disk_lda(A, Bh, N, M_star, 4, LDA);
+            for (int m = 2; m <= (M_star%8)/2; m++)
+                ft_kernel_disk_hi2lo_SSE(RP, m, Bh + NB*(2*m-1));
+            for (int m = (M_star%8+1)/2; m <= M_star/2; m += 4) {
+                ft_kernel_disk_hi2lo_AVX(RP, m, Bh + NB*(2*m-1));
+                ft_kernel_disk_hi2lo_AVX(RP, m+1, Bh + NB*(2*m+3));
+            }
+            permute_t_disk_lda(A, Bh, N, M_star, 4, LDA);
+            warp_lda(A, N, M_star, 2, LDA);
+            if (C != NULL)
+                connect_mod4(C, A, N, 0, M_star, LDA);
+        }
+        #pragma omp for schedule(dynamic) nowait
+        for (int m = (M_star+1)/2; m <= M/2; m += 8) {
+            double * Am = A+LDA*(2*m-1);
+            double * Bm = W == NULL ? B + NB*(2*m-1) : W;
+            warp_lda(Am, N, 16, 4, LDA);
+            permute_lda(Am, Bm, N, 16, 8, LDA);
+            ft_kernel_disk_hi2lo_AVX512(RP, m, Bm);
+            ft_kernel_disk_hi2lo_AVX512(RP, m+1, Bm + 8*NB);
+            permute_t_lda(Am, Bm, N, 16, 8, LDA);
+            warp_t_lda(Am, N, 16, 4, LDA);
+            if (C != NULL)
+                connect_mod4(C, A, N, 2*m-1, 2*m-1+16, LDA);
+        }
+        VFREE(W);
     }
-    permute_t_disk(A, B, N, M, 8);
-    warp(A, N, M_star, 2);
-    warp_t(A, N, M, 4);
+    if (C != NULL)
+        serial_blas_pop(blas);
 }
 
-void ft_execute_disk_lo2hi_AVX512(const ft_rotation_plan * RP, double * A, double * B, const int M) {
+void ft_execute_disk_hi2lo_AVX512(const ft_rotation_plan * RP, double * A, double * B, const int M) {
+    execute_disk_hi2lo_AVX512(RP, A, B, M, RP->n, NULL);
+}
+
+static void execute_disk_lo2hi_AVX512(const ft_rotation_plan * RP, double * A, double * B, const int M, const int LDA, const connection_mod4 * C) {
     int N = RP->n;
     int NB = VALIGN(N);
     int M_star = M%16;
-    warp(A, N, M, 4);
-    warp(A, N, M_star, 2);
-    permute_disk(A, B, N, M, 8);
-    for (int m = 2; m <= (M_star%8)/2; m++)
-        ft_kernel_disk_lo2hi_SSE(RP, m, B + NB*(2*m-1));
-    for (int m = (M_star%8+1)/2; m <= M_star/2; m += 4) {
-        ft_kernel_disk_lo2hi_AVX(RP, m, B + NB*(2*m-1));
-        ft_kernel_disk_lo2hi_AVX(RP, m+1, B + NB*(2*m+3));
-    }
+    int blas = C == NULL ? 1 : serial_blas_push();
     #pragma omp parallel
-    for (int m = (M_star+1)/2 + 8*FT_GET_THREAD_NUM(); m <= M/2; m += 8*FT_GET_NUM_THREADS()) {
-        ft_kernel_disk_lo2hi_AVX512(RP, m, B + NB*(2*m-1));
-        ft_kernel_disk_lo2hi_AVX512(RP, m+1, B + NB*(2*m+7));
+    {
+        double * W = B == NULL ? VMALLOC(NB*16*sizeof(double)) : NULL;
+        #pragma omp single nowait
+        {
+            double * Bh = W == NULL ? B : W;
+            if (C != NULL)
+                connect_mod4(C, A, N, 0, M_star, LDA);
+            warp_lda(A, N, M_star, 2, LDA);
+            permute_disk_lda(A, Bh, N, M_star, 4, LDA);
+            for (int m = 2; m <= (M_star%8)/2; m++)
+                ft_kernel_disk_lo2hi_SSE(RP, m, Bh + NB*(2*m-1));
+            for (int m = (M_star%8+1)/2; m <= M_star/2; m += 4) {
+                ft_kernel_disk_lo2hi_AVX(RP, m, Bh + NB*(2*m-1));
+                ft_kernel_disk_lo2hi_AVX(RP, m+1, Bh + NB*(2*m+3));
+            }
+            permute_t_disk_lda(A, Bh, N, M_star, 4, LDA);
+            warp_lda(A, N, M_star, 2, LDA);
+        }
+        #pragma omp for schedule(dynamic) nowait
+        for (int m = (M_star+1)/2; m <= M/2; m += 8) {
+            double * Am = A+LDA*(2*m-1);
+            double * Bm = W == NULL ? B + NB*(2*m-1) : W;
+            if (C != NULL)
+                connect_mod4(C, A, N, 2*m-1, 2*m-1+16, LDA);
+            warp_lda(Am, N, 16, 4, LDA);
+            permute_lda(Am, Bm, N, 16, 8, LDA);
+            ft_kernel_disk_lo2hi_AVX512(RP, m, Bm);
+            ft_kernel_disk_lo2hi_AVX512(RP, m+1, Bm + 8*NB);
+            permute_t_lda(Am, Bm, N, 16, 8, LDA);
+            warp_t_lda(Am, N, 16, 4, LDA);
+        }
+        VFREE(W);
     }
-    permute_t_disk(A, B, N, M, 8);
-    warp(A, N, M_star, 2);
-    warp_t(A, N, M, 4);
+    if (C != NULL)
+        serial_blas_pop(blas);
+}
+
+void ft_execute_disk_lo2hi_AVX512(const ft_rotation_plan * RP, double * A, double * B, const int M) {
+    execute_disk_lo2hi_AVX512(RP, A, B, M, RP->n, NULL);
 }
 
 
@@ -599,48 +1130,81 @@ void ft_execute_tet_lo2hi_AVX(const ft_rotation_plan * RP1, const ft_rotation_pl
     }
 }
 
-void ft_execute_tet_hi2lo_AVX512(const ft_rotation_plan * RP1, const ft_rotation_plan * RP2, double * A, double * B, const int L, const int M) {
+// Each order m is a task. Its triangular sweeps split into tasks over blocks of eight l,
+// and its tetrahedral sweep into tasks over blocks of TET_ROW_BLOCK rows, so threads stay
+// busy when M is small or the orders are unevenly expensive.
+#define TET_ROW_BLOCK 64
+
+static void execute_tet_hi2lo_AVX512(const ft_rotation_plan * RP1, const ft_rotation_plan * RP2, double * A, double * B, const int L, const int M, const int LDA) {
     int N = RP1->n;
     int NB = VALIGN(N);
     #pragma omp parallel
-    for (int m = FT_GET_THREAD_NUM(); m < M; m += FT_GET_NUM_THREADS()) {
-        permute_tri(A+N*L*m, B+NB*L*m, N, L-m, 8);
-        if ((L-m)%2)
-            ft_kernel_tri_hi2lo(RP1, m, B+NB*L*m);
-        for (int l = (L-m)%2; l < (L-m)%8; l += 2)
-            ft_kernel_tri_hi2lo_SSE(RP1, l+m, B+NB*(l+L*m));
-        for (int l = (L-m)%8; l < (L-m)%16; l += 4)
-            ft_kernel_tri_hi2lo_AVX(RP1, l+m, B+NB*(l+L*m));
-        for (int l = (L-m)%16; l < L-m; l += 8)
-            ft_kernel_tri_hi2lo_AVX512(RP1, l+m, B+NB*(l+L*m));
-        permute_t_tri(A+N*L*m, B+NB*L*m, N, L-m, 8);
-        permute(A+N*L*m, B+NB*L*m, N, L, 1);
-        ft_kernel_tet_hi2lo_AVX512(RP2, L, m, B+NB*L*m);
-        permute_t(A+N*L*m, B+NB*L*m, N, L, 1);
+    #pragma omp single
+    for (int m = 0; m < M; m++) {
+        #pragma omp task firstprivate(m)
+        {
+            double * Bm = B == NULL ? VMALLOC(NB*L*sizeof(double)) : B+NB*L*m;
+            permute_tri_lda(A+LDA*L*m, Bm, N, L-m, 8, LDA);
+            if ((L-m)%2)
+                ft_kernel_tri_hi2lo(RP1, m, Bm);
+            for (int l = (L-m)%2; l < (L-m)%8; l += 2)
+                ft_kernel_tri_hi2lo_SSE(RP1, l+m, Bm+NB*l);
+            for (int l = (L-m)%8; l < (L-m)%16; l += 4)
+                ft_kernel_tri_hi2lo_AVX(RP1, l+m, Bm+NB*l);
+            #pragma omp taskloop grainsize(1)
+            for (int l = (L-m)%16; l < L-m; l += 8)
+                ft_kernel_tri_hi2lo_AVX512(RP1, l+m, Bm+NB*l);
+            permute_t_tri_lda(A+LDA*L*m, Bm, N, L-m, 8, LDA);
+            permute_lda(A+LDA*L*m, Bm, N, L, 1, LDA);
+            #pragma omp taskloop grainsize(1)
+            for (int k = 0; k < N; k += TET_ROW_BLOCK)
+                ft_kernel_tet_hi2lo_AVX512_rows(RP2, L, m, Bm, k, MIN(k+TET_ROW_BLOCK, N));
+            permute_t_lda(A+LDA*L*m, Bm, N, L, 1, LDA);
+            if (B == NULL)
+                VFREE(Bm);
+        }
     }
 }
 
-void ft_execute_tet_lo2hi_AVX512(const ft_rotation_plan * RP1, const ft_rotation_plan * RP2, double * A, double * B, const int L, const int M) {
+void ft_execute_tet_hi2lo_AVX512(const ft_rotation_plan * RP1, const ft_rotation_plan * RP2, double * A, double * B, const int L, const int M) {
+    execute_tet_hi2lo_AVX512(RP1, RP2, A, B, L, M, RP1->n);
+}
+
+static void execute_tet_lo2hi_AVX512(const ft_rotation_plan * RP1, const ft_rotation_plan * RP2, double * A, double * B, const int L, const int M, const int LDA) {
     int N = RP1->n;
     int NB = VALIGN(N);
     #pragma omp parallel
-    for (int m = FT_GET_THREAD_NUM(); m < M; m += FT_GET_NUM_THREADS()) {
-        permute(A+N*L*m, B+NB*L*m, N, L, 1);
-        ft_kernel_tet_lo2hi_AVX512(RP2, L, m, B+NB*L*m);
-        permute_t(A+N*L*m, B+NB*L*m, N, L, 1);
-        permute_tri(A+N*L*m, B+NB*L*m, N, L-m, 8);
-        if ((L-m)%2)
-            ft_kernel_tri_lo2hi(RP1, m, B+NB*L*m);
-        for (int l = (L-m)%2; l < (L-m)%8; l += 2)
-            ft_kernel_tri_lo2hi_SSE(RP1, l+m, B+NB*(l+L*m));
-        for (int l = (L-m)%8; l < (L-m)%16; l += 4)
-            ft_kernel_tri_lo2hi_AVX(RP1, l+m, B+NB*(l+L*m));
-        for (int l = (L-m)%16; l < L-m; l += 8)
-            ft_kernel_tri_lo2hi_AVX512(RP1, l+m, B+NB*(l+L*m));
-        permute_t_tri(A+N*L*m, B+NB*L*m, N, L-m, 8);
+    #pragma omp single
+    for (int m = 0; m < M; m++) {
+        #pragma omp task firstprivate(m)
+        {
+            double * Bm = B == NULL ? VMALLOC(NB*L*sizeof(double)) : B+NB*L*m;
+            permute_lda(A+LDA*L*m, Bm, N, L, 1, LDA);
+            #pragma omp taskloop grainsize(1)
+            for (int k = 0; k < N; k += TET_ROW_BLOCK)
+                ft_kernel_tet_lo2hi_AVX512_rows(RP2, L, m, Bm, k, MIN(k+TET_ROW_BLOCK, N));
+            permute_t_lda(A+LDA*L*m, Bm, N, L, 1, LDA);
+            permute_tri_lda(A+LDA*L*m, Bm, N, L-m, 8, LDA);
+            if ((L-m)%2)
+                ft_kernel_tri_lo2hi(RP1, m, Bm);
+            for (int l = (L-m)%2; l < (L-m)%8; l += 2)
+                ft_kernel_tri_lo2hi_SSE(RP1, l+m, Bm+NB*l);
+            for (int l = (L-m)%8; l < (L-m)%16; l += 4)
+                ft_kernel_tri_lo2hi_AVX(RP1, l+m, Bm+NB*l);
+            #pragma omp taskloop grainsize(1)
+            for (int l = (L-m)%16; l < L-m; l += 8)
+                ft_kernel_tri_lo2hi_AVX512(RP1, l+m, Bm+NB*l);
+            permute_t_tri_lda(A+LDA*L*m, Bm, N, L-m, 8, LDA);
+            if (B == NULL)
+                VFREE(Bm);
+        }
     }
 }
 
+void ft_execute_tet_lo2hi_AVX512(const ft_rotation_plan * RP1, const ft_rotation_plan * RP2, double * A, double * B, const int L, const int M) {
+    execute_tet_lo2hi_AVX512(RP1, RP2, A, B, L, M, RP1->n);
+}
+
 
 void ft_execute_spinsph_hi2lo(const ft_spin_rotation_plan * SRP, double * A, const int M) {
     int N = SRP->n;
@@ -768,183 +1332,595 @@ void ft_execute_spinsph_lo2hi_AVX512(const ft_spin_rotation_plan * SRP, double *
 
 
 void ft_destroy_harmonic_plan(ft_harmonic_plan * P) {
-    ft_destroy_rotation_plan(P->RP);
+    release_rotation(P->RP);
     VFREE(P->B);
-    free(P->P1);
-    free(P->P2);
-    free(P->P1inv);
-    free(P->P2inv);
+    release_connection(P->P1);
+    release_connection(P->P2);
+    release_connection(P->P1inv);
+    release_connection(P->P2inv);
+    destroy_fmm(P->F1);
+    destroy_fmm(P->F2);
     free(P);
 }
 
-ft_harmonic_plan * ft_plan_sph2fourier(const int n) {
+void ft_set_harmonic_plan_num_threads(ft_harmonic_plan * P, const int n) {P->nthreads = n;}
+
+void ft_set_harmonic_plan_streaming(ft_harmonic_plan * P, const int streaming) {
+    if (streaming && P->B != NULL) {
+        VFREE(P->B);
+        P->B = NULL;
+    }
+    else if (!streaming && P->B == NULL)
+        P->B = VMALLOC(P->lwork * sizeof(double));
+}
+
+// The workspace has VALIGN(n) rows and n, 2n-1 or 4n-3 columns, which a view rescales to its degree.
+static size_t view_lwork(const size_t lwork, const int n, const int N) {
+    size_t cols = lwork/VALIGN(n);
+    return (size_t) VALIGN(N) * (cols == (size_t) n ? N : cols == (size_t) 2*n-1 ? 2*N-1 : 4*N-3);
+}
+
+ft_harmonic_plan * ft_view_harmonic_plan(const ft_harmonic_plan * P, const int n) {
+    if (P->F1 != NULL) {
+        printf(RED("FastTransforms: a harmonic plan with FMM connections cannot be viewed at a smaller degree.")"\n");
+        exit(EXIT_FAILURE);
+    }
+    ft_harmonic_plan * V = malloc(sizeof(ft_harmonic_plan));
+    *V = *P;
+    V->RP = ft_view_rotation_plan(P->RP, n);
+    V->lwork = view_lwork(P->lwork, P->RP->n, n);
+    V->B = P->B == NULL ? NULL : VMALLOC(V->lwork * sizeof(double));
+    return V;
+}
+
+void ft_destroy_harmonic_plan_view(ft_harmonic_plan * V) {
+    ft_destroy_rotation_plan_view(V->RP);
+    VFREE(V->B);
+    free(V);
+}
+
+// The plans on the sphere, the triangle and the disk have one rotation plan and two connections.
+static ft_harmonic_plan * plan_harmonic(const ft_cache_key * K, const size_t lwork, const int flags) {
     ft_harmonic_plan * P = malloc(sizeof(ft_harmonic_plan));
-    P->RP = ft_plan_rotsphere(n);
-    P->B = VMALLOC(VALIGN(n) * (2*n-1) * sizeof(double));
-    P->P1 = plan_legendre_to_chebyshev(1, 0, n);
-    P->P2 = plan_ultraspherical_to_ultraspherical(1, 0, n, 1.5, 1.0);
-    P->P1inv = plan_chebyshev_to_legendre(0, 1, n);
-    P->P2inv = plan_ultraspherical_to_ultraspherical(0, 1, n, 1.0, 1.5);
+    P->lwork = lwork;
+    P->B = flags & FT_HARMONIC_STREAMING ? NULL : VMALLOC(P->lwork * sizeof(double));
+    P->P1 = P->P2 = P->P1inv = P->P2inv = NULL;
+    P->F1 = P->F2 = NULL;
+    if (use_fmm(K->n, flags)) {
+        P->RP = acquire_rotation(K);
+        P->F1 = build_fmm(K+1);
+        P->F2 = build_fmm(K+2);
+    }
+    else {
+        // The rotations and the connection matrices are built as concurrent tasks, and each matrix
+        // spreads its columns over the same team.
+        #pragma omp parallel
+        #pragma omp single
+        {
+            #pragma omp task
+            P->RP = acquire_rotation(K);
+            #pragma omp task
+            P->P1 = acquire_connection(K+1);
+            #pragma omp task
+            P->P2 = acquire_connection(K+2);
+            if (!(flags & FT_HARMONIC_SOLVE)) {
+                #pragma omp task
+                P->P1inv = acquire_connection(K+3);
+                #pragma omp task
+                P->P2inv = acquire_connection(K+4);
+            }
+        }
+    }
+    P->nthreads = 0;
     return P;
 }
 
+// Extends the components of P to those of K, of a higher degree, computing only the new rotations
+// and columns of the dense connections. The FMM factorizations are not nested and are rebuilt.
+static void extend_harmonic(ft_harmonic_plan * P, const ft_cache_key * K, const size_t lwork) {
+    int n0 = P->RP->ns;
+    if (K->n <= P->RP->n)
+        return;
+    if (P->RP->n != n0) {
+        printf(RED("FastTransforms: a view of a harmonic plan cannot be extended.")"\n");
+        exit(EXIT_FAILURE);
+    }
+    ft_plan_file * PF = ft_plan_file_owning(P);
+    #pragma omp parallel
+    #pragma omp single
+    {
+        #pragma omp task
+        P->RP = extend_rotation(K, P->RP, PF);
+        #pragma omp task
+        P->P1 = extend_connection(K+1, P->P1, n0, PF);
+        #pragma omp task
+        P->P2 = extend_connection(K+2, P->P2, n0, PF);
+        #pragma omp task
+        P->P1inv = extend_connection(K+3, P->P1inv, n0, PF);
+        #pragma omp task
+        P->P2inv = extend_connection(K+4, P->P2inv, n0, PF);
+    }
+    if (P->F1 != NULL) {
+        if (PF == NULL) {
+            destroy_fmm(P->F1);
+            destroy_fmm(P->F2);
+        }
+        P->F1 = build_fmm(K+1);
+        P->F2 = build_fmm(K+2);
+        if (PF != NULL) {
+            ft_plan_file_own(PF, P->F1, destroy_fmm_component);
+            ft_plan_file_own(PF, P->F2, destroy_fmm_component);
+        }
+    }
+    P->lwork = lwork;
+    if (P->B != NULL) {
+        VFREE(P->B);
+        P->B = VMALLOC(P->lwork * sizeof(double));
+    }
+}
+
+ft_harmonic_plan * ft_plan_sph2fourier(const int n) {return ft_plan_sph2fourier_with_flags(n, 0);}
+
+ft_harmonic_plan * ft_plan_sph2fourier_with_flags(const int n, const int flags) {
+    ft_cache_key K[5];
+    sph2fourier_components(K, n);
+    return plan_harmonic(K, (size_t) VALIGN(n) * (2*n-1), flags);
+}
+
+void ft_extend_sph2fourier(ft_harmonic_plan * P, const int n) {
+    ft_cache_key K[5];
+    sph2fourier_components(K, n);
+    extend_harmonic(P, K, (size_t) VALIGN(n) * (2*n-1));
+}
+
+void ft_execute_sph2fourier_parity_lda(const ft_harmonic_plan * P, double * A, const int N, const int M, const int LDA, const int parity) {
+    ft_thread_state s = push_num_threads(P->nthreads);
+    connection_mod4 C = {{P->P1, P->P2, P->P2, P->P1}, {P->F1, P->F2, P->F2, P->F1}, P->RP->ns, 0};
+    execute_sph_hi2lo_AVX512(P->RP, A, harmonic_workspace(P->B), M, LDA, &C, parity);
+    pop_num_threads(s);
+}
+
+void ft_execute_sph2fourier_parity(const ft_harmonic_plan * P, double * A, const int N, const int M, const int parity) {
+    ft_execute_sph2fourier_parity_lda(P, A, N, M, N, parity);
+}
+
+void ft_execute_sph2fourier_lda(const ft_harmonic_plan * P, double * A, const int N, const int M, const int LDA) {
+    ft_execute_sph2fourier_parity_lda(P, A, N, M, LDA, FT_PARITY_BOTH);
+}
+
 void ft_execute_sph2fourier(const ft_harmonic_plan * P, double * A, const int N, const int M) {
-    ft_execute_sph_hi2lo_AVX512(P->RP, A, P->B, M);
-    cblas_dtrmm(CblasColMajor, CblasLeft, CblasUpper, CblasNoTrans, CblasNonUnit, N, (M+3)/4, 1.0, P->P1, N, A, 4*N);
-    cblas_dtrmm(CblasColMajor, CblasLeft, CblasUpper, CblasNoTrans, CblasNonUnit, N, (M+2)/4, 1.0, P->P2, N, A+N, 4*N);
-    cblas_dtrmm(CblasColMajor, CblasLeft, CblasUpper, CblasNoTrans, CblasNonUnit, N, (M+1)/4, 1.0, P->P2, N, A+2*N, 4*N);
-    cblas_dtrmm(CblasColMajor, CblasLeft, CblasUpper, CblasNoTrans, CblasNonUnit, N, M/4, 1.0, P->P1, N, A+3*N, 4*N);
+    ft_execute_sph2fourier_lda(P, A, N, M, N);
+}
+
+void ft_execute_fourier2sph_parity_lda(const ft_harmonic_plan * P, double * A, const int N, const int M, const int LDA, const int parity) {
+    ft_thread_state s = push_num_threads(P->nthreads);
+    connection_mod4 C = {{P->P1inv, P->P2inv, P->P2inv, P->P1inv}, {NULL, NULL, NULL, NULL}, P->RP->ns, 0};
+    if (P->P1inv == NULL)
+        C = (connection_mod4) {{P->P1, P->P2, P->P2, P->P1}, {P->F1, P->F2, P->F2, P->F1}, P->RP->ns, 1};
+    execute_sph_lo2hi_AVX512(P->RP, A, harmonic_workspace(P->B), M, LDA, &C, parity);
+    pop_num_threads(s);
+}
+
+void ft_execute_fourier2sph_parity(const ft_harmonic_plan * P, double * A, const int N, const int M, const int parity) {
+    ft_execute_fourier2sph_parity_lda(P, A, N, M, N, parity);
+}
+
+void ft_execute_fourier2sph_lda(const ft_harmonic_plan * P, double * A, const int N, const int M, const int LDA) {
+    ft_execute_fourier2sph_parity_lda(P, A, N, M, LDA, FT_PARITY_BOTH);
 }
 
 void ft_execute_fourier2sph(const ft_harmonic_plan * P, double * A, const int N, const int M) {
-    cblas_dtrmm(CblasColMajor, CblasLeft, CblasUpper, CblasNoTrans, CblasNonUnit, N, (M+3)/4, 1.0, P->P1inv, N, A, 4*N);
-    cblas_dtrmm(CblasColMajor, CblasLeft, CblasUpper, CblasNoTrans, CblasNonUnit, N, (M+2)/4, 1.0, P->P2inv, N, A+N, 4*N);
-    cblas_dtrmm(CblasColMajor, CblasLeft, CblasUpper, CblasNoTrans, CblasNonUnit, N, (M+1)/4, 1.0, P->P2inv, N, A+2*N, 4*N);
-    cblas_dtrmm(CblasColMajor, CblasLeft, CblasUpper, CblasNoTrans, CblasNonUnit, N, M/4, 1.0, P->P1inv, N, A+3*N, 4*N);
-    ft_execute_sph_lo2hi_AVX512(P->RP, A, P->B, M);
+    ft_execute_fourier2sph_lda(P, A, N, M, N);
+}
+
+// The out-of-core drivers stream windows of whole blocks of 16 columns, the first with the head, and
+// rotate them through per-thread buffers as the workspace of the plan is the size of the array.
+typedef struct {
+    const ft_harmonic_plan * P;
+    connection_mod4 C;
+    int M;
+} ooc_harmonic_context;
+
+static void ooc_sph2fourier_kernel(const void * ctx, double * A, const int LDA, const int j0, const int j1) {
+    const ooc_harmonic_context * H = ctx;
+    execute_sph_hi2lo_AVX512_window(H->P->RP, A, NULL, H->M, LDA, &H->C, FT_PARITY_BOTH, j0, j1);
+}
+
+static void ooc_fourier2sph_kernel(const void * ctx, double * A, const int LDA, const int j0, const int j1) {
+    const ooc_harmonic_context * H = ctx;
+    execute_sph_lo2hi_AVX512_window(H->P->RP, A, NULL, H->M, LDA, &H->C, FT_PARITY_BOTH, j0, j1);
+}
+
+static ooc_harmonic_context ooc_sph2fourier_context(const ft_harmonic_plan * P, const int M) {
+    return (ooc_harmonic_context) {P, {{P->P1, P->P2, P->P2, P->P1}, {P->F1, P->F2, P->F2, P->F1}, P->RP->ns, 0}, M};
+}
+
+static ooc_harmonic_context ooc_fourier2sph_context(const ft_harmonic_plan * P, const int M) {
+    if (P->P1inv == NULL)
+        return (ooc_harmonic_context) {P, {{P->P1, P->P2, P->P2, P->P1}, {P->F1, P->F2, P->F2, P->F1}, P->RP->ns, 1}, M};
+    return (ooc_harmonic_context) {P, {{P->P1inv, P->P2inv, P->P2inv, P->P1inv}, {NULL, NULL, NULL, NULL}, P->RP->ns, 0}, M};
+}
+
+int ft_execute_sph2fourier_file(const ft_harmonic_plan * P, const char * filename, const size_t offset, const int N, const int M) {
+    ft_thread_state s = push_num_threads(P->nthreads);
+    ooc_harmonic_context H = ooc_sph2fourier_context(P, M);
+    int info = ft_stream_columns_file(filename, offset, N, M, M%16, ft_out_of_core_window(N, M, 16), ooc_sph2fourier_kernel, &H);
+    pop_num_threads(s);
+    return info;
+}
+
+int ft_execute_fourier2sph_file(const ft_harmonic_plan * P, const char * filename, const size_t offset, const int N, const int M) {
+    ft_thread_state s = push_num_threads(P->nthreads);
+    ooc_harmonic_context H = ooc_fourier2sph_context(P, M);
+    int info = ft_stream_columns_file(filename, offset, N, M, M%16, ft_out_of_core_window(N, M, 16), ooc_fourier2sph_kernel, &H);
+    pop_num_threads(s);
+    return info;
+}
+
+void ft_execute_sph2fourier_mapped(const ft_harmonic_plan * P, double * A, const int N, const int M) {
+    ft_thread_state s = push_num_threads(P->nthreads);
+    ooc_harmonic_context H = ooc_sph2fourier_context(P, M);
+    ft_stream_columns_mapped(A, N, M, M%16, ft_out_of_core_window(N, M, 16), ooc_sph2fourier_kernel, &H);
+    pop_num_threads(s);
+}
+
+void ft_execute_fourier2sph_mapped(const ft_harmonic_plan * P, double * A, const int N, const int M) {
+    ft_thread_state s = push_num_threads(P->nthreads);
+    ooc_harmonic_context H = ooc_fourier2sph_context(P, M);
+    ft_stream_columns_mapped(A, N, M, M%16, ft_out_of_core_window(N, M, 16), ooc_fourier2sph_kernel, &H);
+    pop_num_threads(s);
+}
+
+void ft_execute_sphv2fourier_lda(const ft_harmonic_plan * P, double * A, const int N, const int M, const int LDA) {
+    ft_thread_state s = push_num_threads(P->nthreads);
+    connection_mod4 C = {{P->P2, P->P1, P->P1, P->P2}, {P->F2, P->F1, P->F1, P->F2}, P->RP->ns, 0};
+    execute_sphv_hi2lo_AVX512(P->RP, A, harmonic_workspace(P->B), M, LDA, &C);
+    pop_num_threads(s);
 }
 
 void ft_execute_sphv2fourier(const ft_harmonic_plan * P, double * A, const int N, const int M) {
-    ft_execute_sphv_hi2lo_AVX512(P->RP, A, P->B, M);
-    cblas_dtrmm(CblasColMajor, CblasLeft, CblasUpper, CblasNoTrans, CblasNonUnit, N, (M+3)/4, 1.0, P->P2, N, A, 4*N);
-    cblas_dtrmm(CblasColMajor, CblasLeft, CblasUpper, CblasNoTrans, CblasNonUnit, N, (M+2)/4, 1.0, P->P1, N, A+N, 4*N);
-    cblas_dtrmm(CblasColMajor, CblasLeft, CblasUpper, CblasNoTrans, CblasNonUnit, N, (M+1)/4, 1.0, P->P1, N, A+2*N, 4*N);
-    cblas_dtrmm(CblasColMajor, CblasLeft, CblasUpper, CblasNoTrans, CblasNonUnit, N, M/4, 1.0, P->P2, N, A+3*N, 4*N);
+    ft_execute_sphv2fourier_lda(P, A, N, M, N);
+}
+
+void ft_execute_fourier2sphv_lda(const ft_harmonic_plan * P, double * A, const int N, const int M, const int LDA) {
+    ft_thread_state s = push_num_threads(P->nthreads);
+    connection_mod4 C = {{P->P2inv, P->P1inv, P->P1inv, P->P2inv}, {NULL, NULL, NULL, NULL}, P->RP->ns, 0};
+    if (P->P1inv == NULL)
+        C = (connection_mod4) {{P->P2, P->P1, P->P1, P->P2}, {P->F2, P->F1, P->F1, P->F2}, P->RP->ns, 1};
+    execute_sphv_lo2hi_AVX512(P->RP, A, harmonic_workspace(P->B), M, LDA, &C);
+    pop_num_threads(s);
 }
 
 void ft_execute_fourier2sphv(const ft_harmonic_plan * P, double * A, const int N, const int M) {
-    cblas_dtrmm(CblasColMajor, CblasLeft, CblasUpper, CblasNoTrans, CblasNonUnit, N, (M+3)/4, 1.0, P->P2inv, N, A, 4*N);
-    cblas_dtrmm(CblasColMajor, CblasLeft, CblasUpper, CblasNoTrans, CblasNonUnit, N, (M+2)/4, 1.0, P->P1inv, N, A+N, 4*N);
-    cblas_dtrmm(CblasColMajor, CblasLeft, CblasUpper, CblasNoTrans, CblasNonUnit, N, (M+1)/4, 1.0, P->P1inv, N, A+2*N, 4*N);
-    cblas_dtrmm(CblasColMajor, CblasLeft, CblasUpper, CblasNoTrans, CblasNonUnit, N, M/4, 1.0, P->P2inv, N, A+3*N, 4*N);
-    ft_execute_sphv_lo2hi_AVX512(P->RP, A, P->B, M);
+    ft_execute_fourier2sphv_lda(P, A, N, M, N);
 }
 
-ft_harmonic_plan * ft_plan_tri2cheb(const int n, const double alpha, const double beta, const double gamma) {
-    ft_harmonic_plan * P = malloc(sizeof(ft_harmonic_plan));
-    P->RP = ft_plan_rottriangle(n, alpha, beta, gamma);
-    P->B = VMALLOC(VALIGN(n) * n * sizeof(double));
-    P->P1 = plan_jacobi_to_jacobi(1, 1, n, beta + gamma + 1.0, alpha, -0.5, -0.5);
-    P->P2 = plan_jacobi_to_jacobi(1, 1, n, gamma, beta, -0.5, -0.5);
-    P->P1inv = plan_jacobi_to_jacobi(1, 1, n, -0.5, -0.5, beta + gamma + 1.0, alpha);
-    P->P2inv = plan_jacobi_to_jacobi(1, 1, n, -0.5, -0.5, gamma, beta);
+ft_harmonic_plan * ft_plan_tri2cheb(const int n, const double alpha, const double beta, const double gamma) {return ft_plan_tri2cheb_with_flags(n, alpha, beta, gamma, 0);}
+
+ft_harmonic_plan * ft_plan_tri2cheb_with_flags(const int n, const double alpha, const double beta, const double gamma, const int flags) {
+    ft_cache_key K[5];
+    tri2cheb_components(K, n, alpha, beta, gamma);
+    ft_harmonic_plan * P = plan_harmonic(K, (size_t) VALIGN(n) * n, flags);
     P->alpha = alpha;
     P->beta = beta;
     P->gamma = gamma;
     return P;
 }
 
+void ft_extend_tri2cheb(ft_harmonic_plan * P, const int n) {
+    ft_cache_key K[5];
+    tri2cheb_components(K, n, P->alpha, P->beta, P->gamma);
+    extend_harmonic(P, K, (size_t) VALIGN(n) * n);
+}
+
+void ft_execute_tri2cheb_lda(const ft_harmonic_plan * P, double * A, const int N, const int M, const int LDA) {
+    ft_thread_state s = push_num_threads(P->nthreads);
+    int t1 = (P->beta + P->gamma != -1.5) || (P->alpha != -0.5);
+    int t2 = (P->gamma != -0.5) || (P->beta != -0.5);
+    execute_tri_hi2lo_AVX512(P->RP, A, harmonic_workspace(P->B), M, LDA);
+    if (t1) {
+        if (P->F1 != NULL)
+            fmm_vectors('N', P->F1, 0, A, M, LDA, 1);
+        else
+            packed_dtrmm(CblasLeft, CblasNoTrans, N, M, P->P1, P->RP->ns, A, LDA);
+    }
+    if (t2) {
+        if (P->F2 != NULL)
+            fmm_vectors('N', P->F2, 0, A, N, 1, LDA);
+        else
+            packed_dtrmm(CblasRight, CblasTrans, N, M, P->P2, P->RP->ns, A, LDA);
+    }
+    chebyshev_normalization(A, N, M, 1, LDA, t1 ? 1.0 : M_SQRT1_2, t2 ? 1.0 : M_SQRT1_2, 1.0, t2 ? 1.0 : M_2_PI);
+    pop_num_threads(s);
+}
+
 void ft_execute_tri2cheb(const ft_harmonic_plan * P, double * A, const int N, const int M) {
-    ft_execute_tri_hi2lo_AVX512(P->RP, A, P->B, M);
-    if ((P->beta + P->gamma != -1.5) || (P->alpha != -0.5))
-        cblas_dtrmm(CblasColMajor, CblasLeft, CblasUpper, CblasNoTrans, CblasNonUnit, N, M, 1.0, P->P1, N, A, N);
-    if ((P->gamma != -0.5) || (P->beta != -0.5))
-        cblas_dtrmm(CblasColMajor, CblasRight, CblasUpper, CblasTrans, CblasNonUnit, N, M, 1.0, P->P2, N, A, N);
-    chebyshev_normalization_2d(A, N, M);
+    ft_execute_tri2cheb_lda(P, A, N, M, N);
+}
+
+void ft_execute_cheb2tri_lda(const ft_harmonic_plan * P, double * A, const int N, const int M, const int LDA) {
+    ft_thread_state s = push_num_threads(P->nthreads);
+    int t1 = (P->alpha != -0.5) || (P->beta + P->gamma != -1.5);
+    int t2 = (P->beta != -0.5) || (P->gamma != -0.5);
+    chebyshev_normalization(A, N, M, 1, LDA, t1 ? 1.0 : M_SQRT2, t2 ? 1.0 : M_SQRT2, 1.0, t2 ? 1.0 : M_PI_2);
+    if (t2) {
+        if (P->F2 != NULL)
+            fmm_vectors('N', P->F2, 1, A, N, 1, LDA);
+        else if (P->P2inv == NULL)
+            packed_dtrsm(CblasRight, CblasTrans, N, M, P->P2, P->RP->ns, A, LDA);
+        else
+            packed_dtrmm(CblasRight, CblasTrans, N, M, P->P2inv, P->RP->ns, A, LDA);
+    }
+    if (t1) {
+        if (P->F1 != NULL)
+            fmm_vectors('N', P->F1, 1, A, M, LDA, 1);
+        else if (P->P1inv == NULL)
+            packed_dtrsm(CblasLeft, CblasNoTrans, N, M, P->P1, P->RP->ns, A, LDA);
+        else
+            packed_dtrmm(CblasLeft, CblasNoTrans, N, M, P->P1inv, P->RP->ns, A, LDA);
+    }
+    execute_tri_lo2hi_AVX512(P->RP, A, harmonic_workspace(P->B), M, LDA);
+    pop_num_threads(s);
 }
 
 void ft_execute_cheb2tri(const ft_harmonic_plan * P, double * A, const int N, const int M) {
-    chebyshev_normalization_2d_t(A, N, M);
-    if ((P->beta != -0.5) || (P->gamma != -0.5))
-        cblas_dtrmm(CblasColMajor, CblasRight, CblasUpper, CblasTrans, CblasNonUnit, N, M, 1.0, P->P2inv, N, A, N);
-    if ((P->alpha != -0.5) || (P->beta + P->gamma != -1.5))
-        cblas_dtrmm(CblasColMajor, CblasLeft, CblasUpper, CblasNoTrans, CblasNonUnit, N, M, 1.0, P->P1inv, N, A, N);
-    ft_execute_tri_lo2hi_AVX512(P->RP, A, P->B, M);
+    ft_execute_cheb2tri_lda(P, A, N, M, N);
 }
 
-ft_harmonic_plan * ft_plan_disk2cxf(const int n) {
-    ft_harmonic_plan * P = malloc(sizeof(ft_harmonic_plan));
-    P->RP = ft_plan_rotdisk(n);
-    P->B = VMALLOC(VALIGN(n) * (4*n-3) * sizeof(double));
-    P->P1 = plan_legendre_to_chebyshev(1, 0, n);
-    P->P2 = plan_jacobi_to_jacobi(1, 1, n, 0.0, 1.0, -0.5, 0.5);
-    P->P1inv = plan_chebyshev_to_legendre(0, 1, n);
-    P->P2inv = plan_jacobi_to_jacobi(1, 1, n, -0.5, 0.5, 0.0, 1.0);
-    for (int j = 0; j < n; j++)
-        for (int i = 0; i <= j; i++) {
-            P->P1[i+j*n] *= 2.0;
-            P->P2[i+j*n] *= 2.0;
-            P->P1inv[i+j*n] *= 0.5;
-            P->P2inv[i+j*n] *= 0.5;
-        }
-    return P;
+ft_harmonic_plan * ft_plan_disk2cxf(const int n) {return ft_plan_disk2cxf_with_flags(n, 0);}
+
+ft_harmonic_plan * ft_plan_disk2cxf_with_flags(const int n, const int flags) {
+    ft_cache_key K[5];
+    disk2cxf_components(K, n);
+    return plan_harmonic(K, (size_t) VALIGN(n) * (4*n-3), flags);
+}
+
+void ft_extend_disk2cxf(ft_harmonic_plan * P, const int n) {
+    ft_cache_key K[5];
+    disk2cxf_components(K, n);
+    extend_harmonic(P, K, (size_t) VALIGN(n) * (4*n-3));
+}
+
+void ft_execute_disk2cxf_lda(const ft_harmonic_plan * P, double * A, const int N, const int M, const int LDA) {
+    ft_thread_state s = push_num_threads(P->nthreads);
+    connection_mod4 C = {{P->P1, P->P2, P->P2, P->P1}, {P->F1, P->F2, P->F2, P->F1}, P->RP->ns, 0};
+    execute_disk_hi2lo_AVX512(P->RP, A, harmonic_workspace(P->B), M, LDA, &C);
+    pop_num_threads(s);
 }
 
 void ft_execute_disk2cxf(const ft_harmonic_plan * P, double * A, const int N, const int M) {
-    ft_execute_disk_hi2lo_AVX512(P->RP, A, P->B, M);
-    cblas_dtrmm(CblasColMajor, CblasLeft, CblasUpper, CblasNoTrans, CblasNonUnit, N, (M+3)/4, 1.0, P->P1, N, A, 4*N);
-    cblas_dtrmm(CblasColMajor, CblasLeft, CblasUpper, CblasNoTrans, CblasNonUnit, N, (M+2)/4, 1.0, P->P2, N, A+N, 4*N);
-    cblas_dtrmm(CblasColMajor, CblasLeft, CblasUpper, CblasNoTrans, CblasNonUnit, N, (M+1)/4, 1.0, P->P2, N, A+2*N, 4*N);
-    cblas_dtrmm(CblasColMajor, CblasLeft, CblasUpper, CblasNoTrans, CblasNonUnit, N, M/4, 1.0, P->P1, N, A+3*N, 4*N);
-    partial_chebyshev_normalization(A, N, M);
+    ft_execute_disk2cxf_lda(P, A, N, M, N);
+}
+
+void ft_execute_cxf2disk_lda(const ft_harmonic_plan * P, double * A, const int N, const int M, const int LDA) {
+    ft_thread_state s = push_num_threads(P->nthreads);
+    connection_mod4 C = {{P->P1inv, P->P2inv, P->P2inv, P->P1inv}, {NULL, NULL, NULL, NULL}, P->RP->ns, 0};
+    if (P->P1inv == NULL)
+        C = (connection_mod4) {{P->P1, P->P2, P->P2, P->P1}, {P->F1, P->F2, P->F2, P->F1}, P->RP->ns, 1};
+    execute_disk_lo2hi_AVX512(P->RP, A, harmonic_workspace(P->B), M, LDA, &C);
+    pop_num_threads(s);
 }
 
 void ft_execute_cxf2disk(const ft_harmonic_plan * P, double * A, const int N, const int M) {
-    partial_chebyshev_normalization_t(A, N, M);
-    cblas_dtrmm(CblasColMajor, CblasLeft, CblasUpper, CblasNoTrans, CblasNonUnit, N, (M+3)/4, 1.0, P->P1inv, N, A, 4*N);
-    cblas_dtrmm(CblasColMajor, CblasLeft, CblasUpper, CblasNoTrans, CblasNonUnit, N, (M+2)/4, 1.0, P->P2inv, N, A+N, 4*N);
-    cblas_dtrmm(CblasColMajor, CblasLeft, CblasUpper, CblasNoTrans, CblasNonUnit, N, (M+1)/4, 1.0, P->P2inv, N, A+2*N, 4*N);
-    cblas_dtrmm(CblasColMajor, CblasLeft, CblasUpper, CblasNoTrans, CblasNonUnit, N, M/4, 1.0, P->P1inv, N, A+3*N, 4*N);
-    ft_execute_disk_lo2hi_AVX512(P->RP, A, P->B, M);
+    ft_execute_cxf2disk_lda(P, A, N, M, N);
 }
 
 void ft_destroy_tetrahedral_harmonic_plan(ft_tetrahedral_harmonic_plan * P) {
-    ft_destroy_rotation_plan(P->RP1);
-    ft_destroy_rotation_plan(P->RP2);
+    release_rotation(P->RP1);
+    release_rotation(P->RP2);
     VFREE(P->B);
-    free(P->P1);
-    free(P->P2);
-    free(P->P3);
-    free(P->P1inv);
-    free(P->P2inv);
-    free(P->P3inv);
+    release_connection(P->P1);
+    release_connection(P->P2);
+    release_connection(P->P3);
+    release_connection(P->P1inv);
+    release_connection(P->P2inv);
+    release_connection(P->P3inv);
+    destroy_fmm(P->F1);
+    destroy_fmm(P->F2);
+    destroy_fmm(P->F3);
     free(P);
 }
 
-ft_tetrahedral_harmonic_plan * ft_plan_tet2cheb(const int n, const double alpha, const double beta, const double gamma, const double delta) {
+void ft_set_tetrahedral_harmonic_plan_num_threads(ft_tetrahedral_harmonic_plan * P, const int n) {P->nthreads = n;}
+
+void ft_set_tetrahedral_harmonic_plan_streaming(ft_tetrahedral_harmonic_plan * P, const int streaming) {
+    if (streaming && P->B != NULL) {
+        VFREE(P->B);
+        P->B = NULL;
+    }
+    else if (!streaming && P->B == NULL)
+        P->B = VMALLOC(P->lwork * sizeof(double));
+}
+
+ft_tetrahedral_harmonic_plan * ft_view_tetrahedral_harmonic_plan(const ft_tetrahedral_harmonic_plan * P, const int n) {
+    if (P->F1 != NULL) {
+        printf(RED("FastTransforms: a tetrahedral harmonic plan with FMM connections cannot be viewed at a smaller degree.")"\n");
+        exit(EXIT_FAILURE);
+    }
+    ft_tetrahedral_harmonic_plan * V = malloc(sizeof(ft_tetrahedral_harmonic_plan));
+    *V = *P;
+    V->RP1 = ft_view_rotation_plan(P->RP1, n);
+    V->RP2 = ft_view_rotation_plan(P->RP2, n);
+    V->lwork = (size_t) VALIGN(n) * n * n;
+    V->B = P->B == NULL ? NULL : VMALLOC(V->lwork * sizeof(double));
+    return V;
+}
+
+void ft_destroy_tetrahedral_harmonic_plan_view(ft_tetrahedral_harmonic_plan * V) {
+    ft_destroy_rotation_plan_view(V->RP1);
+    ft_destroy_rotation_plan_view(V->RP2);
+    VFREE(V->B);
+    free(V);
+}
+
+ft_tetrahedral_harmonic_plan * ft_plan_tet2cheb(const int n, const double alpha, const double beta, const double gamma, const double delta) {return ft_plan_tet2cheb_with_flags(n, alpha, beta, gamma, delta, 0);}
+
+ft_tetrahedral_harmonic_plan * ft_plan_tet2cheb_with_flags(const int n, const double alpha, const double beta, const double gamma, const double delta, const int flags) {
     ft_tetrahedral_harmonic_plan * P = malloc(sizeof(ft_tetrahedral_harmonic_plan));
-    P->RP1 = ft_plan_rottriangle(n, alpha, beta, gamma + delta + 1.0);
-    P->RP2 = ft_plan_rottriangle(n, beta, gamma, delta);
-    P->B = VMALLOC(VALIGN(n) * n * n * sizeof(double));
-    P->P1 = plan_jacobi_to_jacobi(1, 1, n, beta + gamma + delta + 2.0, alpha, -0.5, -0.5);
-    P->P2 = plan_jacobi_to_jacobi(1, 1, n, gamma + delta + 1.0, beta, -0.5, -0.5);
-    P->P3 = plan_jacobi_to_jacobi(1, 1, n, delta, gamma, -0.5, -0.5);
-    P->P1inv = plan_jacobi_to_jacobi(1, 1, n, -0.5, -0.5, beta + gamma + delta + 2.0, alpha);
-    P->P2inv = plan_jacobi_to_jacobi(1, 1, n, -0.5, -0.5, gamma + delta + 1.0, beta);
-    P->P3inv = plan_jacobi_to_jacobi(1, 1, n, -0.5, -0.5, delta, gamma);
+    ft_cache_key K[8];
+    tet2cheb_components(K, n, alpha, beta, gamma, delta);
+    P->lwork = (size_t) VALIGN(n) * n * n;
+    P->B = flags & FT_HARMONIC_STREAMING ? NULL : VMALLOC(P->lwork * sizeof(double));
+    P->P1 = P->P2 = P->P3 = P->P1inv = P->P2inv = P->P3inv = NULL;
+    P->F1 = P->F2 = P->F3 = NULL;
+    if (use_fmm(n, flags)) {
+        P->RP1 = acquire_rotation(K);
+        P->RP2 = acquire_rotation(K+1);
+        P->F1 = build_fmm(K+2);
+        P->F2 = build_fmm(K+3);
+        P->F3 = build_fmm(K+4);
+    }
+    else {
+        #pragma omp parallel
+        #pragma omp single
+        {
+            #pragma omp task
+            P->RP1 = acquire_rotation(K);
+            #pragma omp task
+            P->RP2 = acquire_rotation(K+1);
+            #pragma omp task
+            P->P1 = acquire_connection(K+2);
+            #pragma omp task
+            P->P2 = acquire_connection(K+3);
+            #pragma omp task
+            P->P3 = acquire_connection(K+4);
+            if (!(flags & FT_HARMONIC_SOLVE)) {
+                #pragma omp task
+                P->P1inv = acquire_connection(K+5);
+                #pragma omp task
+                P->P2inv = acquire_connection(K+6);
+                #pragma omp task
+                P->P3inv = acquire_connection(K+7);
+            }
+        }
+    }
     P->alpha = alpha;
     P->beta = beta;
     P->gamma = gamma;
     P->delta = delta;
+    P->nthreads = 0;
     return P;
 }
 
+void ft_extend_tet2cheb(ft_tetrahedral_harmonic_plan * P, const int n) {
+    int n0 = P->RP1->ns;
+    if (n <= P->RP1->n)
+        return;
+    if (P->RP1->n != n0) {
+        printf(RED("FastTransforms: a view of a tetrahedral harmonic plan cannot be extended.")"\n");
+        exit(EXIT_FAILURE);
+    }
+    ft_cache_key K[8];
+    tet2cheb_components(K, n, P->alpha, P->beta, P->gamma, P->delta);
+    #pragma omp parallel
+    #pragma omp single
+    {
+        #pragma omp task
+        P->RP1 = extend_rotation(K, P->RP1, NULL);
+        #pragma omp task
+        P->RP2 = extend_rotation(K+1, P->RP2, NULL);
+        #pragma omp task
+        P->P1 = extend_connection(K+2, P->P1, n0, NULL);
+        #pragma omp task
+        P->P2 = extend_connection(K+3, P->P2, n0, NULL);
+        #pragma omp task
+        P->P3 = extend_connection(K+4, P->P3, n0, NULL);
+        #pragma omp task
+        P->P1inv = extend_connection(K+5, P->P1inv, n0, NULL);
+        #pragma omp task
+        P->P2inv = extend_connection(K+6, P->P2inv, n0, NULL);
+        #pragma omp task
+        P->P3inv = extend_connection(K+7, P->P3inv, n0, NULL);
+    }
+    if (P->F1 != NULL) {
+        destroy_fmm(P->F1);
+        destroy_fmm(P->F2);
+        destroy_fmm(P->F3);
+        P->F1 = build_fmm(K+2);
+        P->F2 = build_fmm(K+3);
+        P->F3 = build_fmm(K+4);
+    }
+    P->lwork = (size_t) VALIGN(n) * n * n;
+    if (P->B != NULL) {
+        VFREE(P->B);
+        P->B = VMALLOC(P->lwork * sizeof(double));
+    }
+}
+
+void ft_execute_tet2cheb_lda(const ft_tetrahedral_harmonic_plan * P, double * A, const int N, const int L, const int M, const int LDA) {
+    ft_thread_state s = push_num_threads(P->nthreads);
+    int t1 = (P->beta + P->gamma + P->delta != -2.5) || (P->alpha != -0.5);
+    int t2 = (P->gamma + P->delta != -1.5) || (P->beta != -0.5);
+    int t3 = (P->delta != -0.5) || (P->gamma != -0.5);
+    execute_tet_hi2lo_AVX512(P->RP1, P->RP2, A, harmonic_workspace(P->B), L, M, LDA);
+    if (t1) {
+        if (P->F1 != NULL)
+            fmm_vectors('N', P->F1, 0, A, L*M, LDA, 1);
+        else
+            for (int m = 0; m < M; m++)
+                packed_dtrmm(CblasLeft, CblasNoTrans, N, L, P->P1, P->RP1->ns, A+LDA*L*m, LDA);
+    }
+    if (t2)
+        for (int m = 0; m < M; m++) {
+            if (P->F2 != NULL)
+                fmm_vectors('N', P->F2, 0, A+LDA*L*m, N, 1, LDA);
+            else
+                packed_dtrmm(CblasRight, CblasTrans, N, L, P->P2, P->RP1->ns, A+LDA*L*m, LDA);
+        }
+    if (t3)
+        for (int l = 0; l < L; l++) {
+            if (P->F3 != NULL)
+                fmm_vectors('T', P->F3, 0, A+LDA*l, N, 1, LDA*L);
+            else
+                packed_dtrmm(CblasRight, CblasNoTrans, N, N, P->P3, P->RP1->ns, A+LDA*l, LDA*L);
+        }
+    chebyshev_normalization(A, N, L, M, LDA, t1 ? 1.0 : M_SQRT1_2, t2 ? 1.0 : M_SQRT1_2, t3 ? 1.0 : M_SQRT1_2, t3 ? 1.0 : M_2_PI_POW_1P5);
+    pop_num_threads(s);
+}
+
 void ft_execute_tet2cheb(const ft_tetrahedral_harmonic_plan * P, double * A, const int N, const int L, const int M) {
-    ft_execute_tet_hi2lo_AVX512(P->RP1, P->RP2, A, P->B, L, M);
-    if ((P->beta + P->gamma + P->delta != -2.5) || (P->alpha != -0.5))
-        for (int m = 0; m < M; m++)
-            cblas_dtrmm(CblasColMajor, CblasLeft, CblasUpper, CblasNoTrans, CblasNonUnit, N, L, 1.0, P->P1, N, A+N*L*m, N);
-    if ((P->gamma + P->delta != -1.5) || (P->beta != -0.5))
-        for (int m = 0; m < M; m++)
-            cblas_dtrmm(CblasColMajor, CblasRight, CblasUpper, CblasTrans, CblasNonUnit, N, L, 1.0, P->P2, N, A+N*L*m, N);
-    if ((P->delta != -0.5) || (P->gamma != -0.5))
-        for (int n = 0; n < N; n++)
-            for (int l = 0; l < L; l++)
-                cblas_dtrmv(CblasColMajor, CblasUpper, CblasTrans, CblasNonUnit, N, P->P3, N, A+n+N*l, N*L);
-    chebyshev_normalization_3d(A, N, L, M);
+    ft_execute_tet2cheb_lda(P, A, N, L, M, N);
+}
+
+void ft_execute_cheb2tet_lda(const ft_tetrahedral_harmonic_plan * P, double * A, const int N, const int L, const int M, const int LDA) {
+    ft_thread_state s = push_num_threads(P->nthreads);
+    int t1 = (P->alpha != -0.5) || (P->beta + P->gamma + P->delta != -2.5);
+    int t2 = (P->beta != -0.5) || (P->gamma + P->delta != -1.5);
+    int t3 = (P->gamma != -0.5) || (P->delta != -0.5);
+    chebyshev_normalization(A, N, L, M, LDA, t1 ? 1.0 : M_SQRT2, t2 ? 1.0 : M_SQRT2, t3 ? 1.0 : M_SQRT2, t3 ? 1.0 : M_PI_2_POW_1P5);
+    if (t3)
+        for (int l = 0; l < L; l++) {
+            if (P->F3 != NULL)
+                fmm_vectors('T', P->F3, 1, A+LDA*l, N, 1, LDA*L);
+            else if (P->P3inv == NULL)
+                packed_dtrsm(CblasRight, CblasNoTrans, N, N, P->P3, P->RP1->ns, A+LDA*l, LDA*L);
+            else
+                packed_dtrmm(CblasRight, CblasNoTrans, N, N, P->P3inv, P->RP1->ns, A+LDA*l, LDA*L);
+        }
+    if (t2)
+        for (int m = 0; m < M; m++) {
+            if (P->F2 != NULL)
+                fmm_vectors('N', P->F2, 1, A+LDA*L*m, N, 1, LDA);
+            else if (P->P2inv == NULL)
+                packed_dtrsm(CblasRight, CblasTrans, N, L, P->P2, P->RP1->ns, A+LDA*L*m, LDA);
+            else
+                packed_dtrmm(CblasRight, CblasTrans, N, L, P->P2inv, P->RP1->ns, A+LDA*L*m, LDA);
+        }
+    if (t1) {
+        if (P->F1 != NULL)
+            fmm_vectors('N', P->F1, 1, A, L*M, LDA, 1);
+        else
+            for (int m = 0; m < M; m++) {
+                if (P->P1inv == NULL)
+                    packed_dtrsm(CblasLeft, CblasNoTrans, N, L, P->P1, P->RP1->ns, A+LDA*L*m, LDA);
+                else
+                    packed_dtrmm(CblasLeft, CblasNoTrans, N, L, P->P1inv, P->RP1->ns, A+LDA*L*m, LDA);
+            }
+    }
+    execute_tet_lo2hi_AVX512(P->RP1, P->RP2, A, harmonic_workspace(P->B), L, M, LDA);
+    pop_num_threads(s);
 }
 
 void ft_execute_cheb2tet(const ft_tetrahedral_harmonic_plan * P, double * A, const int N, const int L, const int M) {
-    chebyshev_normalization_3d_t(A, N, L, M);
-    if ((P->gamma != -0.5) || (P->delta != -0.5))
-        for (int n = 0; n < N; n++)
-            for (int l = 0; l < L; l++)
-                cblas_dtrmv(CblasColMajor, CblasUpper, CblasTrans, CblasNonUnit, N, P->P3inv, N, A+n+N*l, N*L);
-    if ((P->beta != -0.5) || (P->gamma + P->delta != -1.5))
-        for (int m = 0; m < M; m++)
-            cblas_dtrmm(CblasColMajor, CblasRight, CblasUpper, CblasTrans, CblasNonUnit, N, L, 1.0, P->P2inv, N, A+N*L*m, N);
-    if ((P->alpha != -0.5) || (P->beta + P->gamma + P->delta != -2.5))
-        for (int m = 0; m < M; m++)
-            cblas_dtrmm(CblasColMajor, CblasLeft, CblasUpper, CblasNoTrans, CblasNonUnit, N, L, 1.0, P->P1inv, N, A+N*L*m, N);
-    ft_execute_tet_lo2hi_AVX512(P->RP1, P->RP2, A, P->B, L, M);
+    ft_execute_cheb2tet_lda(P, A, N, L, M, N);
 }
@@ -1,96 +1,55 @@
-X(tdc_eigen) * X(drop_precision_tdc_eigen)(X2(tdc_eigen) * F2) {
-    int n = F2->n;
-    X(tdc_eigen) * F = malloc(sizeof(X(tdc_eigen)));
-    if (n < TDC_EIGEN_BLOCKSIZE) {
-        FLT * V = malloc(n*n*sizeof(FLT));
-        for (int i = 0; i < n*n; i++)
-            V[i] = F2->V[i];
-        FLT * lambda = malloc(n*sizeof(FLT));
-        for (int i = 0; i < n; i++)
-            lambda[i] = F2->lambda[i];
-        F->V = V;
-        F->lambda = lambda;
-        F->n = n;
-    }
-    else {
-        F->F0 = X(drop_precision_symmetric_dpr1_eigen)(F2->F0);
-        F->F1 = X(drop_precision_tdc_eigen)(F2->F1);
-        F->F2 = X(drop_precision_tdc_eigen)(F2->F2);
-        F->z = calloc(n, sizeof(FLT));
-        F->n = n;
-    }
-    return F;
+// The conversions below destroy each part of F2 as soon as it is converted if destroy is set,
+// so that the peak memory is about that of F2 rather than the sum of both factorizations.
+
+// Returns a copy of x in the lower precision, and frees x if destroy is set.
+static FLT * X(drop_precision_array)(FLT2 * x, const size_t n, const int destroy) {
+    FLT * y = malloc(n*sizeof(FLT));
+    for (size_t i = 0; i < n; i++)
+        y[i] = x[i];
+    if (destroy)
+        free(x);
+    return y;
 }
 
-X(tdc_eigen_FMM) * X(drop_precision_tdc_eigen_FMM)(X2(tdc_eigen_FMM) * F2) {
-    int n = F2->n;
-    X(tdc_eigen_FMM) * F = malloc(sizeof(X(tdc_eigen_FMM)));
-    if (n < TDC_EIGEN_BLOCKSIZE) {
-        FLT * V = malloc(n*n*sizeof(FLT));
-        for (int i = 0; i < n*n; i++)
-            V[i] = F2->V[i];
-        FLT * lambda = malloc(n*sizeof(FLT));
-        for (int i = 0; i < n; i++)
-            lambda[i] = F2->lambda[i];
-        F->V = V;
-        F->lambda = lambda;
-        F->n = n;
-    }
-    else {
-        F->F0 = X(drop_precision_symmetric_dpr1_eigen_FMM)(F2->F0);
-        F->F1 = X(drop_precision_tdc_eigen_FMM)(F2->F1);
-        F->F2 = X(drop_precision_tdc_eigen_FMM)(F2->F2);
-        F->z = calloc(n, sizeof(FLT));
-        F->n = n;
-    }
-    return F;
+// Returns a copy of the integer array p, and frees p if destroy is set.
+static int * X(copy_index_array)(int * p, const int n, const int destroy) {
+    int * q = malloc(n*sizeof(int));
+    for (int i = 0; i < n; i++)
+        q[i] = p[i];
+    if (destroy)
+        free(p);
+    return q;
 }
 
-X(symmetric_dpr1_eigen) * X(drop_precision_symmetric_dpr1_eigen)(X2(symmetric_dpr1_eigen) * F2) {
+static X(symmetric_dpr1_eigen) * X(drop_precision_symmetric_dpr1_eigen_destroy)(X2(symmetric_dpr1_eigen) * F2, const int destroy) {
     int n = F2->n, iz = F2->iz, id = F2->id;
-    int * p = malloc(n*sizeof(int)), * q = malloc(n*sizeof(int));
-    FLT * lambda = malloc(n*sizeof(FLT)), * lambdalo = malloc(n*sizeof(FLT)), * lambdahi = malloc(n*sizeof(FLT));
-    for (int i = 0; i < n; i++) {
-        p[i] = F2->p[i];
-        q[i] = F2->q[i];
-        lambda[i] = F2->lambda[i];
-        lambdalo[i] = F2->lambdalo[i];
-        lambdahi[i] = F2->lambdahi[i];
-    }
-    FLT * v = malloc(id*sizeof(FLT));
-    for (int i = 0; i < id; i++)
-        v[i] = F2->v[i];
-    FLT * V = malloc((n-iz)*(n-iz-id)*sizeof(FLT));
-    for (int i = 0; i < (n-iz)*(n-iz-id); i++)
-        V[i] = F2->V[i];
     X(symmetric_dpr1_eigen) * F = malloc(sizeof(X(symmetric_dpr1_eigen)));
-    F->v = v;
-    F->V = V;
-    F->lambda = lambda;
-    F->lambdalo = lambdalo;
-    F->lambdahi = lambdahi;
-    F->p = p;
-    F->q = q;
+    F->p = X(copy_index_array)(F2->p, n, destroy);
+    F->q = X(copy_index_array)(F2->q, n, destroy);
+    F->lambda = X(drop_precision_array)(F2->lambda, n, destroy);
+    F->lambdalo = X(drop_precision_array)(F2->lambdalo, n, destroy);
+    F->lambdahi = X(drop_precision_array)(F2->lambdahi, n, destroy);
+    F->v = X(drop_precision_array)(F2->v, id, destroy);
+    F->V = X(drop_precision_array)(F2->V, (size_t) (n-iz)*(n-iz-id), destroy);
     F->n = n;
     F->iz = iz;
     F->id = id;
+    if (destroy)
+        free(F2);
     return F;
 }
 
-X(symmetric_dpr1_eigen_FMM) * X(drop_precision_symmetric_dpr1_eigen_FMM)(X2(symmetric_dpr1_eigen_FMM) * F2) {
+X(symmetric_dpr1_eigen) * X(drop_precision_symmetric_dpr1_eigen)(X2(symmetric_dpr1_eigen) * F2) {return X(drop_precision_symmetric_dpr1_eigen_destroy)(F2, 0);}
+X(symmetric_dpr1_eigen) * X(drop_precision_destroy_symmetric_dpr1_eigen)(X2(symmetric_dpr1_eigen) * F2) {return X(drop_precision_symmetric_dpr1_eigen_destroy)(F2, 1);}
+
+// The eigenvectors are resampled from the converted eigenvalues, so those of F2 go first.
+static X(symmetric_dpr1_eigen_FMM) * X(drop_precision_symmetric_dpr1_eigen_FMM_destroy)(X2(symmetric_dpr1_eigen_FMM) * F2, const int destroy) {
     int n = F2->n, iz = F2->iz, id = F2->id;
-    int * p = malloc(n*sizeof(int)), * q = malloc(n*sizeof(int));
-    FLT * lambda = malloc(n*sizeof(FLT)), * lambdalo = malloc(n*sizeof(FLT)), * lambdahi = malloc(n*sizeof(FLT));
-    for (int i = 0; i < n; i++) {
-        p[i] = F2->p[i];
-        q[i] = F2->q[i];
-        lambda[i] = F2->lambda[i];
-        lambdalo[i] = F2->lambdalo[i];
-        lambdahi[i] = F2->lambdahi[i];
-    }
-    FLT * v = malloc(id*sizeof(FLT));
-    for (int i = 0; i < id; i++)
-        v[i] = F2->v[i];
+    int * p = X(copy_index_array)(F2->p, n, destroy), * q = X(copy_index_array)(F2->q, n, destroy);
+    FLT * lambda = X(drop_precision_array)(F2->lambda, n, destroy);
+    FLT * lambdalo = X(drop_precision_array)(F2->lambdalo, n, destroy);
+    FLT * lambdahi = X(drop_precision_array)(F2->lambdahi, n, destroy);
+    FLT * v = X(drop_precision_array)(F2->v, id, destroy);
 
     X(symmetric_dpr1) * A = malloc(sizeof(X(symmetric_dpr1)));
     X(symmetric_idpr1) * B = malloc(sizeof(X(symmetric_idpr1)));
@@ -104,6 +63,12 @@ X(symmetric_dpr1_eigen_FMM) * X(drop_precision_symmetric_dpr1_eigen_FMM)(X2(symm
     }
     A->rho = F2->A->rho;
     B->sigma = F2->B->sigma;
+    if (destroy) {
+        X2(destroy_symmetric_dpr1)(F2->A);
+        X2(destroy_symmetric_idpr1)(F2->B);
+        X2(destroy_hierarchicalmatrix)(F2->V);
+        free(F2);
+    }
 
     X(perm)('T', lambda, q, n);
     X(perm)('T', lambdalo, q, n);
@@ -129,39 +94,132 @@ X(symmetric_dpr1_eigen_FMM) * X(drop_precision_symmetric_dpr1_eigen_FMM)(X2(symm
     return F;
 }
 
-X(tb_eigen_FMM) * X(drop_precision_tb_eigen_FMM)(X2(tb_eigen_FMM) * F2) {
+X(symmetric_dpr1_eigen_FMM) * X(drop_precision_symmetric_dpr1_eigen_FMM)(X2(symmetric_dpr1_eigen_FMM) * F2) {return X(drop_precision_symmetric_dpr1_eigen_FMM_destroy)(F2, 0);}
+X(symmetric_dpr1_eigen_FMM) * X(drop_precision_destroy_symmetric_dpr1_eigen_FMM)(X2(symmetric_dpr1_eigen_FMM) * F2) {return X(drop_precision_symmetric_dpr1_eigen_FMM_destroy)(F2, 1);}
+
+static X(tdc_eigen) * X(drop_precision_tdc_eigen_destroy)(X2(tdc_eigen) * F2, const int destroy) {
     int n = F2->n;
-    X(tb_eigen_FMM) * F = malloc(sizeof(X(tb_eigen_FMM)));
+    X(tdc_eigen) * F = malloc(sizeof(X(tdc_eigen)));
+    if (n < TDC_EIGEN_BLOCKSIZE) {
+        F->V = X(drop_precision_array)(F2->V, n*n, destroy);
+        F->lambda = X(drop_precision_array)(F2->lambda, n, destroy);
+        F->n = n;
+    }
+    else {
+        F->F0 = X(drop_precision_symmetric_dpr1_eigen_destroy)(F2->F0, destroy);
+        F->F1 = X(drop_precision_tdc_eigen_destroy)(F2->F1, destroy);
+        F->F2 = X(drop_precision_tdc_eigen_destroy)(F2->F2, destroy);
+        F->z = calloc(n, sizeof(FLT));
+        F->n = n;
+        if (destroy)
+            free(F2->z);
+    }
+    if (destroy)
+        free(F2);
+    return F;
+}
+
+X(tdc_eigen) * X(drop_precision_tdc_eigen)(X2(tdc_eigen) * F2) {return X(drop_precision_tdc_eigen_destroy)(F2, 0);}
+X(tdc_eigen) * X(drop_precision_destroy_tdc_eigen)(X2(tdc_eigen) * F2) {return X(drop_precision_tdc_eigen_destroy)(F2, 1);}
+
+static X(tdc_eigen_FMM) * X(drop_precision_tdc_eigen_FMM_destroy)(X2(tdc_eigen_FMM) * F2, const int destroy) {
+    int n = F2->n;
+    X(tdc_eigen_FMM) * F = malloc(sizeof(X(tdc_eigen_FMM)));
+    if (n < TDC_EIGEN_BLOCKSIZE) {
+        F->V = X(drop_precision_array)(F2->V, n*n, destroy);
+        F->lambda = X(drop_precision_array)(F2->lambda, n, destroy);
+        F->n = n;
+    }
+    else {
+        F->F0 = X(drop_precision_symmetric_dpr1_eigen_FMM_destroy)(F2->F0, destroy);
+        F->F1 = X(drop_precision_tdc_eigen_FMM_destroy)(F2->F1, destroy);
+        F->F2 = X(drop_precision_tdc_eigen_FMM_destroy)(F2->F2, destroy);
+        F->z = calloc(n, sizeof(FLT));
+        F->n = n;
+        if (destroy)
+            free(F2->z);
+    }
+    if (destroy)
+        free(F2);
+    return F;
+}
+
+X(tdc_eigen_FMM) * X(drop_precision_tdc_eigen_FMM)(X2(tdc_eigen_FMM) * F2) {return X(drop_precision_tdc_eigen_FMM_destroy)(F2, 0);}
+X(tdc_eigen_FMM) * X(drop_precision_destroy_tdc_eigen_FMM)(X2(tdc_eigen_FMM) * F2) {return X(drop_precision_tdc_eigen_FMM_destroy)(F2, 1);}
+
+static X(hierarchicalmatrix) * X(drop_precision_lowrank_coupling)(X2(hierarchicalmatrix) * H2, const int destroy) {
+    X2(lowrankmatrix) * L2 = H2->lowrankmatrices[0];
+    int m = L2->m, n = L2->n, r = L2->r;
+    X(lowrankmatrix) * L = X(malloc_lowrankmatrix)('2', m, n, r);
+    for (int i = 0; i < m*r; i++)
+        L->U[i] = L2->U[i];
+    for (int i = 0; i < n*r; i++)
+        L->V[i] = L2->V[i];
+    for (int i = 0; i < r; i++)
+        L->S[i] = L2->S[i];
+    X(hierarchicalmatrix) * H = X(malloc_hierarchicalmatrix)(1, 1);
+    H->lowrankmatrices[0] = L;
+    H->hash[0] = 3;
+    H->m = m;
+    H->n = n;
+    if (destroy)
+        X2(destroy_hierarchicalmatrix)(H2);
+    return H;
+}
+
+// The Cauchy matrices are resampled to the tolerance tol, or to the working precision if it is coarser.
+static X(tb_eigen_FMM) * X(drop_precision_tb_eigen_FMM_destroy)(X2(tb_eigen_FMM) * F2, const FLT tol, const int destroy) {
+    int n = F2->n;
+    X(tb_eigen_FMM) * F;
+    if (F2->T != NULL) {
+        int b = F2->T->b;
+        X(triangular_banded) * T = malloc(sizeof(X(triangular_banded)));
+        T->data = X(drop_precision_array)(F2->T->data, (size_t) n*(b+1), destroy);
+        T->n = n;
+        T->b = b;
+        if (destroy) {
+            free(F2->T);
+            free(F2);
+        }
+        return X(tb_banded_FMM)(T);
+    }
+    F = calloc(1, sizeof(X(tb_eigen_FMM)));
     if (n < TB_EIGEN_BLOCKSIZE) {
-        FLT * V = malloc(n*n*sizeof(FLT));
-        for (int i = 0; i < n*n; i++)
-            V[i] = F2->V[i];
-        FLT * lambda = malloc(n*sizeof(FLT));
-        for (int i = 0; i < n; i++)
-            lambda[i] = F2->lambda[i];
-        F->V = V;
-        F->lambda = lambda;
+        F->V = X(drop_precision_array)(F2->V, (size_t) n*n, destroy);
+        F->lambda = X(drop_precision_array)(F2->lambda, n, destroy);
         F->n = n;
     }
     else {
         int s = n>>1, b = F2->b;
-        FLT * lambda = malloc(n*sizeof(FLT));
-        for (int i = 0; i < n; i++)
-            lambda[i] = F2->lambda[i];
-        F->F0 = X(sample_hierarchicalmatrix)(X(cauchykernel), lambda, lambda+s, (unitrange) {0, s}, (unitrange) {0, n-s}, 'G');
-        F->F1 = X(drop_precision_tb_eigen_FMM)(F2->F1);
-        F->F2 = X(drop_precision_tb_eigen_FMM)(F2->F2);
-        F->X = malloc(s*b*sizeof(FLT));
-        for (int i = 0; i < s*b; i++)
-            F->X[i] = F2->X[i];
-        F->Y = malloc((n-s)*b*sizeof(FLT));
-        for (int i = 0; i < (n-s)*b; i++)
-            F->Y[i] = F2->Y[i];
+        FLT * lambda = X(drop_precision_array)(F2->lambda, n, destroy);
+        if (destroy) {
+            free(F2->t1);
+            free(F2->t2);
+        }
+        // A single block is the low-rank coupling of tb_eig_FMM_3arg, which is not a Cauchy matrix.
+        if (F2->F0->M == 1 && F2->F0->N == 1)
+            F->F0 = X(drop_precision_lowrank_coupling)(F2->F0, destroy);
+        else {
+            if (destroy)
+                X2(destroy_hierarchicalmatrix)(F2->F0);
+            F->F0 = X(sample_hierarchicalmatrix_tol)(X(cauchykernel), lambda, lambda+s, (unitrange) {0, s}, (unitrange) {0, n-s}, 'G', MAX(tol, Y(eps)()));
+        }
+        F->X = X(drop_precision_array)(F2->X, (size_t) s*b, destroy);
+        F->Y = X(drop_precision_array)(F2->Y, (size_t) (n-s)*b, destroy);
+        F->F1 = X(drop_precision_tb_eigen_FMM_destroy)(F2->F1, tol, destroy);
+        F->F2 = X(drop_precision_tb_eigen_FMM_destroy)(F2->F2, tol, destroy);
         F->t1 = calloc(s*FT_GET_MAX_THREADS(), sizeof(FLT));
         F->t2 = calloc((n-s)*FT_GET_MAX_THREADS(), sizeof(FLT));
         F->lambda = lambda;
         F->n = n;
         F->b = b;
     }
+    if (destroy)
+        free(F2);
     return F;
 }
+
+X(tb_eigen_FMM) * X(drop_precision_tb_eigen_FMM)(X2(tb_eigen_FMM) * F2) {return X(drop_precision_tb_eigen_FMM_destroy)(F2, Y(eps)(), 0);}
+X(tb_eigen_FMM) * X(drop_precision_tb_eigen_FMM_tol)(X2(tb_eigen_FMM) * F2, const FLT tol) {return X(drop_precision_tb_eigen_FMM_destroy)(F2, tol, 0);}
+X(tb_eigen_FMM) * X(drop_precision_destroy_tb_eigen_FMM)(X2(tb_eigen_FMM) * F2) {return X(drop_precision_tb_eigen_FMM_destroy)(F2, Y(eps)(), 1);}
+X(tb_eigen_FMM) * X(drop_precision_destroy_tb_eigen_FMM_tol)(X2(tb_eigen_FMM) * F2, const FLT tol) {return X(drop_precision_tb_eigen_FMM_destroy)(F2, tol, 1);}
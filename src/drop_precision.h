@@ -5,3 +5,14 @@ X(symmetric_dpr1_eigen) * X(drop_precision_symmetric_dpr1_eigen)(X2(symmetric_dp
 X(symmetric_dpr1_eigen_FMM) * X(drop_precision_symmetric_dpr1_eigen_FMM)(X2(symmetric_dpr1_eigen_FMM) * F2);
 
 X(tb_eigen_FMM) * X(drop_precision_tb_eigen_FMM)(X2(tb_eigen_FMM) * F2);
+X(tb_eigen_FMM) * X(drop_precision_tb_eigen_FMM_tol)(X2(tb_eigen_FMM) * F2, const FLT tol);
+
+// As above, but F2 is destroyed along the way.
+X(tdc_eigen) * X(drop_precision_destroy_tdc_eigen)(X2(tdc_eigen) * F2);
+X(tdc_eigen_FMM) * X(drop_precision_destroy_tdc_eigen_FMM)(X2(tdc_eigen_FMM) * F2);
+
+X(symmetric_dpr1_eigen) * X(drop_precision_destroy_symmetric_dpr1_eigen)(X2(symmetric_dpr1_eigen) * F2);
+X(symmetric_dpr1_eigen_FMM) * X(drop_precision_destroy_symmetric_dpr1_eigen_FMM)(X2(symmetric_dpr1_eigen_FMM) * F2);
+
+X(tb_eigen_FMM) * X(drop_precision_destroy_tb_eigen_FMM)(X2(tb_eigen_FMM) * F2);
+X(tb_eigen_FMM) * X(drop_precision_destroy_tb_eigen_FMM_tol)(X2(tb_eigen_FMM) * F2, const FLT tol);
@@ -5,6 +5,7 @@
 #ifndef FASTTRANSFORMS_H
 #define FASTTRANSFORMS_H
 
+#include <stddef.h>
 #include <cblas.h>
 #include <fftw3.h>
 
@@ -14,11 +15,13 @@
     #define FT_GET_NUM_THREADS() omp_get_num_threads()
     #define FT_GET_MAX_THREADS() omp_get_max_threads()
     #define FT_SET_NUM_THREADS(x) omp_set_num_threads(x)
+    #define FT_IN_PARALLEL() omp_in_parallel()
 #else
     #define FT_GET_THREAD_NUM() 0
     #define FT_GET_NUM_THREADS() 1
     #define FT_GET_MAX_THREADS() 1
     #define FT_SET_NUM_THREADS(x)
+    #define FT_IN_PARALLEL() 0
 #endif
 
 #define FT_CONCAT(prefix, name, suffix) prefix ## name ## suffix
@@ -49,6 +52,7 @@ ft_tb_eigen_FMM * ft_plan_chebyshev_to_legendre(const int normcheb, const int no
   \sum_{\ell=0}^{n-1} c_\ell^{(1)} C_\ell^{(\lambda)}(x) = \sum_{\ell=0}^{n-1} c_\ell^{(2)} C_\ell^{(\mu)}(x).
   \f]
   `norm1` and `norm2` govern the normalizations, either standard ( == 0) or orthonormalized ( == 1).\n
+  If \f$\mu-\lambda\f$ is a small nonnegative integer and \f$\lambda\ne0\f$, the connection coefficients are banded and the plan stores them as such.\n
   See also \ref ft_plan_ultraspherical_to_ultrasphericalf, \ref ft_plan_ultraspherical_to_ultrasphericall, and \ref ft_mpfr_plan_ultraspherical_to_ultraspherical.
 */
 ft_tb_eigen_FMM * ft_plan_ultraspherical_to_ultraspherical(const int norm1, const int norm2, const int n, const double lambda, const double mu);
@@ -58,6 +62,7 @@ ft_tb_eigen_FMM * ft_plan_ultraspherical_to_ultraspherical(const int norm1, cons
   \sum_{\ell=0}^{n-1} c_\ell^{(1)} P_\ell^{(\alpha,\beta)}(x) = \sum_{\ell=0}^{n-1} c_\ell^{(2)} P_\ell^{(\gamma,\delta)}(x).
   \f]
   `norm1` and `norm2` govern the normalizations, either standard ( == 0) or orthonormalized ( == 1).\n
+  If \f$\gamma-\alpha\f$ and \f$\delta-\beta\f$ are small nonnegative integers, the connection coefficients are banded and the plan stores them as such.\n
   See also \ref ft_plan_jacobi_to_jacobif, \ref ft_plan_jacobi_to_jacobil, and \ref ft_mpfr_plan_jacobi_to_jacobi.
 */
 ft_tb_eigen_FMM * ft_plan_jacobi_to_jacobi(const int norm1, const int norm2, const int n, const double alpha, const double beta, const double gamma, const double delta);
@@ -124,6 +129,65 @@ ft_tb_eigen_FMM * ft_plan_ultraspherical_to_chebyshev(const int normultra, const
   See also \ref ft_plan_chebyshev_to_ultrasphericalf, \ref ft_plan_chebyshev_to_ultrasphericall, and \ref ft_mpfr_plan_chebyshev_to_ultraspherical.
 */
 ft_tb_eigen_FMM * ft_plan_chebyshev_to_ultraspherical(const int normcheb, const int normultra, const int n, const double lambda);
+/*!
+  \brief Pre-compute a factorization of the connection coefficients between associated Jacobi and Jacobi polynomials in double precision so that ft_bfmv converts between expansions:
+  \f[
+  \sum_{\ell=0}^{n-1} c_\ell^{(1)} P_\ell^{(\alpha,\beta)}(x;c) = \sum_{\ell=0}^{n-1} c_\ell^{(2)} P_\ell^{(\gamma,\delta)}(x).
+  \f]
+  `norm2` governs the normalization of the Jacobi polynomials, either standard ( == 0) or orthonormalized ( == 1).
+  The coupling of each level is compressed to low rank from its eigenvectors, which takes \f$\mathcal{O}(n^2)\f$ operations to plan in \f$\mathcal{O}(n\log^2n)\f$ storage.\n
+  See also \ref ft_plan_associated_jacobi_to_jacobif and \ref ft_plan_associated_jacobi_to_jacobil.
+*/
+ft_tb_eigen_FMM * ft_plan_associated_jacobi_to_jacobi(const int norm2, const int n, const int c, const double alpha, const double beta, const double gamma, const double delta);
+/*!
+  \brief Pre-compute the composition of a chain of connection plans and diagonal scalings in double precision so that one ft_bfmv applies them all:
+  \f[
+  V = D_{k-1} P_{k-1} \cdots D_1 P_1 D_0 P_0.
+  \f]
+  The plans `P[i]` must have the same dimension, and `D[i]` is a vector of length \f$n\f$ or `NULL` for no scaling.
+  The product is never formed: each level of it is compressed to low rank from a few of its columns and rows, which are applied through the chain in \f$\mathcal{O}(n)\f$ storage.\n
+  See also \ref ft_plan_compositef and \ref ft_plan_compositel.
+*/
+ft_tb_eigen_FMM * ft_plan_composite(const int k, ft_tb_eigen_FMM ** P, double ** D);
+/*!
+  \brief Pre-compute the factorization of \ref ft_plan_legendre_to_chebyshev to the relative tolerance `tol` instead of the working precision.
+  The tolerance sets the ranks of the low-rank blocks and the size of the smallest block that is compressed, so that both the plan and ft_bfmv cost less for a coarser tolerance.
+  A tolerance at or below the working precision gives the same plan as \ref ft_plan_legendre_to_chebyshev.\n
+  See also \ref ft_plan_legendre_to_chebyshev_tolf and \ref ft_plan_legendre_to_chebyshev_toll.
+*/
+ft_tb_eigen_FMM * ft_plan_legendre_to_chebyshev_tol(const int normleg, const int normcheb, const int n, const double tol);
+/// \ref ft_plan_chebyshev_to_legendre to the relative tolerance `tol`, as in \ref ft_plan_legendre_to_chebyshev_tol.
+ft_tb_eigen_FMM * ft_plan_chebyshev_to_legendre_tol(const int normcheb, const int normleg, const int n, const double tol);
+/// \ref ft_plan_ultraspherical_to_ultraspherical to the relative tolerance `tol`, as in \ref ft_plan_legendre_to_chebyshev_tol.
+ft_tb_eigen_FMM * ft_plan_ultraspherical_to_ultraspherical_tol(const int norm1, const int norm2, const int n, const double lambda, const double mu, const double tol);
+/// \ref ft_plan_jacobi_to_jacobi to the relative tolerance `tol`, as in \ref ft_plan_legendre_to_chebyshev_tol.
+ft_tb_eigen_FMM * ft_plan_jacobi_to_jacobi_tol(const int norm1, const int norm2, const int n, const double alpha, const double beta, const double gamma, const double delta, const double tol);
+/// \ref ft_plan_laguerre_to_laguerre to the relative tolerance `tol`, as in \ref ft_plan_legendre_to_chebyshev_tol.
+ft_tb_eigen_FMM * ft_plan_laguerre_to_laguerre_tol(const int norm1, const int norm2, const int n, const double alpha, const double beta, const double tol);
+/// \ref ft_plan_associated_jacobi_to_jacobi to the relative tolerance `tol`, as in \ref ft_plan_legendre_to_chebyshev_tol.
+ft_tb_eigen_FMM * ft_plan_associated_jacobi_to_jacobi_tol(const int norm2, const int n, const int c, const double alpha, const double beta, const double gamma, const double delta, const double tol);
+
+/// Data structure to store a Toeplitz-Hankel plan of a Legendre-Chebyshev connection.
+typedef struct ft_thstruct ft_toeplitz_hankel_plan;
+/*!
+  \brief Pre-compute a Toeplitz-Hankel plan of \ref ft_plan_legendre_to_chebyshev for large degrees.
+  In each parity, the connection coefficients are the Hadamard product of a Toeplitz matrix and a Hankel matrix whose symbol is a sum of a few exponentials,
+  so that the plan stores O(n) FFT coefficients and \ref ft_thmv costs O(n log² n) operations with a constant that does not grow with n.
+  It is in double precision only, and it is meant for degrees of 10⁵ and beyond, where the FMM plans are costly to pre-compute and to store.
+*/
+ft_toeplitz_hankel_plan * ft_plan_legendre_to_chebyshev_th(const int normleg, const int normcheb, const int n);
+/// Pre-compute a Toeplitz-Hankel plan of \ref ft_plan_chebyshev_to_legendre, as in \ref ft_plan_legendre_to_chebyshev_th.
+ft_toeplitz_hankel_plan * ft_plan_chebyshev_to_legendre_th(const int normcheb, const int normleg, const int n);
+/// Apply a Toeplitz-Hankel plan: x ← A*x, x ← Aᵀ*x, with the scratch that the plan allocates once, so that concurrent calls on one plan go through \ref ft_thmv_work.
+void ft_thmv(char TRANS, ft_toeplitz_hankel_plan * P, double * x);
+/// Apply a Toeplitz-Hankel plan as in \ref ft_thmv, with the scratch w of \ref ft_work_size_toeplitz_hankel_plan doubles from fftw_malloc.
+void ft_thmv_work(char TRANS, ft_toeplitz_hankel_plan * P, double * x, double * w);
+/// The number of doubles of scratch of \ref ft_thmv_work.
+size_t ft_work_size_toeplitz_hankel_plan(const ft_toeplitz_hankel_plan * P);
+/// Destroy a \ref ft_toeplitz_hankel_plan.
+void ft_destroy_toeplitz_hankel_plan(ft_toeplitz_hankel_plan * P);
+/// Summary size of a \ref ft_toeplitz_hankel_plan in bytes.
+size_t ft_summary_size_toeplitz_hankel_plan(ft_toeplitz_hankel_plan * P);
 
 /// A single precision version of \ref ft_plan_legendre_to_chebyshev.
 ft_tb_eigen_FMMf * ft_plan_legendre_to_chebyshevf(const int normleg, const int normcheb, const int n);
@@ -147,6 +211,22 @@ ft_tb_eigen_FMMf * ft_plan_chebyshev_to_jacobif(const int normcheb, const int no
 ft_tb_eigen_FMMf * ft_plan_ultraspherical_to_chebyshevf(const int normultra, const int normcheb, const int n, const float lambda);
 /// A single precision version of \ref ft_plan_chebyshev_to_ultraspherical.
 ft_tb_eigen_FMMf * ft_plan_chebyshev_to_ultrasphericalf(const int normcheb, const int normultra, const int n, const float lambda);
+/// A single precision version of \ref ft_plan_associated_jacobi_to_jacobi.
+ft_tb_eigen_FMMf * ft_plan_associated_jacobi_to_jacobif(const int norm2, const int n, const int c, const float alpha, const float beta, const float gamma, const float delta);
+/// A single precision version of \ref ft_plan_composite.
+ft_tb_eigen_FMMf * ft_plan_compositef(const int k, ft_tb_eigen_FMMf ** P, float ** D);
+/// A single precision version of \ref ft_plan_legendre_to_chebyshev_tol.
+ft_tb_eigen_FMMf * ft_plan_legendre_to_chebyshev_tolf(const int normleg, const int normcheb, const int n, const float tol);
+/// A single precision version of \ref ft_plan_chebyshev_to_legendre_tol.
+ft_tb_eigen_FMMf * ft_plan_chebyshev_to_legendre_tolf(const int normcheb, const int normleg, const int n, const float tol);
+/// A single precision version of \ref ft_plan_ultraspherical_to_ultraspherical_tol.
+ft_tb_eigen_FMMf * ft_plan_ultraspherical_to_ultraspherical_tolf(const int norm1, const int norm2, const int n, const float lambda, const float mu, const float tol);
+/// A single precision version of \ref ft_plan_jacobi_to_jacobi_tol.
+ft_tb_eigen_FMMf * ft_plan_jacobi_to_jacobi_tolf(const int norm1, const int norm2, const int n, const float alpha, const float beta, const float gamma, const float delta, const float tol);
+/// A single precision version of \ref ft_plan_laguerre_to_laguerre_tol.
+ft_tb_eigen_FMMf * ft_plan_laguerre_to_laguerre_tolf(const int norm1, const int norm2, const int n, const float alpha, const float beta, const float tol);
+/// A single precision version of \ref ft_plan_associated_jacobi_to_jacobi_tol.
+ft_tb_eigen_FMMf * ft_plan_associated_jacobi_to_jacobi_tolf(const int norm2, const int n, const int c, const float alpha, const float beta, const float gamma, const float delta, const float tol);
 
 /// A long double precision version of \ref ft_plan_legendre_to_chebyshev.
 ft_tb_eigen_FMMl * ft_plan_legendre_to_chebyshevl(const int normleg, const int normcheb, const int n);
@@ -170,6 +250,22 @@ ft_tb_eigen_FMMl * ft_plan_chebyshev_to_jacobil(const int normcheb, const int no
 ft_tb_eigen_FMMl * ft_plan_ultraspherical_to_chebyshevl(const int normultra, const int normcheb, const int n, const long double lambda);
 /// A long double precision version of \ref ft_plan_chebyshev_to_ultraspherical.
 ft_tb_eigen_FMMl * ft_plan_chebyshev_to_ultrasphericall(const int normcheb, const int normultra, const int n, const long double lambda);
+/// A long double precision version of \ref ft_plan_associated_jacobi_to_jacobi.
+ft_tb_eigen_FMMl * ft_plan_associated_jacobi_to_jacobil(const int norm2, const int n, const int c, const long double alpha, const long double beta, const long double gamma, const long double delta);
+/// A long double precision version of \ref ft_plan_composite.
+ft_tb_eigen_FMMl * ft_plan_compositel(const int k, ft_tb_eigen_FMMl ** P, long double ** D);
+/// A long double precision version of \ref ft_plan_legendre_to_chebyshev_tol.
+ft_tb_eigen_FMMl * ft_plan_legendre_to_chebyshev_toll(const int normleg, const int normcheb, const int n, const long double tol);
+/// A long double precision version of \ref ft_plan_chebyshev_to_legendre_tol.
+ft_tb_eigen_FMMl * ft_plan_chebyshev_to_legendre_toll(const int normcheb, const int normleg, const int n, const long double tol);
+/// A long double precision version of \ref ft_plan_ultraspherical_to_ultraspherical_tol.
+ft_tb_eigen_FMMl * ft_plan_ultraspherical_to_ultraspherical_toll(const int norm1, const int norm2, const int n, const long double lambda, const long double mu, const long double tol);
+/// A long double precision version of \ref ft_plan_jacobi_to_jacobi_tol.
+ft_tb_eigen_FMMl * ft_plan_jacobi_to_jacobi_toll(const int norm1, const int norm2, const int n, const long double alpha, const long double beta, const long double gamma, const long double delta, const long double tol);
+/// A long double precision version of \ref ft_plan_laguerre_to_laguerre_tol.
+ft_tb_eigen_FMMl * ft_plan_laguerre_to_laguerre_toll(const int norm1, const int norm2, const int n, const long double alpha, const long double beta, const long double tol);
+/// A long double precision version of \ref ft_plan_associated_jacobi_to_jacobi_tol.
+ft_tb_eigen_FMMl * ft_plan_associated_jacobi_to_jacobi_toll(const int norm2, const int n, const int c, const long double alpha, const long double beta, const long double gamma, const long double delta, const long double tol);
 
 #include <mpfr.h>
 
@@ -208,20 +304,30 @@ mpfr_t * ft_mpfr_plan_ultraspherical_to_chebyshev(const int normultra, const int
 /// A multi-precision version of \ref ft_plan_chebyshev_to_ultraspherical that returns a dense array of connection coefficients.
 mpfr_t * ft_mpfr_plan_chebyshev_to_ultraspherical(const int normcheb, const int normultra, const int n, mpfr_srcptr lambda, mpfr_prec_t prec, mpfr_rnd_t rnd);
 
-/// Set the number of OpenMP threads.
+/// Set the number of threads used by OpenMP, the BLAS, and FFTW plans created thereafter.
 void ft_set_num_threads(const int n);
+/// Get the number of threads set by \ref ft_set_num_threads.
+int ft_get_num_threads(void);
 
-/// Data structure to store sines and cosines of Givens rotations.
+/// Data structure to store sines and cosines of Givens rotations, laid out for degree ns >= n so that a plan of degree n may view those of a larger one.
 typedef struct {
     double * s;
     double * c;
     int n;
+    int ns;
+    size_t length;
 } ft_rotation_plan;
 
 /// Destroy a \ref ft_rotation_plan.
 void ft_destroy_rotation_plan(ft_rotation_plan * RP);
+/// Create a view of degree n <= RP->n of a \ref ft_rotation_plan that shares its sines and cosines, and is valid while RP is.
+ft_rotation_plan * ft_view_rotation_plan(const ft_rotation_plan * RP, const int n);
+/// Destroy a view created by \ref ft_view_rotation_plan.
+void ft_destroy_rotation_plan_view(ft_rotation_plan * RV);
 
 ft_rotation_plan * ft_plan_rotsphere(const int n);
+/// Extend a \ref ft_rotation_plan created by \ref ft_plan_rotsphere to the degree n in place, computing only the new rotations. Its views are invalidated.
+void ft_extend_rotsphere(ft_rotation_plan * RP, const int n);
 
 /// Convert a single vector of spherical harmonics of order m to 0/1.
 void ft_kernel_sph_hi2lo(const ft_rotation_plan * RP, const int m, double * A);
@@ -232,18 +338,32 @@ void ft_kernel_sph_lo2hi(const ft_rotation_plan * RP, const int m, double * A);
 void ft_kernel_sph_hi2lo_SSE(const ft_rotation_plan * RP, const int m, double * A);
 /// Convert a pair of vectors of spherical harmonics of order 0/1 to m.
 void ft_kernel_sph_lo2hi_SSE(const ft_rotation_plan * RP, const int m, double * A);
+/// Apply \ref ft_kernel_sph_hi2lo_SSE to the rows l = p (mod 2) only; p < 0 applies it to all rows.
+void ft_kernel_sph_hi2lo_SSE_parity(const ft_rotation_plan * RP, const int m, double * A, const int p);
+/// Apply \ref ft_kernel_sph_lo2hi_SSE to the rows l = p (mod 2) only; p < 0 applies it to all rows.
+void ft_kernel_sph_lo2hi_SSE_parity(const ft_rotation_plan * RP, const int m, double * A, const int p);
 
 /// Convert four vectors of spherical harmonics of order m, m, m+2, m+2 to 0/1.
 void ft_kernel_sph_hi2lo_AVX(const ft_rotation_plan * RP, const int m, double * A);
 /// Convert four vectors of spherical harmonics of order 0/1 to m, m, m+2, m+2.
 void ft_kernel_sph_lo2hi_AVX(const ft_rotation_plan * RP, const int m, double * A);
+/// Apply \ref ft_kernel_sph_hi2lo_AVX to the rows l = p (mod 2) only; p < 0 applies it to all rows.
+void ft_kernel_sph_hi2lo_AVX_parity(const ft_rotation_plan * RP, const int m, double * A, const int p);
+/// Apply \ref ft_kernel_sph_lo2hi_AVX to the rows l = p (mod 2) only; p < 0 applies it to all rows.
+void ft_kernel_sph_lo2hi_AVX_parity(const ft_rotation_plan * RP, const int m, double * A, const int p);
 
 /// Convert eight vectors of spherical harmonics of order m, m, m+2, m+2, m+4, m+4, m+6, m+6 to 0/1.
 void ft_kernel_sph_hi2lo_AVX512(const ft_rotation_plan * RP, const int m, double * A);
 /// Convert eight vectors of spherical harmonics of order 0/1 to m, m, m+2, m+2, m+4, m+4, m+6, m+6.
 void ft_kernel_sph_lo2hi_AVX512(const ft_rotation_plan * RP, const int m, double * A);
+/// Apply \ref ft_kernel_sph_hi2lo_AVX512 to the rows l = p (mod 2) only; p < 0 applies it to all rows.
+void ft_kernel_sph_hi2lo_AVX512_parity(const ft_rotation_plan * RP, const int m, double * A, const int p);
+/// Apply \ref ft_kernel_sph_lo2hi_AVX512 to the rows l = p (mod 2) only; p < 0 applies it to all rows.
+void ft_kernel_sph_lo2hi_AVX512_parity(const ft_rotation_plan * RP, const int m, double * A, const int p);
 
 ft_rotation_plan * ft_plan_rottriangle(const int n, const double alpha, const double beta, const double gamma);
+/// Extend a \ref ft_rotation_plan created by \ref ft_plan_rottriangle with the same parameters to the degree n in place, computing only the new rotations. Its views are invalidated.
+void ft_extend_rottriangle(ft_rotation_plan * RP, const int n, const double alpha, const double beta, const double gamma);
 
 /// Convert a single vector of triangular harmonics of order m to 0.
 void ft_kernel_tri_hi2lo(const ft_rotation_plan * RP, const int m, double * A);
@@ -266,6 +386,8 @@ void ft_kernel_tri_hi2lo_AVX512(const ft_rotation_plan * RP, const int m, double
 void ft_kernel_tri_lo2hi_AVX512(const ft_rotation_plan * RP, const int m, double * A);
 
 ft_rotation_plan * ft_plan_rotdisk(const int n);
+/// Extend a \ref ft_rotation_plan created by \ref ft_plan_rotdisk to the degree n in place, computing only the new rotations. Its views are invalidated.
+void ft_extend_rotdisk(ft_rotation_plan * RP, const int n);
 
 /// Convert a single vector of disk harmonics of order m to 0/1.
 void ft_kernel_disk_hi2lo(const ft_rotation_plan * RP, const int m, double * A);
@@ -298,6 +420,10 @@ void ft_kernel_tet_lo2hi_AVX(const ft_rotation_plan * RP, const int L, const int
 
 void ft_kernel_tet_hi2lo_AVX512(const ft_rotation_plan * RP, const int L, const int m, double * A);
 void ft_kernel_tet_lo2hi_AVX512(const ft_rotation_plan * RP, const int L, const int m, double * A);
+/// Apply \ref ft_kernel_tet_hi2lo_AVX512 to rows k0 <= k < k1 only; k0 must be a multiple of 8.
+void ft_kernel_tet_hi2lo_AVX512_rows(const ft_rotation_plan * RP, const int L, const int m, double * A, const int k0, const int k1);
+/// Apply \ref ft_kernel_tet_lo2hi_AVX512 to rows k0 <= k < k1 only; k0 must be a multiple of 8.
+void ft_kernel_tet_lo2hi_AVX512_rows(const ft_rotation_plan * RP, const int L, const int m, double * A, const int k0, const int k1);
 
 typedef struct {
     double * s1;
@@ -399,6 +525,24 @@ void ft_execute_spinsph_lo2hi_AVX(const ft_spin_rotation_plan * SRP, double * A,
 void ft_execute_spinsph_hi2lo_AVX512(const ft_spin_rotation_plan * SRP, double * A, double * B, const int M);
 void ft_execute_spinsph_lo2hi_AVX512(const ft_spin_rotation_plan * SRP, double * A, double * B, const int M);
 
+/// Planner flag for the harmonic transforms: keep only the forward connection matrices and apply their inverses by triangular solves, halving the memory and planning time.
+#define FT_HARMONIC_SOLVE 1
+/// Planner flag for the harmonic transforms: apply the connections through their FMM factorizations, in O(n log n) memory and planning time.
+#define FT_HARMONIC_FMM 2
+/// Planner flag for the harmonic transforms: store dense connection matrices at every degree.
+#define FT_HARMONIC_DENSE 4
+/// Planner flag for the harmonic transforms: stream blocks of orders through small per-thread buffers from the start, so that the workspace is never allocated.
+#define FT_HARMONIC_STREAMING 8
+/// Degree from which the harmonic planners choose \ref FT_HARMONIC_FMM unless \ref FT_HARMONIC_DENSE is set.
+#define FT_HARMONIC_FMM_THRESHOLD 4096
+
+/// Parity of the rows l (degree minus order) of a spherical harmonic array: even rows for an equatorially symmetric field.
+#define FT_PARITY_EVEN 1
+/// Parity of the rows l (degree minus order) of a spherical harmonic array: odd rows for an equatorially antisymmetric field.
+#define FT_PARITY_ODD 2
+/// Both parities, whose independent rotation chains may run on separate threads.
+#define FT_PARITY_BOTH 3
+
 /// Data structure to store a \ref ft_rotation_plan, and various arrays to represent 1D orthogonal polynomial transforms.
 typedef struct {
     ft_rotation_plan * RP;
@@ -407,40 +551,128 @@ typedef struct {
     double * P2;
     double * P1inv;
     double * P2inv;
+    ft_tb_eigen_FMM * F1;
+    ft_tb_eigen_FMM * F2;
     double alpha;
     double beta;
     double gamma;
+    int nthreads;
+    size_t lwork;
 } ft_harmonic_plan;
 
 /// Destroy a \ref ft_harmonic_plan.
 void ft_destroy_harmonic_plan(ft_harmonic_plan * P);
 
+/// Share the rotations and dense connection matrices of harmonic plans with equal parameters through a process-wide cache that keeps up to bytes of them when no plan holds them, or disable it with 0, the default.
+void ft_set_plan_cache_budget(const size_t bytes);
+/// Get the number of bytes held by the plan cache.
+size_t ft_get_plan_cache_size(void);
+
+/// Open a binary plan file read-only; plans loaded from it share its pages and remain valid until it is closed.
+ft_plan_file * ft_open_plan_file(const char * filename);
+/// Close a plan file and release every plan loaded from it.
+void ft_close_plan_file(ft_plan_file * PF);
+/// Save a \ref ft_rotation_plan to a binary plan file; returns 0 on success.
+int ft_save_rotation_plan(const ft_rotation_plan * RP, const char * filename);
+/// Load a \ref ft_rotation_plan that belongs to an open plan file.
+ft_rotation_plan * ft_load_rotation_plan(ft_plan_file * PF);
+/// Save a \ref ft_harmonic_plan to a binary plan file; returns 0 on success.
+int ft_save_harmonic_plan(const ft_harmonic_plan * P, const char * filename);
+/// Load a \ref ft_harmonic_plan with its own workspace that belongs to an open plan file and is not destroyed.
+ft_harmonic_plan * ft_load_harmonic_plan(ft_plan_file * PF);
+
+/// Create a view of degree n <= P->RP->n of a \ref ft_harmonic_plan with dense connections that shares its rotations and connection matrices, and is valid while P is.
+ft_harmonic_plan * ft_view_harmonic_plan(const ft_harmonic_plan * P, const int n);
+/// Destroy a view created by \ref ft_view_harmonic_plan.
+void ft_destroy_harmonic_plan_view(ft_harmonic_plan * V);
+
+/// Set the number of OpenMP and BLAS threads used to execute a \ref ft_harmonic_plan; 0 defers to \ref ft_get_num_threads.
+void ft_set_harmonic_plan_num_threads(ft_harmonic_plan * P, const int n);
+/// Release the workspace of a \ref ft_harmonic_plan and stream blocks of orders through small per-thread buffers instead, or restore it if streaming is 0.
+void ft_set_harmonic_plan_streaming(ft_harmonic_plan * P, const int streaming);
+
 /// Plan a spherical harmonic transform.
 ft_harmonic_plan * ft_plan_sph2fourier(const int n);
+/// Plan a spherical harmonic transform with a bitwise OR of planner flags such as \ref FT_HARMONIC_SOLVE.
+ft_harmonic_plan * ft_plan_sph2fourier_with_flags(const int n, const int flags);
+/// Extend a plan created by \ref ft_plan_sph2fourier to the degree n in place, computing only the new rotations and columns of its dense connections. Its views are invalidated, and the plan file of a loaded plan keeps its old components and owns the new ones.
+void ft_extend_sph2fourier(ft_harmonic_plan * P, const int n);
 
 /// Transform a spherical harmonic expansion to a bivariate Fourier series.
 void ft_execute_sph2fourier(const ft_harmonic_plan * P, double * A, const int N, const int M);
 /// Transform a bivariate Fourier series to a spherical harmonic expansion.
 void ft_execute_fourier2sph(const ft_harmonic_plan * P, double * A, const int N, const int M);
+/// Transform a spherical harmonic expansion stored with leading dimension LDA to a bivariate Fourier series.
+void ft_execute_sph2fourier_lda(const ft_harmonic_plan * P, double * A, const int N, const int M, const int LDA);
+/// Transform a bivariate Fourier series stored with leading dimension LDA to a spherical harmonic expansion.
+void ft_execute_fourier2sph_lda(const ft_harmonic_plan * P, double * A, const int N, const int M, const int LDA);
+/// Transform only the rows of the given \ref FT_PARITY_EVEN or \ref FT_PARITY_ODD parity of a spherical harmonic expansion, whose other rows are zero, to a bivariate Fourier series.
+void ft_execute_sph2fourier_parity(const ft_harmonic_plan * P, double * A, const int N, const int M, const int parity);
+/// Transform only the rows of the given parity of a bivariate Fourier series, whose other rows are zero, to a spherical harmonic expansion.
+void ft_execute_fourier2sph_parity(const ft_harmonic_plan * P, double * A, const int N, const int M, const int parity);
+/// Transform the rows of the given parity of a spherical harmonic expansion stored with leading dimension LDA to a bivariate Fourier series.
+void ft_execute_sph2fourier_parity_lda(const ft_harmonic_plan * P, double * A, const int N, const int M, const int LDA, const int parity);
+/// Transform the rows of the given parity of a bivariate Fourier series stored with leading dimension LDA to a spherical harmonic expansion.
+void ft_execute_fourier2sph_parity_lda(const ft_harmonic_plan * P, double * A, const int N, const int M, const int LDA, const int parity);
 
 void ft_execute_sphv2fourier(const ft_harmonic_plan * P, double * A, const int N, const int M);
 void ft_execute_fourier2sphv(const ft_harmonic_plan * P, double * A, const int N, const int M);
+void ft_execute_sphv2fourier_lda(const ft_harmonic_plan * P, double * A, const int N, const int M, const int LDA);
+void ft_execute_fourier2sphv_lda(const ft_harmonic_plan * P, double * A, const int N, const int M, const int LDA);
+
+/// Set the number of bytes of the blocks of columns that out-of-core execution streams through memory, 64 MiB by default.
+void ft_set_out_of_core_block_size(const size_t bytes);
+/// Get the number of bytes of the blocks of columns that out-of-core execution streams through memory.
+size_t ft_get_out_of_core_block_size(void);
+/*!
+  \brief Transform a spherical harmonic expansion stored column-major at the byte offset `offset` of a file to a bivariate Fourier series in place; returns 0 on success.
+  Blocks of columns are read, transformed and written back one at a time, the next block being prefetched and the last one written back asynchronously,
+  so that only a block of \ref ft_get_out_of_core_block_size bytes and the rotations and connections of the plan need to be resident.\n
+  See also \ref ft_execute_sph2fourier_mapped for an array in a memory-mapped file.
+*/
+int ft_execute_sph2fourier_file(const ft_harmonic_plan * P, const char * filename, const size_t offset, const int N, const int M);
+/// Transform a bivariate Fourier series in a file to a spherical harmonic expansion in place, as in \ref ft_execute_sph2fourier_file.
+int ft_execute_fourier2sph_file(const ft_harmonic_plan * P, const char * filename, const size_t offset, const int N, const int M);
+/// Transform a spherical harmonic expansion in a memory-mapped file to a bivariate Fourier series in blocks of columns, advising the system to read ahead and write back each block.
+void ft_execute_sph2fourier_mapped(const ft_harmonic_plan * P, double * A, const int N, const int M);
+/// Transform a bivariate Fourier series in a memory-mapped file to a spherical harmonic expansion, as in \ref ft_execute_sph2fourier_mapped.
+void ft_execute_fourier2sph_mapped(const ft_harmonic_plan * P, double * A, const int N, const int M);
+/// Apply \ref ft_bfmm to the F->n x N array stored column-major at the byte offset `offset` of a file, as in \ref ft_execute_sph2fourier_file; returns 0 on success.
+int ft_bfmm_file(char TRANS, ft_tb_eigen_FMM * F, const char * filename, const size_t offset, const int N);
+/// Apply \ref ft_bfmm to the F->n x N array in a memory-mapped file, as in \ref ft_execute_sph2fourier_mapped.
+void ft_bfmm_mapped(char TRANS, ft_tb_eigen_FMM * F, double * A, const int N);
 
 /// Plan a triangular harmonic transform.
 ft_harmonic_plan * ft_plan_tri2cheb(const int n, const double alpha, const double beta, const double gamma);
+/// Plan a triangular harmonic transform with a bitwise OR of planner flags such as \ref FT_HARMONIC_SOLVE.
+ft_harmonic_plan * ft_plan_tri2cheb_with_flags(const int n, const double alpha, const double beta, const double gamma, const int flags);
+/// Extend a plan created by \ref ft_plan_tri2cheb to the degree n in place, computing only the new rotations and columns of its dense connections. Its views are invalidated, and the plan file of a loaded plan keeps its old components and owns the new ones.
+void ft_extend_tri2cheb(ft_harmonic_plan * P, const int n);
 
 /// Transform a triangular harmonic expansion to a bivariate Chebyshev series.
 void ft_execute_tri2cheb(const ft_harmonic_plan * P, double * A, const int N, const int M);
 /// Transform a bivariate Chebyshev series to a triangular harmonic expansion.
 void ft_execute_cheb2tri(const ft_harmonic_plan * P, double * A, const int N, const int M);
+/// Transform a triangular harmonic expansion stored with leading dimension LDA to a bivariate Chebyshev series.
+void ft_execute_tri2cheb_lda(const ft_harmonic_plan * P, double * A, const int N, const int M, const int LDA);
+/// Transform a bivariate Chebyshev series stored with leading dimension LDA to a triangular harmonic expansion.
+void ft_execute_cheb2tri_lda(const ft_harmonic_plan * P, double * A, const int N, const int M, const int LDA);
 
 /// Plan a disk harmonic transform.
 ft_harmonic_plan * ft_plan_disk2cxf(const int n);
+/// Plan a disk harmonic transform with a bitwise OR of planner flags such as \ref FT_HARMONIC_SOLVE.
+ft_harmonic_plan * ft_plan_disk2cxf_with_flags(const int n, const int flags);
+/// Extend a plan created by \ref ft_plan_disk2cxf to the degree n in place, computing only the new rotations and columns of its dense connections. Its views are invalidated, and the plan file of a loaded plan keeps its old components and owns the new ones.
+void ft_extend_disk2cxf(ft_harmonic_plan * P, const int n);
 
 /// Transform a disk harmonic expansion to a Chebyshev--Fourier series.
 void ft_execute_disk2cxf(const ft_harmonic_plan * P, double * A, const int N, const int M);
 /// Transform a Chebyshev--Fourier series to a disk harmonic expansion.
 void ft_execute_cxf2disk(const ft_harmonic_plan * P, double * A, const int N, const int M);
+/// Transform a disk harmonic expansion stored with leading dimension LDA to a Chebyshev--Fourier series.
+void ft_execute_disk2cxf_lda(const ft_harmonic_plan * P, double * A, const int N, const int M, const int LDA);
+/// Transform a Chebyshev--Fourier series stored with leading dimension LDA to a disk harmonic expansion.
+void ft_execute_cxf2disk_lda(const ft_harmonic_plan * P, double * A, const int N, const int M, const int LDA);
 
 typedef struct {
     ft_rotation_plan * RP1;
@@ -452,21 +684,44 @@ typedef struct {
     double * P1inv;
     double * P2inv;
     double * P3inv;
+    ft_tb_eigen_FMM * F1;
+    ft_tb_eigen_FMM * F2;
+    ft_tb_eigen_FMM * F3;
     double alpha;
     double beta;
     double gamma;
     double delta;
+    int nthreads;
+    size_t lwork;
 } ft_tetrahedral_harmonic_plan;
 
 void ft_destroy_tetrahedral_harmonic_plan(ft_tetrahedral_harmonic_plan * P);
 
+/// Create a view of degree n <= P->RP1->n of a \ref ft_tetrahedral_harmonic_plan with dense connections that shares its rotations and connection matrices, and is valid while P is.
+ft_tetrahedral_harmonic_plan * ft_view_tetrahedral_harmonic_plan(const ft_tetrahedral_harmonic_plan * P, const int n);
+/// Destroy a view created by \ref ft_view_tetrahedral_harmonic_plan.
+void ft_destroy_tetrahedral_harmonic_plan_view(ft_tetrahedral_harmonic_plan * V);
+
+/// Set the number of OpenMP and BLAS threads used to execute a \ref ft_tetrahedral_harmonic_plan; 0 defers to \ref ft_get_num_threads.
+void ft_set_tetrahedral_harmonic_plan_num_threads(ft_tetrahedral_harmonic_plan * P, const int n);
+/// Release the workspace of a \ref ft_tetrahedral_harmonic_plan and stream each order through a per-thread buffer instead, or restore it if streaming is 0.
+void ft_set_tetrahedral_harmonic_plan_streaming(ft_tetrahedral_harmonic_plan * P, const int streaming);
+
 /// Plan a tetrahedral harmonic transform.
 ft_tetrahedral_harmonic_plan * ft_plan_tet2cheb(const int n, const double alpha, const double beta, const double gamma, const double delta);
+/// Plan a tetrahedral harmonic transform with a bitwise OR of planner flags such as \ref FT_HARMONIC_SOLVE.
+ft_tetrahedral_harmonic_plan * ft_plan_tet2cheb_with_flags(const int n, const double alpha, const double beta, const double gamma, const double delta, const int flags);
+/// Extend a plan created by \ref ft_plan_tet2cheb to the degree n in place, computing only the new rotations and columns of its dense connections. Its views are invalidated.
+void ft_extend_tet2cheb(ft_tetrahedral_harmonic_plan * P, const int n);
 
 /// Transform a tetrahedral harmonic expansion to a trivariate Chebyshev series.
 void ft_execute_tet2cheb(const ft_tetrahedral_harmonic_plan * P, double * A, const int N, const int L, const int M);
 /// Transform a trivariate Chebyshev series to a tetrahedral harmonic expansion.
 void ft_execute_cheb2tet(const ft_tetrahedral_harmonic_plan * P, double * A, const int N, const int L, const int M);
+/// Transform a tetrahedral harmonic expansion, whose (i,j,k) entry is stored at A[i+LDA*(j+L*k)], to a trivariate Chebyshev series.
+void ft_execute_tet2cheb_lda(const ft_tetrahedral_harmonic_plan * P, double * A, const int N, const int L, const int M, const int LDA);
+/// Transform a trivariate Chebyshev series, whose (i,j,k) entry is stored at A[i+LDA*(j+L*k)], to a tetrahedral harmonic expansion.
+void ft_execute_cheb2tet_lda(const ft_tetrahedral_harmonic_plan * P, double * A, const int N, const int L, const int M, const int LDA);
 
 
 int ft_fftw_init_threads(void);
@@ -479,18 +734,26 @@ typedef struct {
     fftw_plan plantheta4;
     fftw_plan planphi;
     double * Y;
+    int lda;
 } ft_sphere_fftw_plan;
 
 /// Destroy a \ref ft_sphere_fftw_plan.
 void ft_destroy_sphere_fftw_plan(ft_sphere_fftw_plan * P);
 
 ft_sphere_fftw_plan * ft_plan_sph_with_kind(const int N, const int M, const fftw_r2r_kind kind[3][1]);
+ft_sphere_fftw_plan * ft_plan_sph_with_kind_lda(const int N, const int M, const fftw_r2r_kind kind[3][1], const int LDA);
 /// Plan FFTW synthesis on the sphere.
 ft_sphere_fftw_plan * ft_plan_sph_synthesis(const int N, const int M);
 /// Plan FFTW analysis on the sphere.
 ft_sphere_fftw_plan * ft_plan_sph_analysis(const int N, const int M);
 ft_sphere_fftw_plan * ft_plan_sphv_synthesis(const int N, const int M);
 ft_sphere_fftw_plan * ft_plan_sphv_analysis(const int N, const int M);
+/// Plan FFTW synthesis on the sphere for arrays with leading dimension LDA.
+ft_sphere_fftw_plan * ft_plan_sph_synthesis_lda(const int N, const int M, const int LDA);
+/// Plan FFTW analysis on the sphere for arrays with leading dimension LDA.
+ft_sphere_fftw_plan * ft_plan_sph_analysis_lda(const int N, const int M, const int LDA);
+ft_sphere_fftw_plan * ft_plan_sphv_synthesis_lda(const int N, const int M, const int LDA);
+ft_sphere_fftw_plan * ft_plan_sphv_analysis_lda(const int N, const int M, const int LDA);
 
 /// Execute FFTW synthesis on the sphere.
 void ft_execute_sph_synthesis(const ft_sphere_fftw_plan * P, double * X, const int N, const int M);
@@ -502,6 +765,7 @@ void ft_execute_sphv_analysis(const ft_sphere_fftw_plan * P, double * X, const i
 
 typedef struct {
     fftw_plan planxy;
+    int lda;
 } ft_triangle_fftw_plan;
 
 /// Destroy a \ref ft_triangle_fftw_plan.
@@ -512,6 +776,11 @@ ft_triangle_fftw_plan * ft_plan_tri_with_kind(const int N, const int M, const ff
 ft_triangle_fftw_plan * ft_plan_tri_synthesis(const int N, const int M);
 /// Plan FFTW analysis on the triangle.
 ft_triangle_fftw_plan * ft_plan_tri_analysis(const int N, const int M);
+ft_triangle_fftw_plan * ft_plan_tri_with_kind_lda(const int N, const int M, const fftw_r2r_kind kind0, const fftw_r2r_kind kind1, const int LDA);
+/// Plan FFTW synthesis on the triangle for arrays with leading dimension LDA.
+ft_triangle_fftw_plan * ft_plan_tri_synthesis_lda(const int N, const int M, const int LDA);
+/// Plan FFTW analysis on the triangle for arrays with leading dimension LDA.
+ft_triangle_fftw_plan * ft_plan_tri_analysis_lda(const int N, const int M, const int LDA);
 
 /// Execute FFTW synthesis on the triangle.
 void ft_execute_tri_synthesis(const ft_triangle_fftw_plan * P, double * X, const int N, const int M);
@@ -520,6 +789,7 @@ void ft_execute_tri_analysis(const ft_triangle_fftw_plan * P, double * X, const
 
 typedef struct {
     fftw_plan planxyz;
+    int lda;
 } ft_tetrahedron_fftw_plan;
 
 void ft_destroy_tetrahedron_fftw_plan(ft_tetrahedron_fftw_plan * P);
@@ -527,6 +797,9 @@ void ft_destroy_tetrahedron_fftw_plan(ft_tetrahedron_fftw_plan * P);
 ft_tetrahedron_fftw_plan * ft_plan_tet_with_kind(const int N, const int L, const int M, const fftw_r2r_kind kind0, const fftw_r2r_kind kind1, const fftw_r2r_kind kind2);
 ft_tetrahedron_fftw_plan * ft_plan_tet_synthesis(const int N, const int L, const int M);
 ft_tetrahedron_fftw_plan * ft_plan_tet_analysis(const int N, const int L, const int M);
+ft_tetrahedron_fftw_plan * ft_plan_tet_with_kind_lda(const int N, const int L, const int M, const fftw_r2r_kind kind0, const fftw_r2r_kind kind1, const fftw_r2r_kind kind2, const int LDA);
+ft_tetrahedron_fftw_plan * ft_plan_tet_synthesis_lda(const int N, const int L, const int M, const int LDA);
+ft_tetrahedron_fftw_plan * ft_plan_tet_analysis_lda(const int N, const int L, const int M, const int LDA);
 
 void ft_execute_tet_synthesis(const ft_tetrahedron_fftw_plan * P, double * X, const int N, const int L, const int M);
 void ft_execute_tet_analysis(const ft_tetrahedron_fftw_plan * P, double * X, const int N, const int L, const int M);
@@ -538,6 +811,7 @@ typedef struct {
     fftw_plan planr4;
     fftw_plan plantheta;
     double * Y;
+    int lda;
 } ft_disk_fftw_plan;
 
 /// Destroy a \ref ft_disk_fftw_plan.
@@ -548,6 +822,11 @@ ft_disk_fftw_plan * ft_plan_disk_with_kind(const int N, const int M, const fftw_
 ft_disk_fftw_plan * ft_plan_disk_synthesis(const int N, const int M);
 /// Plan FFTW analysis on the disk.
 ft_disk_fftw_plan * ft_plan_disk_analysis(const int N, const int M);
+ft_disk_fftw_plan * ft_plan_disk_with_kind_lda(const int N, const int M, const fftw_r2r_kind kind[3][1], const int LDA);
+/// Plan FFTW synthesis on the disk for arrays with leading dimension LDA.
+ft_disk_fftw_plan * ft_plan_disk_synthesis_lda(const int N, const int M, const int LDA);
+/// Plan FFTW analysis on the disk for arrays with leading dimension LDA.
+ft_disk_fftw_plan * ft_plan_disk_analysis_lda(const int N, const int M, const int LDA);
 
 /// Execute FFTW synthesis on the disk.
 void ft_execute_disk_synthesis(const ft_disk_fftw_plan * P, double * X, const int N, const int M);
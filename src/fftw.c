@@ -3,25 +3,25 @@
 #include "fasttransforms.h"
 #include "ftinternal.h"
 
-static inline void colswap(const double * X, double * Y, const int N, const int M) {
+static inline void colswap(const double * X, double * Y, const int N, const int M, const int LDA) {
     for (int i = 0; i < N; i++)
         Y[i] = X[i];
     for (int j = 1; j < (M+1)/2; j++) {
         for (int i = 0; i < N; i++)
-            Y[i+j*N] = X[i+2*j*N];
+            Y[i+j*N] = X[i+2*j*LDA];
         for (int i = 0; i < N; i++)
-            Y[i+(M-j)*N] = -X[i+(2*j-1)*N];
+            Y[i+(M-j)*N] = -X[i+(2*j-1)*LDA];
     }
 }
 
-static inline void colswap_t(double * X, const double * Y, const int N, const int M) {
+static inline void colswap_t(double * X, const double * Y, const int N, const int M, const int LDA) {
     for (int i = 0; i < N; i++)
         X[i] = Y[i];
     for (int j = 1; j < (M+1)/2; j++) {
         for (int i = 0; i < N; i++)
-            X[i+2*j*N] = Y[i+j*N];
+            X[i+2*j*LDA] = Y[i+j*N];
         for (int i = 0; i < N; i++)
-            X[i+(2*j-1)*N] = -Y[i+(M-j)*N];
+            X[i+(2*j-1)*LDA] = -Y[i+(M-j)*N];
     }
 }
 
@@ -38,125 +38,145 @@ void ft_destroy_sphere_fftw_plan(ft_sphere_fftw_plan * P) {
     free(P);
 }
 
-ft_sphere_fftw_plan * ft_plan_sph_with_kind(const int N, const int M, const fftw_r2r_kind kind[3][1]) {
+ft_sphere_fftw_plan * ft_plan_sph_with_kind(const int N, const int M, const fftw_r2r_kind kind[3][1]) {return ft_plan_sph_with_kind_lda(N, M, kind, N);}
+
+ft_sphere_fftw_plan * ft_plan_sph_with_kind_lda(const int N, const int M, const fftw_r2r_kind kind[3][1], const int LDA) {
     int rank = 1; // not 2: we are computing 1d transforms //
     int n[] = {N}; // 1d transforms of length n //
-    int idist = 4*N, odist = 4*N;
+    int idist = 4*LDA, odist = 4*LDA;
     int istride = 1, ostride = 1; // distance between two elements in the same column //
     int * inembed = n, * onembed = n;
 
     ft_sphere_fftw_plan * P = malloc(sizeof(ft_sphere_fftw_plan));
 
     P->Y = fftw_malloc(N*M*sizeof(double));
+    double * X = fftw_malloc(LDA*M*sizeof(double));
 
     int howmany = (M+3)/4;
-    P->plantheta1 = fftw_plan_many_r2r(rank, n, howmany, P->Y, inembed, istride, idist, P->Y, onembed, ostride, odist, kind[0], FT_FFTW_FLAGS);
+    P->plantheta1 = fftw_plan_many_r2r(rank, n, howmany, X, inembed, istride, idist, X, onembed, ostride, odist, kind[0], FT_FFTW_FLAGS);
 
     howmany = (M+2)/4;
-    P->plantheta2 = fftw_plan_many_r2r(rank, n, howmany, P->Y, inembed, istride, idist, P->Y, onembed, ostride, odist, kind[1], FT_FFTW_FLAGS);
+    P->plantheta2 = fftw_plan_many_r2r(rank, n, howmany, X, inembed, istride, idist, X, onembed, ostride, odist, kind[1], FT_FFTW_FLAGS);
 
     howmany = (M+1)/4;
-    P->plantheta3 = fftw_plan_many_r2r(rank, n, howmany, P->Y, inembed, istride, idist, P->Y, onembed, ostride, odist, kind[1], FT_FFTW_FLAGS);
+    P->plantheta3 = fftw_plan_many_r2r(rank, n, howmany, X, inembed, istride, idist, X, onembed, ostride, odist, kind[1], FT_FFTW_FLAGS);
 
     howmany = M/4;
-    P->plantheta4 = fftw_plan_many_r2r(rank, n, howmany, P->Y, inembed, istride, idist, P->Y, onembed, ostride, odist, kind[0], FT_FFTW_FLAGS);
+    P->plantheta4 = fftw_plan_many_r2r(rank, n, howmany, X, inembed, istride, idist, X, onembed, ostride, odist, kind[0], FT_FFTW_FLAGS);
 
+    // Synthesis maps the workspace Y to X, analysis maps X to Y.
     n[0] = M;
     idist = odist = 1;
-    istride = ostride = N;
     howmany = N;
-    P->planphi = fftw_plan_many_r2r(rank, n, howmany, P->Y, inembed, istride, idist, P->Y, onembed, ostride, odist, kind[2], FT_FFTW_FLAGS);
+    if (kind[2][0] == FFTW_HC2R)
+        P->planphi = fftw_plan_many_r2r(rank, n, howmany, P->Y, inembed, N, idist, X, onembed, LDA, odist, kind[2], FT_FFTW_FLAGS);
+    else
+        P->planphi = fftw_plan_many_r2r(rank, n, howmany, X, inembed, LDA, idist, P->Y, onembed, N, odist, kind[2], FT_FFTW_FLAGS);
 
+    fftw_free(X);
+    P->lda = LDA;
     return P;
 }
 
-ft_sphere_fftw_plan * ft_plan_sph_synthesis(const int N, const int M) {
+ft_sphere_fftw_plan * ft_plan_sph_synthesis(const int N, const int M) {return ft_plan_sph_synthesis_lda(N, M, N);}
+ft_sphere_fftw_plan * ft_plan_sph_synthesis_lda(const int N, const int M, const int LDA) {
     const fftw_r2r_kind kind[3][1] = {{FFTW_REDFT01}, {FFTW_RODFT01}, {FFTW_HC2R}};
-    return ft_plan_sph_with_kind(N, M, kind);
+    return ft_plan_sph_with_kind_lda(N, M, kind, LDA);
 }
 
-ft_sphere_fftw_plan * ft_plan_sph_analysis(const int N, const int M) {
+ft_sphere_fftw_plan * ft_plan_sph_analysis(const int N, const int M) {return ft_plan_sph_analysis_lda(N, M, N);}
+ft_sphere_fftw_plan * ft_plan_sph_analysis_lda(const int N, const int M, const int LDA) {
     const fftw_r2r_kind kind[3][1] = {{FFTW_REDFT10}, {FFTW_RODFT10}, {FFTW_R2HC}};
-    return ft_plan_sph_with_kind(N, M, kind);
+    return ft_plan_sph_with_kind_lda(N, M, kind, LDA);
 }
 
-ft_sphere_fftw_plan * ft_plan_sphv_synthesis(const int N, const int M) {
+ft_sphere_fftw_plan * ft_plan_sphv_synthesis(const int N, const int M) {return ft_plan_sphv_synthesis_lda(N, M, N);}
+ft_sphere_fftw_plan * ft_plan_sphv_synthesis_lda(const int N, const int M, const int LDA) {
     const fftw_r2r_kind kind[3][1] = {{FFTW_RODFT01}, {FFTW_REDFT01}, {FFTW_HC2R}};
-    return ft_plan_sph_with_kind(N, M, kind);
+    return ft_plan_sph_with_kind_lda(N, M, kind, LDA);
 }
 
-ft_sphere_fftw_plan * ft_plan_sphv_analysis(const int N, const int M) {
+ft_sphere_fftw_plan * ft_plan_sphv_analysis(const int N, const int M) {return ft_plan_sphv_analysis_lda(N, M, N);}
+ft_sphere_fftw_plan * ft_plan_sphv_analysis_lda(const int N, const int M, const int LDA) {
     const fftw_r2r_kind kind[3][1] = {{FFTW_RODFT10}, {FFTW_REDFT10}, {FFTW_R2HC}};
-    return ft_plan_sph_with_kind(N, M, kind);
+    return ft_plan_sph_with_kind_lda(N, M, kind, LDA);
 }
 
 void ft_execute_sph_synthesis(const ft_sphere_fftw_plan * P, double * X, const int N, const int M) {
+    int LDA = P->lda;
     X[0] *= 2.0;
     for (int j = 3; j < M; j += 4) {
-        X[j*N] *= 2.0;
-        X[(j+1)*N] *= 2.0;
+        X[j*LDA] *= 2.0;
+        X[(j+1)*LDA] *= 2.0;
     }
     fftw_execute_r2r(P->plantheta1, X, X);
-    fftw_execute_r2r(P->plantheta2, X+N, X+N);
-    fftw_execute_r2r(P->plantheta3, X+2*N, X+2*N);
-    fftw_execute_r2r(P->plantheta4, X+3*N, X+3*N);
-    for (int i = 0; i < N*M; i++)
-        X[i] *= M_1_4_SQRT_PI;
+    fftw_execute_r2r(P->plantheta2, X+LDA, X+LDA);
+    fftw_execute_r2r(P->plantheta3, X+2*LDA, X+2*LDA);
+    fftw_execute_r2r(P->plantheta4, X+3*LDA, X+3*LDA);
+    for (int j = 0; j < M; j++)
+        for (int i = 0; i < N; i++)
+            X[i+j*LDA] *= M_1_4_SQRT_PI;
     for (int i = 0; i < N; i++)
         X[i] *= M_SQRT2;
-    colswap(X, P->Y, N, M);
+    colswap(X, P->Y, N, M, LDA);
     fftw_execute_r2r(P->planphi, P->Y, X);
 }
 
 void ft_execute_sph_analysis(const ft_sphere_fftw_plan * P, double * X, const int N, const int M) {
+    int LDA = P->lda;
     fftw_execute_r2r(P->planphi, X, P->Y);
-    colswap_t(X, P->Y, N, M);
-    for (int i = 0; i < N*M; i++)
-        X[i] *= M_4_SQRT_PI/(2*N*M);
+    colswap_t(X, P->Y, N, M, LDA);
+    for (int j = 0; j < M; j++)
+        for (int i = 0; i < N; i++)
+            X[i+j*LDA] *= M_4_SQRT_PI/(2*N*M);
     for (int i = 0; i < N; i++)
         X[i] *= M_SQRT1_2;
     fftw_execute_r2r(P->plantheta1, X, X);
-    fftw_execute_r2r(P->plantheta2, X+N, X+N);
-    fftw_execute_r2r(P->plantheta3, X+2*N, X+2*N);
-    fftw_execute_r2r(P->plantheta4, X+3*N, X+3*N);
+    fftw_execute_r2r(P->plantheta2, X+LDA, X+LDA);
+    fftw_execute_r2r(P->plantheta3, X+2*LDA, X+2*LDA);
+    fftw_execute_r2r(P->plantheta4, X+3*LDA, X+3*LDA);
     X[0] *= 0.5;
     for (int j = 3; j < M; j += 4) {
-        X[j*N] *= 0.5;
-        X[(j+1)*N] *= 0.5;
+        X[j*LDA] *= 0.5;
+        X[(j+1)*LDA] *= 0.5;
     }
 }
 
 void ft_execute_sphv_synthesis(const ft_sphere_fftw_plan * P, double * X, const int N, const int M) {
+    int LDA = P->lda;
     for (int j = 1; j < M-2; j += 4) {
-        X[j*N] *= 2.0;
-        X[(j+1)*N] *= 2.0;
+        X[j*LDA] *= 2.0;
+        X[(j+1)*LDA] *= 2.0;
     }
     fftw_execute_r2r(P->plantheta1, X, X);
-    fftw_execute_r2r(P->plantheta2, X+N, X+N);
-    fftw_execute_r2r(P->plantheta3, X+2*N, X+2*N);
-    fftw_execute_r2r(P->plantheta4, X+3*N, X+3*N);
-    for (int i = 0; i < N*M; i++)
-        X[i] *= M_1_4_SQRT_PI;
+    fftw_execute_r2r(P->plantheta2, X+LDA, X+LDA);
+    fftw_execute_r2r(P->plantheta3, X+2*LDA, X+2*LDA);
+    fftw_execute_r2r(P->plantheta4, X+3*LDA, X+3*LDA);
+    for (int j = 0; j < M; j++)
+        for (int i = 0; i < N; i++)
+            X[i+j*LDA] *= M_1_4_SQRT_PI;
     for (int i = 0; i < N; i++)
         X[i] *= M_SQRT2;
-    colswap(X, P->Y, N, M);
+    colswap(X, P->Y, N, M, LDA);
     fftw_execute_r2r(P->planphi, P->Y, X);
 }
 
 void ft_execute_sphv_analysis(const ft_sphere_fftw_plan * P, double * X, const int N, const int M) {
+    int LDA = P->lda;
     fftw_execute_r2r(P->planphi, X, P->Y);
-    colswap_t(X, P->Y, N, M);
-    for (int i = 0; i < N*M; i++)
-        X[i] *= M_4_SQRT_PI/(2*N*M);
+    colswap_t(X, P->Y, N, M, LDA);
+    for (int j = 0; j < M; j++)
+        for (int i = 0; i < N; i++)
+            X[i+j*LDA] *= M_4_SQRT_PI/(2*N*M);
     for (int i = 0; i < N; i++)
         X[i] *= M_SQRT1_2;
     fftw_execute_r2r(P->plantheta1, X, X);
-    fftw_execute_r2r(P->plantheta2, X+N, X+N);
-    fftw_execute_r2r(P->plantheta3, X+2*N, X+2*N);
-    fftw_execute_r2r(P->plantheta4, X+3*N, X+3*N);
+    fftw_execute_r2r(P->plantheta2, X+LDA, X+LDA);
+    fftw_execute_r2r(P->plantheta3, X+2*LDA, X+2*LDA);
+    fftw_execute_r2r(P->plantheta4, X+3*LDA, X+3*LDA);
     for (int j = 1; j < M-2; j += 4) {
-        X[j*N] *= 0.5;
-        X[(j+1)*N] *= 0.5;
+        X[j*LDA] *= 0.5;
+        X[(j+1)*LDA] *= 0.5;
     }
 }
 
@@ -166,38 +186,51 @@ void ft_destroy_triangle_fftw_plan(ft_triangle_fftw_plan * P) {
     free(P);
 }
 
-ft_triangle_fftw_plan * ft_plan_tri_with_kind(const int N, const int M, const fftw_r2r_kind kind0, const fftw_r2r_kind kind1) {
+ft_triangle_fftw_plan * ft_plan_tri_with_kind(const int N, const int M, const fftw_r2r_kind kind0, const fftw_r2r_kind kind1) {return ft_plan_tri_with_kind_lda(N, M, kind0, kind1, N);}
+
+ft_triangle_fftw_plan * ft_plan_tri_with_kind_lda(const int N, const int M, const fftw_r2r_kind kind0, const fftw_r2r_kind kind1, const int LDA) {
+    // FFTW is row-major: the column index j varies slowest.
+    int n[] = {M, N};
+    int nembed[] = {M, LDA};
+    fftw_r2r_kind kind[] = {kind1, kind0};
     ft_triangle_fftw_plan * P = malloc(sizeof(ft_triangle_fftw_plan));
-    double * X = fftw_malloc(N*M*sizeof(double));
-    P->planxy = fftw_plan_r2r_2d(N, M, X, X, kind0, kind1, FT_FFTW_FLAGS);
+    double * X = fftw_malloc(LDA*M*sizeof(double));
+    P->planxy = fftw_plan_many_r2r(2, n, 1, X, nembed, 1, 0, X, nembed, 1, 0, kind, FT_FFTW_FLAGS);
     fftw_free(X);
+    P->lda = LDA;
     return P;
 }
 
 ft_triangle_fftw_plan * ft_plan_tri_synthesis(const int N, const int M) {return ft_plan_tri_with_kind(N, M, FFTW_REDFT01, FFTW_REDFT01);}
 ft_triangle_fftw_plan * ft_plan_tri_analysis(const int N, const int M) {return ft_plan_tri_with_kind(N, M, FFTW_REDFT10, FFTW_REDFT10);}
+ft_triangle_fftw_plan * ft_plan_tri_synthesis_lda(const int N, const int M, const int LDA) {return ft_plan_tri_with_kind_lda(N, M, FFTW_REDFT01, FFTW_REDFT01, LDA);}
+ft_triangle_fftw_plan * ft_plan_tri_analysis_lda(const int N, const int M, const int LDA) {return ft_plan_tri_with_kind_lda(N, M, FFTW_REDFT10, FFTW_REDFT10, LDA);}
 
 void ft_execute_tri_synthesis(const ft_triangle_fftw_plan * P, double * X, const int N, const int M) {
+    int LDA = P->lda;
     if (N > 1 && M > 1) {
         for (int i = 0; i < N; i++)
             X[i] *= 2.0;
         for (int j = 0; j < M; j++)
-            X[j*N] *= 2.0;
+            X[j*LDA] *= 2.0;
         fftw_execute_r2r(P->planxy, X, X);
-        for (int i = 0; i < N*M; i++)
-            X[i] *= 0.25;
+        for (int j = 0; j < M; j++)
+            for (int i = 0; i < N; i++)
+                X[i+j*LDA] *= 0.25;
     }
 }
 
 void ft_execute_tri_analysis(const ft_triangle_fftw_plan * P, double * X, const int N, const int M) {
+    int LDA = P->lda;
     if (N > 1 && M > 1) {
         fftw_execute_r2r(P->planxy, X, X);
         for (int i = 0; i < N; i++)
             X[i] *= 0.5;
         for (int j = 0; j < M; j++)
-            X[j*N] *= 0.5;
-        for (int i = 0; i < N*M; i++)
-            X[i] /= N*M;
+            X[j*LDA] *= 0.5;
+        for (int j = 0; j < M; j++)
+            for (int i = 0; i < N; i++)
+                X[i+j*LDA] /= N*M;
     }
 }
 
@@ -207,48 +240,61 @@ void ft_destroy_tetrahedron_fftw_plan(ft_tetrahedron_fftw_plan * P) {
     free(P);
 }
 
-ft_tetrahedron_fftw_plan * ft_plan_tet_with_kind(const int N, const int L, const int M, const fftw_r2r_kind kind0, const fftw_r2r_kind kind1, const fftw_r2r_kind kind2) {
+ft_tetrahedron_fftw_plan * ft_plan_tet_with_kind(const int N, const int L, const int M, const fftw_r2r_kind kind0, const fftw_r2r_kind kind1, const fftw_r2r_kind kind2) {return ft_plan_tet_with_kind_lda(N, L, M, kind0, kind1, kind2, N);}
+
+ft_tetrahedron_fftw_plan * ft_plan_tet_with_kind_lda(const int N, const int L, const int M, const fftw_r2r_kind kind0, const fftw_r2r_kind kind1, const fftw_r2r_kind kind2, const int LDA) {
+    // FFTW is row-major: the index k varies slowest.
+    int n[] = {M, L, N};
+    int nembed[] = {M, L, LDA};
+    fftw_r2r_kind kind[] = {kind2, kind1, kind0};
     ft_tetrahedron_fftw_plan * P = malloc(sizeof(ft_tetrahedron_fftw_plan));
-    double * X = fftw_malloc(N*L*M*sizeof(double));
-    P->planxyz = fftw_plan_r2r_3d(N, L, M, X, X, kind0, kind1, kind2, FT_FFTW_FLAGS);
+    double * X = fftw_malloc(LDA*L*M*sizeof(double));
+    P->planxyz = fftw_plan_many_r2r(3, n, 1, X, nembed, 1, 0, X, nembed, 1, 0, kind, FT_FFTW_FLAGS);
     fftw_free(X);
+    P->lda = LDA;
     return P;
 }
 
 ft_tetrahedron_fftw_plan * ft_plan_tet_synthesis(const int N, const int L, const int M) {return ft_plan_tet_with_kind(N, L, M, FFTW_REDFT01, FFTW_REDFT01, FFTW_REDFT01);}
 ft_tetrahedron_fftw_plan * ft_plan_tet_analysis(const int N, const int L, const int M) {return ft_plan_tet_with_kind(N, L, M, FFTW_REDFT10, FFTW_REDFT10, FFTW_REDFT10);}
+ft_tetrahedron_fftw_plan * ft_plan_tet_synthesis_lda(const int N, const int L, const int M, const int LDA) {return ft_plan_tet_with_kind_lda(N, L, M, FFTW_REDFT01, FFTW_REDFT01, FFTW_REDFT01, LDA);}
+ft_tetrahedron_fftw_plan * ft_plan_tet_analysis_lda(const int N, const int L, const int M, const int LDA) {return ft_plan_tet_with_kind_lda(N, L, M, FFTW_REDFT10, FFTW_REDFT10, FFTW_REDFT10, LDA);}
 
 void ft_execute_tet_synthesis(const ft_tetrahedron_fftw_plan * P, double * X, const int N, const int L, const int M) {
+    int LDA = P->lda;
     if (N > 1 && L > 1 && M > 1) {
         for (int j = 0; j < L; j++)
             for (int i = 0; i < N; i++)
-                X[i+j*N] *= 2.0;
+                X[i+j*LDA] *= 2.0;
         for (int k = 0; k < M; k++)
             for (int j = 0; j < L; j++)
-                X[(j+k*L)*N] *= 2.0;
+                X[(j+k*L)*LDA] *= 2.0;
         for (int k = 0; k < M; k++)
             for (int i = 0; i < N; i++)
-                X[i+k*L*N] *= 2.0;
+                X[i+k*L*LDA] *= 2.0;
         fftw_execute_r2r(P->planxyz, X, X);
-        for (int i = 0; i < N*L*M; i++)
-            X[i] *= 0.125;
+        for (int j = 0; j < L*M; j++)
+            for (int i = 0; i < N; i++)
+                X[i+j*LDA] *= 0.125;
     }
 }
 
 void ft_execute_tet_analysis(const ft_tetrahedron_fftw_plan * P, double * X, const int N, const int L, const int M) {
+    int LDA = P->lda;
     if (N > 1 && L > 1 && M > 1) {
         fftw_execute_r2r(P->planxyz, X, X);
         for (int j = 0; j < L; j++)
             for (int i = 0; i < N; i++)
-                X[i+j*N] *= 0.5;
+                X[i+j*LDA] *= 0.5;
         for (int k = 0; k < M; k++)
             for (int j = 0; j < L; j++)
-                X[(j+k*L)*N] *= 0.5;
+                X[(j+k*L)*LDA] *= 0.5;
         for (int k = 0; k < M; k++)
             for (int i = 0; i < N; i++)
-                X[i+k*L*N] *= 0.5;
-        for (int i = 0; i < N*L*M; i++)
-            X[i] /= N*L*M;
+                X[i+k*L*LDA] *= 0.5;
+        for (int j = 0; j < L*M; j++)
+            for (int i = 0; i < N; i++)
+                X[i+j*LDA] /= N*L*M;
     }
 }
 
@@ -263,80 +309,94 @@ void ft_destroy_disk_fftw_plan(ft_disk_fftw_plan * P) {
     free(P);
 }
 
-ft_disk_fftw_plan * ft_plan_disk_with_kind(const int N, const int M, const fftw_r2r_kind kind[3][1]) {
+ft_disk_fftw_plan * ft_plan_disk_with_kind(const int N, const int M, const fftw_r2r_kind kind[3][1]) {return ft_plan_disk_with_kind_lda(N, M, kind, N);}
+
+ft_disk_fftw_plan * ft_plan_disk_with_kind_lda(const int N, const int M, const fftw_r2r_kind kind[3][1], const int LDA) {
     int rank = 1; // not 2: we are computing 1d transforms //
     int n[] = {N}; // 1d transforms of length n //
-    int idist = 4*N, odist = 4*N;
+    int idist = 4*LDA, odist = 4*LDA;
     int istride = 1, ostride = 1; // distance between two elements in the same column //
     int * inembed = n, * onembed = n;
 
     ft_disk_fftw_plan * P = malloc(sizeof(ft_disk_fftw_plan));
 
     P->Y = fftw_malloc(N*M*sizeof(double));
+    double * X = fftw_malloc(LDA*M*sizeof(double));
 
     int howmany = (M+3)/4;
-    P->planr1 = fftw_plan_many_r2r(rank, n, howmany, P->Y, inembed, istride, idist, P->Y, onembed, ostride, odist, kind[0], FT_FFTW_FLAGS);
+    P->planr1 = fftw_plan_many_r2r(rank, n, howmany, X, inembed, istride, idist, X, onembed, ostride, odist, kind[0], FT_FFTW_FLAGS);
 
     howmany = (M+2)/4;
-    P->planr2 = fftw_plan_many_r2r(rank, n, howmany, P->Y, inembed, istride, idist, P->Y, onembed, ostride, odist, kind[1], FT_FFTW_FLAGS);
+    P->planr2 = fftw_plan_many_r2r(rank, n, howmany, X, inembed, istride, idist, X, onembed, ostride, odist, kind[1], FT_FFTW_FLAGS);
 
     howmany = (M+1)/4;
-    P->planr3 = fftw_plan_many_r2r(rank, n, howmany, P->Y, inembed, istride, idist, P->Y, onembed, ostride, odist, kind[1], FT_FFTW_FLAGS);
+    P->planr3 = fftw_plan_many_r2r(rank, n, howmany, X, inembed, istride, idist, X, onembed, ostride, odist, kind[1], FT_FFTW_FLAGS);
 
     howmany = M/4;
-    P->planr4 = fftw_plan_many_r2r(rank, n, howmany, P->Y, inembed, istride, idist, P->Y, onembed, ostride, odist, kind[0], FT_FFTW_FLAGS);
+    P->planr4 = fftw_plan_many_r2r(rank, n, howmany, X, inembed, istride, idist, X, onembed, ostride, odist, kind[0], FT_FFTW_FLAGS);
 
+    // Synthesis maps the workspace Y to X, analysis maps X to Y.
     n[0] = M;
     idist = odist = 1;
-    istride = ostride = N;
     howmany = N;
-    P->plantheta = fftw_plan_many_r2r(rank, n, howmany, P->Y, inembed, istride, idist, P->Y, onembed, ostride, odist, kind[2], FT_FFTW_FLAGS);
+    if (kind[2][0] == FFTW_HC2R)
+        P->plantheta = fftw_plan_many_r2r(rank, n, howmany, P->Y, inembed, N, idist, X, onembed, LDA, odist, kind[2], FT_FFTW_FLAGS);
+    else
+        P->plantheta = fftw_plan_many_r2r(rank, n, howmany, X, inembed, LDA, idist, P->Y, onembed, N, odist, kind[2], FT_FFTW_FLAGS);
 
+    fftw_free(X);
+    P->lda = LDA;
     return P;
 }
 
-ft_disk_fftw_plan * ft_plan_disk_synthesis(const int N, const int M) {
+ft_disk_fftw_plan * ft_plan_disk_synthesis(const int N, const int M) {return ft_plan_disk_synthesis_lda(N, M, N);}
+ft_disk_fftw_plan * ft_plan_disk_synthesis_lda(const int N, const int M, const int LDA) {
     const fftw_r2r_kind kind[3][1] = {{FFTW_REDFT01}, {FFTW_REDFT11}, {FFTW_HC2R}};
-    return ft_plan_disk_with_kind(N, M, kind);
+    return ft_plan_disk_with_kind_lda(N, M, kind, LDA);
 }
 
-ft_disk_fftw_plan * ft_plan_disk_analysis(const int N, const int M) {
+ft_disk_fftw_plan * ft_plan_disk_analysis(const int N, const int M) {return ft_plan_disk_analysis_lda(N, M, N);}
+ft_disk_fftw_plan * ft_plan_disk_analysis_lda(const int N, const int M, const int LDA) {
     const fftw_r2r_kind kind[3][1] = {{FFTW_REDFT10}, {FFTW_REDFT11}, {FFTW_R2HC}};
-    return ft_plan_disk_with_kind(N, M, kind);
+    return ft_plan_disk_with_kind_lda(N, M, kind, LDA);
 }
 
 void ft_execute_disk_synthesis(const ft_disk_fftw_plan * P, double * X, const int N, const int M) {
+    int LDA = P->lda;
     X[0] *= 2.0;
     for (int j = 3; j < M; j += 4) {
-        X[j*N] *= 2.0;
-        X[(j+1)*N] *= 2.0;
+        X[j*LDA] *= 2.0;
+        X[(j+1)*LDA] *= 2.0;
     }
     fftw_execute_r2r(P->planr1, X, X);
-    fftw_execute_r2r(P->planr2, X+N, X+N);
-    fftw_execute_r2r(P->planr3, X+2*N, X+2*N);
-    fftw_execute_r2r(P->planr4, X+3*N, X+3*N);
-    for (int i = 0; i < N*M; i++)
-        X[i] *= M_1_4_SQRT_PI;
+    fftw_execute_r2r(P->planr2, X+LDA, X+LDA);
+    fftw_execute_r2r(P->planr3, X+2*LDA, X+2*LDA);
+    fftw_execute_r2r(P->planr4, X+3*LDA, X+3*LDA);
+    for (int j = 0; j < M; j++)
+        for (int i = 0; i < N; i++)
+            X[i+j*LDA] *= M_1_4_SQRT_PI;
     for (int i = 0; i < N; i++)
         X[i] *= M_SQRT2;
-    colswap(X, P->Y, N, M);
+    colswap(X, P->Y, N, M, LDA);
     fftw_execute_r2r(P->plantheta, P->Y, X);
 }
 
 void ft_execute_disk_analysis(const ft_disk_fftw_plan * P, double * X, const int N, const int M) {
+    int LDA = P->lda;
     fftw_execute_r2r(P->plantheta, X, P->Y);
-    colswap_t(X, P->Y, N, M);
-    for (int i = 0; i < N*M; i++)
-        X[i] *= M_4_SQRT_PI/(2*N*M);
+    colswap_t(X, P->Y, N, M, LDA);
+    for (int j = 0; j < M; j++)
+        for (int i = 0; i < N; i++)
+            X[i+j*LDA] *= M_4_SQRT_PI/(2*N*M);
     for (int i = 0; i < N; i++)
         X[i] *= M_SQRT1_2;
     fftw_execute_r2r(P->planr1, X, X);
-    fftw_execute_r2r(P->planr2, X+N, X+N);
-    fftw_execute_r2r(P->planr3, X+2*N, X+2*N);
-    fftw_execute_r2r(P->planr4, X+3*N, X+3*N);
+    fftw_execute_r2r(P->planr2, X+LDA, X+LDA);
+    fftw_execute_r2r(P->planr3, X+2*LDA, X+2*LDA);
+    fftw_execute_r2r(P->planr4, X+3*LDA, X+3*LDA);
     X[0] *= 0.5;
     for (int j = 3; j < M; j += 4) {
-        X[j*N] *= 0.5;
-        X[(j+1)*N] *= 0.5;
+        X[j*LDA] *= 0.5;
+        X[(j+1)*LDA] *= 0.5;
     }
 }
@@ -1,10 +1,25 @@
 #ifndef FTINTERNAL_H
 #define FTINTERNAL_H
 
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
 #include <math.h>
 #include <quadmath.h>
 #include <immintrin.h>
+#include <cblas.h>
+#include "fasttransforms.h"
+
+#ifdef FT_USE_OPENBLAS
+    int openblas_get_num_threads(void);
+    void openblas_set_num_threads(int num_threads);
+    #define FT_BLAS_GET_NUM_THREADS() openblas_get_num_threads()
+    #define FT_BLAS_SET_NUM_THREADS(x) openblas_set_num_threads(x)
+#else
+    #define FT_BLAS_GET_NUM_THREADS() 1
+    #define FT_BLAS_SET_NUM_THREADS(x) ((void) (x))
+#endif
 
 #define RED(string) "\x1b[31m" string "\x1b[0m"
 #define GREEN(string) "\x1b[32m" string "\x1b[0m"
@@ -31,7 +46,9 @@
 #define M_FLT_MINl     0x1p-16382l            /* powl(2.0l, -16382) */
 #define M_FLT_MINq     0x1p-16382q            /* powq(2.0q, -16382) */
 
-#define M_PIf          0xc.90fdaap-2f         // 3.1415927f0
+#ifndef M_PIf
+    #define M_PIf      0xc.90fdaap-2f         // 3.1415927f0
+#endif
 #ifndef M_PIl
     #define M_PIl      0xc.90fdaa22168c235p-2l
 #endif
@@ -135,6 +152,11 @@ double * plan_legendre_to_chebyshev(const int normleg, const int normcheb, const
 double * plan_chebyshev_to_legendre(const int normcheb, const int normleg, const int n);
 double * plan_ultraspherical_to_ultraspherical(const int norm1, const int norm2, const int n, const double lambda, const double mu);
 double * plan_jacobi_to_jacobi(const int norm1, const int norm2, const int n, const double alpha, const double beta, const double gamma, const double delta);
+// The columns j0 <= j < n of the connection coefficients above, and zeros in the others.
+double * plan_legendre_to_chebyshev_columns(const int normleg, const int normcheb, const int n, const int j0);
+double * plan_chebyshev_to_legendre_columns(const int normcheb, const int normleg, const int n, const int j0);
+double * plan_ultraspherical_to_ultraspherical_columns(const int norm1, const int norm2, const int n, const double lambda, const double mu, const int j0);
+double * plan_jacobi_to_jacobi_columns(const int norm1, const int norm2, const int n, const double alpha, const double beta, const double gamma, const double delta, const int j0);
 double * plan_laguerre_to_laguerre(const int norm1, const int norm2, const int n, const double alpha, const double beta);
 double * plan_jacobi_to_ultraspherical(const int normjac, const int normultra, const int n, const double alpha, const double beta, const double lambda);
 double * plan_ultraspherical_to_jacobi(const int normultra, const int normjac, const int n, const double lambda, const double alpha, const double beta);
@@ -144,24 +166,104 @@ double * plan_ultraspherical_to_chebyshev(const int normultra, const int normche
 double * plan_chebyshev_to_ultraspherical(const int normcheb, const int normultra, const int n, const double lambda);
 double * plan_associated_jacobi_to_jacobi(const int norm2, const int n, const int c, const double alpha, const double beta, const double gamma, const double delta);
 
-void permute(const double * A, double * B, const int N, const int M, const int L);
-void permute_t(double * A, const double * B, const int N, const int M, const int L);
+void permute_lda(const double * A, double * B, const int N, const int M, const int L, const int LDA);
+void permute_t_lda(double * A, const double * B, const int N, const int M, const int L, const int LDA);
+
+void permute_sph_lda(const double * A, double * B, const int N, const int M, const int L, const int LDA);
+void permute_t_sph_lda(double * A, const double * B, const int N, const int M, const int L, const int LDA);
+
+void permute_tri_lda(const double * A, double * B, const int N, const int M, const int L, const int LDA);
+void permute_t_tri_lda(double * A, const double * B, const int N, const int M, const int L, const int LDA);
 
-void permute_sph(const double * A, double * B, const int N, const int M, const int L);
-void permute_t_sph(double * A, const double * B, const int N, const int M, const int L);
+#define permute(A, B, N, M, L) permute_lda(A, B, N, M, L, N)
+#define permute_t(A, B, N, M, L) permute_t_lda(A, B, N, M, L, N)
 
-void permute_tri(const double * A, double * B, const int N, const int M, const int L);
-void permute_t_tri(double * A, const double * B, const int N, const int M, const int L);
+#define permute_sph(A, B, N, M, L) permute_sph_lda(A, B, N, M, L, N)
+#define permute_t_sph(A, B, N, M, L) permute_t_sph_lda(A, B, N, M, L, N)
+
+#define permute_tri(A, B, N, M, L) permute_tri_lda(A, B, N, M, L, N)
+#define permute_t_tri(A, B, N, M, L) permute_t_tri_lda(A, B, N, M, L, N)
 
 #define permute_disk(A, B, N, M, L) permute_sph(A, B, N, M, L)
 #define permute_t_disk(A, B, N, M, L) permute_t_sph(A, B, N, M, L)
+#define permute_disk_lda(A, B, N, M, L, LDA) permute_sph_lda(A, B, N, M, L, LDA)
+#define permute_t_disk_lda(A, B, N, M, L, LDA) permute_t_sph_lda(A, B, N, M, L, LDA)
 
 #define permute_spinsph(A, B, N, M, L) permute_sph(A, B, N, M, L)
 #define permute_t_spinsph(A, B, N, M, L) permute_t_sph(A, B, N, M, L)
 
+// Block size of the packed storage of upper-triangular connection matrices.
+#define FT_PACKED_BLOCK 64
+
+size_t packed_size(const int n);
+double * pack_upper(const double * A, const int n);
+double * extend_packed_upper(const double * P, const int np, const double * A, const int n);
+void packed_dtrmm(const enum CBLAS_SIDE side, const enum CBLAS_TRANSPOSE trans, const int m, const int n, const double * P, const int np, double * B, const int ldb);
+void packed_dtrsm(const enum CBLAS_SIDE side, const enum CBLAS_TRANSPOSE trans, const int m, const int n, const double * P, const int np, double * B, const int ldb);
+
+// Double-double kernels for quadruple-precision operands, behind FT_USE_DDOUBLE.
+void ddgemvq(char TRANS, int m, int n, quadruple alpha, quadruple * A, int LDA, quadruple * x, quadruple beta, quadruple * y);
+void ddgemmq(char TRANS, int m, int n, int p, quadruple alpha, quadruple * A, int LDA, quadruple * B, int LDB, quadruple beta, quadruple * C, int LDC);
+void ddtrmvq(char TRANS, int n, quadruple * A, int LDA, quadruple * x);
+void ddtrsvq(char TRANS, int n, quadruple * A, int LDA, quadruple * x);
+
+// The rotations of degree n that extend RP, or of RP == NULL, in a new plan.
+ft_rotation_plan * extend_rotsphere(const ft_rotation_plan * RP, const int n);
+ft_rotation_plan * extend_rottriangle(const ft_rotation_plan * RP, const int n, const double alpha, const double beta, const double gamma);
+ft_rotation_plan * extend_rotdisk(const ft_rotation_plan * RP, const int n);
+
+// Identifies a cached component by the kind of its builder, its dimension, and up to three
+// integer and six real parameters. Unused parameters are zero.
+typedef struct {
+    int kind;
+    int n;
+    int i[3];
+    double p[6];
+} ft_cache_key;
+
+void * ft_cache_acquire(const ft_cache_key * K, void * (*build)(const ft_cache_key * K), size_t (*bytes)(const ft_cache_key * K), void (*destroy)(void * data));
+void ft_cache_release(void * data, void (*destroy)(void * data));
+
+// Writing and reading the plan files of serialize.c.
+#define FT_PLAN_FILE_VERSION 3
+
+#define FT_PLAN_FILE_ROTATION 1
+#define FT_PLAN_FILE_HARMONIC 2
+#define FT_PLAN_FILE_TB_EIGEN_FMM 3
+#define FT_PLAN_FILE_TDC_EIGEN 4
+
+typedef struct {
+    FILE * fp;
+    int64_t offset;
+    int failed;
+} ft_plan_writer;
+
+int ft_plan_writer_open(ft_plan_writer * W, const char * filename, const int kind, const size_t fltsize, const double eps);
+int64_t ft_plan_write(ft_plan_writer * W, const void * data, const size_t bytes, const size_t align);
+int64_t ft_plan_write_array(ft_plan_writer * W, const void * data, const size_t bytes);
+int64_t ft_plan_write_node(ft_plan_writer * W, const int64_t * fields, const int count);
+int ft_plan_writer_close(ft_plan_writer * W, const int64_t root);
+
+const int64_t * ft_plan_file_root(const ft_plan_file * PF, const int kind, const size_t fltsize, const double eps);
+void * ft_plan_file_at(const ft_plan_file * PF, const int64_t offset);
+void * ft_plan_file_own(ft_plan_file * PF, void * data, void (*deallocate)(void * data));
+void * ft_plan_file_calloc(ft_plan_file * PF, const size_t count, const size_t size);
+// The open plan file that owns data, or NULL; the plans loaded from a file are owned by it.
+ft_plan_file * ft_plan_file_owning(const void * data);
+
+int64_t ft_write_tb_eigen_FMM(ft_plan_writer * W, ft_tb_eigen_FMM * F);
+ft_tb_eigen_FMM * ft_read_tb_eigen_FMM(ft_plan_file * PF, const int64_t * node);
+
+int ft_out_of_core_window(const int LDA, const int M, const int align);
+int ft_stream_columns_file(const char * filename, const size_t offset, const int LDA, const int M, const int first, const int step, void (*kernel)(const void * ctx, double * A, const int LDA, const int j0, const int j1), const void * ctx);
+void ft_stream_columns_mapped(double * A, const int LDA, const int M, const int first, const int step, void (*kernel)(const void * ctx, double * A, const int LDA, const int j0, const int j1), const void * ctx);
+
 void swap_warp(double * A, double * B, const int N);
-void warp(double * A, const int N, const int M, const int L);
-void warp_t(double * A, const int N, const int M, const int L);
+void warp_lda(double * A, const int N, const int M, const int L, const int LDA);
+void warp_t_lda(double * A, const int N, const int M, const int L, const int LDA);
+
+#define warp(A, N, M, L) warp_lda(A, N, M, L, N)
+#define warp_t(A, N, M, L) warp_t_lda(A, N, M, L, N)
 
 // A bitwise OR ('|') of zero or more of the following: FFTW_ESTIMATE FFTW_MEASURE FFTW_PATIENT FFTW_EXHAUSTIVE FFTW_WISDOM_ONLY FFTW_DESTROY_INPUT FFTW_PRESERVE_INPUT FFTW_UNALIGNED
 #define FT_FFTW_FLAGS FFTW_MEASURE | FFTW_DESTROY_INPUT
@@ -177,8 +177,10 @@ X(lowrankmatrix) * X(malloc_lowrankmatrix)(char N, int m, int n, int r) {
     return L;
 }
 
-X(lowrankmatrix) * X(sample_lowrankmatrix)(FLT (*f)(FLT x, FLT y), FLT * x, FLT * y, unitrange i, unitrange j) {
-    int M = i.stop-i.start, N = j.stop-j.start, r = BLOCKRANK;
+X(lowrankmatrix) * X(sample_lowrankmatrix)(FLT (*f)(FLT x, FLT y), FLT * x, FLT * y, unitrange i, unitrange j) {return X(sample_lowrankmatrix_tol)(f, x, y, i, j, Y(eps)());}
+
+X(lowrankmatrix) * X(sample_lowrankmatrix_tol)(FLT (*f)(FLT x, FLT y), FLT * x, FLT * y, unitrange i, unitrange j, FLT tol) {
+    int M = i.stop-i.start, N = j.stop-j.start, r = BLOCKRANK_TOL(tol);
     X(lowrankmatrix) * L = X(malloc_lowrankmatrix)('3', M, N, r);
 
     FLT * xc1 = X(chebyshev_points)('1', r);
@@ -236,8 +238,11 @@ static FLT X(dist)(FLT * x, FLT * y, unitrange i, unitrange j) {
 // Assumes x is an increasing sequence
 static FLT X(diam)(FLT * x, unitrange i) {return x[i.stop-1] - x[i.start];}
 
-X(hierarchicalmatrix) * X(sample_hierarchicalmatrix)(FLT (*f)(FLT x, FLT y), FLT * x, FLT * y, unitrange i, unitrange j, char SPLITTING) {
-    int M = 2, N = 2;
+X(hierarchicalmatrix) * X(sample_hierarchicalmatrix)(FLT (*f)(FLT x, FLT y), FLT * x, FLT * y, unitrange i, unitrange j, char SPLITTING) {return X(sample_hierarchicalmatrix_tol)(f, x, y, i, j, SPLITTING, Y(eps)());}
+
+// The ranks of the low-rank blocks and the smallest of them follow from tol.
+X(hierarchicalmatrix) * X(sample_hierarchicalmatrix_tol)(FLT (*f)(FLT x, FLT y), FLT * x, FLT * y, unitrange i, unitrange j, char SPLITTING, FLT tol) {
+    int M = 2, N = 2, bs = 4*BLOCKRANK_TOL(tol);
     X(hierarchicalmatrix) * H = X(malloc_hierarchicalmatrix)(M, N);
     X(hierarchicalmatrix) ** HH = H->hierarchicalmatrices;
     X(densematrix) ** HD = H->densematrices;
@@ -257,55 +262,55 @@ X(hierarchicalmatrix) * X(sample_hierarchicalmatrix)(FLT (*f)(FLT x, FLT y), FLT
         X(indsplit)(y, j, &j1, &j2, y[j.start], y[j.stop-1]);
     }
 
-    if (i1.stop-i1.start < BLOCKSIZE || j1.stop-j1.start < BLOCKSIZE) {
+    if (i1.stop-i1.start < bs || j1.stop-j1.start < bs) {
         HD[0] = X(sample_densematrix)(f, x, y, i1, j1);
         H->hash(0, 0) = 2;
     }
     else if (X(dist)(x, y, i1, j1) >= MIN(X(diam)(x, i1), X(diam)(y, j1))) {
-        HL[0] = X(sample_lowrankmatrix)(f, x, y, i1, j1);
+        HL[0] = X(sample_lowrankmatrix_tol)(f, x, y, i1, j1, tol);
         H->hash(0, 0) = 3;
     }
     else {
-        HH[0] = X(sample_hierarchicalmatrix)(f, x, y, i1, j1, SPLITTING);
+        HH[0] = X(sample_hierarchicalmatrix_tol)(f, x, y, i1, j1, SPLITTING, tol);
         H->hash(0, 0) = 1;
     }
 
-    if (i2.stop-i2.start < BLOCKSIZE || j1.stop-j1.start < BLOCKSIZE) {
+    if (i2.stop-i2.start < bs || j1.stop-j1.start < bs) {
         HD[1] = X(sample_densematrix)(f, x, y, i2, j1);
         H->hash(1, 0) = 2;
     }
     else if (X(dist)(x, y, i2, j1) >= MIN(X(diam)(x, i2), X(diam)(y, j1))) {
-        HL[1] = X(sample_lowrankmatrix)(f, x, y, i2, j1);
+        HL[1] = X(sample_lowrankmatrix_tol)(f, x, y, i2, j1, tol);
         H->hash(1, 0) = 3;
     }
     else {
-        HH[1] = X(sample_hierarchicalmatrix)(f, x, y, i2, j1, SPLITTING);
+        HH[1] = X(sample_hierarchicalmatrix_tol)(f, x, y, i2, j1, SPLITTING, tol);
         H->hash(1, 0) = 1;
     }
 
-    if (i1.stop-i1.start < BLOCKSIZE || j2.stop-j2.start < BLOCKSIZE) {
+    if (i1.stop-i1.start < bs || j2.stop-j2.start < bs) {
         HD[2] = X(sample_densematrix)(f, x, y, i1, j2);
         H->hash(0, 1) = 2;
     }
     else if (X(dist)(x, y, i1, j2) >= MIN(X(diam)(x, i1), X(diam)(y, j2))) {
-        HL[2] = X(sample_lowrankmatrix)(f, x, y, i1, j2);
+        HL[2] = X(sample_lowrankmatrix_tol)(f, x, y, i1, j2, tol);
         H->hash(0, 1) = 3;
     }
     else {
-        HH[2] = X(sample_hierarchicalmatrix)(f, x, y, i1, j2, SPLITTING);
+        HH[2] = X(sample_hierarchicalmatrix_tol)(f, x, y, i1, j2, SPLITTING, tol);
         H->hash(0, 1) = 1;
     }
 
-    if (i2.stop-i2.start < BLOCKSIZE || j2.stop-j2.start < BLOCKSIZE) {
+    if (i2.stop-i2.start < bs || j2.stop-j2.start < bs) {
         HD[3] = X(sample_densematrix)(f, x, y, i2, j2);
         H->hash(1, 1) = 2;
     }
     else if (X(dist)(x, y, i2, j2) >= MIN(X(diam)(x, i2), X(diam)(y, j2))) {
-        HL[3] = X(sample_lowrankmatrix)(f, x, y, i2, j2);
+        HL[3] = X(sample_lowrankmatrix_tol)(f, x, y, i2, j2, tol);
         H->hash(1, 1) = 3;
     }
     else {
-        HH[3] = X(sample_hierarchicalmatrix)(f, x, y, i2, j2, SPLITTING);
+        HH[3] = X(sample_hierarchicalmatrix_tol)(f, x, y, i2, j2, SPLITTING, tol);
         H->hash(1, 1) = 1;
     }
 
@@ -437,6 +442,18 @@ size_t X(summary_size_hierarchicalmatrix)(X(hierarchicalmatrix) * H) {
     return S;
 }
 
+// The number of entries of scratch that X(ghmv_work) needs: two vectors of the largest rank.
+int X(work_size_hierarchicalmatrix)(X(hierarchicalmatrix) * H) {
+    int M = H->M, N = H->N, W = 0;
+    for (int n = 0; n < N; n++)
+        for (int m = 0; m < M; m++)
+            switch (H->hash(m, n)) {
+                case 1: W = MAX(W, X(work_size_hierarchicalmatrix)(H->hierarchicalmatrices(m, n))); break;
+                case 3: W = MAX(W, 2*H->lowrankmatrices(m, n)->r); break;
+            }
+    return W;
+}
+
 int X(nlevels_hierarchicalmatrix)(X(hierarchicalmatrix) * H) {
     int M = H->M, N = H->N, L = 0;
     for (int n = 0; n < N; n++)
@@ -585,40 +602,46 @@ void X(scale_columns_hierarchicalmatrix)(FLT alpha, FLT * x, X(hierarchicalmatri
 
 
 // y ← α*A*x + β*y, y ← α*Aᵀ*x + β*y
-void X(gemv)(char TRANS, int m, int n, FLT alpha, FLT * A, int LDA, FLT * x, FLT beta, FLT * y) {
-    FLT t;
-    if (TRANS == 'N') {
-        if (beta != 1) {
-            if (beta == 0)
-                for (int i = 0; i < m; i++)
-                    y[i] = 0;
-            else
-                for (int i = 0; i < m; i++)
-                    y[i] = beta*y[i];
-        }
-        for (int j = 0; j < n; j++) {
-            t = alpha*x[j];
-            for (int i = 0; i < m; i++)
-                y[i] += A[i+j*LDA]*t;
-        }
+#if defined(FT_USE_DDOUBLE)
+    void X(gemv)(char TRANS, int m, int n, FLT alpha, FLT * A, int LDA, FLT * x, FLT beta, FLT * y) {
+        ddgemvq(TRANS, m, n, alpha, A, LDA, x, beta, y);
     }
-    else if (TRANS == 'T') {
-        if (beta != 1) {
-            if (beta == 0)
-                for (int i = 0; i < n; i++)
-                    y[i] = 0;
-            else
-                for (int i = 0; i < n; i++)
-                    y[i] = beta*y[i];
+#else
+    void X(gemv)(char TRANS, int m, int n, FLT alpha, FLT * A, int LDA, FLT * x, FLT beta, FLT * y) {
+        FLT t;
+        if (TRANS == 'N') {
+            if (beta != 1) {
+                if (beta == 0)
+                    for (int i = 0; i < m; i++)
+                        y[i] = 0;
+                else
+                    for (int i = 0; i < m; i++)
+                        y[i] = beta*y[i];
+            }
+            for (int j = 0; j < n; j++) {
+                t = alpha*x[j];
+                for (int i = 0; i < m; i++)
+                    y[i] += A[i+j*LDA]*t;
+            }
         }
-        for (int i = 0; i < n; i++) {
-            t = 0;
-            for (int j = 0; j < m; j++)
-                t += A[j+i*LDA]*x[j];
-            y[i] += alpha*t;
+        else if (TRANS == 'T') {
+            if (beta != 1) {
+                if (beta == 0)
+                    for (int i = 0; i < n; i++)
+                        y[i] = 0;
+                else
+                    for (int i = 0; i < n; i++)
+                        y[i] = beta*y[i];
+            }
+            for (int i = 0; i < n; i++) {
+                t = 0;
+                for (int j = 0; j < m; j++)
+                    t += A[j+i*LDA]*x[j];
+                y[i] += alpha*t;
+            }
         }
     }
-}
+#endif
 
 // C ← α*A*B + β*C, C ← α*Aᵀ*B + β*C
 #if defined(FT_USE_CBLAS_S)
@@ -635,6 +658,10 @@ void X(gemv)(char TRANS, int m, int n, FLT alpha, FLT * A, int LDA, FLT * x, FLT
         else if (TRANS == 'T')
             cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, n, p, m, alpha, A, LDA, B, LDB, beta, C, LDC);
     }
+#elif defined(FT_USE_DDOUBLE)
+    void X(gemm)(char TRANS, int m, int n, int p, FLT alpha, FLT * A, int LDA, FLT * B, int LDB, FLT beta, FLT * C, int LDC) {
+        ddgemmq(TRANS, m, n, p, alpha, A, LDA, B, LDB, beta, C, LDC);
+    }
 #else
     void X(gemm)(char TRANS, int m, int n, int p, FLT alpha, FLT * A, int LDA, FLT * B, int LDB, FLT beta, FLT * C, int LDC) {
         FLT t;
@@ -687,8 +714,14 @@ void X(demm)(char TRANS, int p, FLT alpha, X(densematrix) * A, FLT * B, int LDB,
 
 // y ← α*(USVᵀ)*x + β*y, y ← α*(VSᵀUᵀ)*x + β*y
 void X(lrmv)(char TRANS, FLT alpha, X(lowrankmatrix) * L, FLT * x, FLT beta, FLT * y) {
+    X(lrmv_work)(TRANS, alpha, L, x, beta, y, NULL);
+}
+
+// As X(lrmv), with the temporaries in the 2r entries of w, or in the per-thread temporaries
+// of L if w is NULL.
+void X(lrmv_work)(char TRANS, FLT alpha, X(lowrankmatrix) * L, FLT * x, FLT beta, FLT * y, FLT * w) {
     int m = L->m, n = L->n, r = L->r;
-    FLT * t1 = L->t1+r*FT_GET_THREAD_NUM(), * t2 = L->t2+r*FT_GET_THREAD_NUM();
+    FLT * t1 = w != NULL ? w : L->t1+r*FT_GET_THREAD_NUM(), * t2 = w != NULL ? w+r : L->t2+r*FT_GET_THREAD_NUM();
     if (TRANS == 'N') {
         if (L->N == '2') {
             X(gemv)('T', n, r, 1, L->V, n, x, 0, t1);
@@ -752,6 +785,12 @@ void X(lrmm)(char TRANS, int p, FLT alpha, X(lowrankmatrix) * L, FLT * B, int LD
 
 // y ← α*H*x + β*y, y ← α*Hᵀ*x + β*y
 void X(ghmv)(char TRANS, FLT alpha, X(hierarchicalmatrix) * H, FLT * x, FLT beta, FLT * y) {
+    X(ghmv_work)(TRANS, alpha, H, x, beta, y, NULL);
+}
+
+// As X(ghmv), with the low-rank temporaries in the X(work_size_hierarchicalmatrix)(H) entries
+// of w, or in the per-thread temporaries of H if w is NULL.
+void X(ghmv_work)(char TRANS, FLT alpha, X(hierarchicalmatrix) * H, FLT * x, FLT beta, FLT * y, FLT * w) {
     int M = H->M, N = H->N;
     int p, q = 0;
     if (TRANS == 'N') {
@@ -767,9 +806,9 @@ void X(ghmv)(char TRANS, FLT alpha, X(hierarchicalmatrix) * H, FLT * x, FLT beta
             p = 0;
             for (int m = 0; m < M; m++) {
                 switch (H->hash(m, n)) {
-                    case 1: X(ghmv)(TRANS, alpha, H->hierarchicalmatrices(m, n), x+q, 1, y+p); break;
+                    case 1: X(ghmv_work)(TRANS, alpha, H->hierarchicalmatrices(m, n), x+q, 1, y+p, w); break;
                     case 2: X(demv)(TRANS, alpha, H->densematrices(m, n),        x+q, 1, y+p); break;
-                    case 3: X(lrmv)(TRANS, alpha, H->lowrankmatrices(m, n),      x+q, 1, y+p); break;
+                    case 3: X(lrmv_work)(TRANS, alpha, H->lowrankmatrices(m, n), x+q, 1, y+p, w); break;
                 }
                 p += X(blocksize_hierarchicalmatrix)(H, m, N-1, 1);
             }
@@ -789,9 +828,9 @@ void X(ghmv)(char TRANS, FLT alpha, X(hierarchicalmatrix) * H, FLT * x, FLT beta
             p = 0;
             for (int n = 0; n < N; n++) {
                 switch (H->hash(m, n)) {
-                    case 1: X(ghmv)(TRANS, alpha, H->hierarchicalmatrices(m, n), x+q, 1, y+p); break;
+                    case 1: X(ghmv_work)(TRANS, alpha, H->hierarchicalmatrices(m, n), x+q, 1, y+p, w); break;
                     case 2: X(demv)(TRANS, alpha, H->densematrices(m, n),        x+q, 1, y+p); break;
-                    case 3: X(lrmv)(TRANS, alpha, H->lowrankmatrices(m, n),      x+q, 1, y+p); break;
+                    case 3: X(lrmv_work)(TRANS, alpha, H->lowrankmatrices(m, n), x+q, 1, y+p, w); break;
                 }
                 p += X(blocksize_hierarchicalmatrix)(H, 0, n, 2);
             }
@@ -63,15 +63,18 @@ X(densematrix) * X(sample_accurately_densematrix)(FLT (*f)(FLT x, FLT ylo, FLT y
 X(lowrankmatrix) * X(calloc_lowrankmatrix)(char N, int m, int n, int r);
 X(lowrankmatrix) * X(malloc_lowrankmatrix)(char N, int m, int n, int r);
 X(lowrankmatrix) * X(sample_lowrankmatrix)(FLT (*f)(FLT x, FLT y), FLT * x, FLT * y, unitrange i, unitrange j);
+X(lowrankmatrix) * X(sample_lowrankmatrix_tol)(FLT (*f)(FLT x, FLT y), FLT * x, FLT * y, unitrange i, unitrange j, FLT tol);
 
 X(hierarchicalmatrix) * X(malloc_hierarchicalmatrix)(const int M, const int N);
 X(hierarchicalmatrix) * X(sample_hierarchicalmatrix) (FLT (*f)(FLT x, FLT y), FLT * x, FLT * y, unitrange i, unitrange j, char SPLITTING);
+X(hierarchicalmatrix) * X(sample_hierarchicalmatrix_tol) (FLT (*f)(FLT x, FLT y), FLT * x, FLT * y, unitrange i, unitrange j, char SPLITTING, FLT tol);
 X(hierarchicalmatrix) * X(sample_accurately_hierarchicalmatrix) (FLT (*f)(FLT x, FLT y), FLT (*f2)(FLT x, FLT ylo, FLT yhi), FLT * x, FLT * y, FLT * ylo, FLT * yhi, unitrange i, unitrange j, char SPLITTING);
 
 size_t X(summary_size_densematrix)(X(densematrix) * A);
 size_t X(summary_size_lowrankmatrix)(X(lowrankmatrix) * L);
 size_t X(summary_size_hierarchicalmatrix)(X(hierarchicalmatrix) * H);
 
+int X(work_size_hierarchicalmatrix)(X(hierarchicalmatrix) * H);
 int X(nlevels_hierarchicalmatrix)(X(hierarchicalmatrix) * H);
 
 FLT X(norm_densematrix)(X(densematrix) * A);
@@ -95,8 +98,10 @@ void X(gemm)(char TRANS, int m, int n, int p, FLT alpha, FLT * A, int LDA, FLT *
 void X(demv)(char TRANS, FLT alpha, X(densematrix) * A, FLT * x, FLT beta, FLT * y);
 void X(demm)(char TRANS, int p, FLT alpha, X(densematrix) * A, FLT * B, int LDB, FLT beta, FLT * C, int LDC);
 void X(lrmv)(char TRANS, FLT alpha, X(lowrankmatrix) * L, FLT * x, FLT beta, FLT * y);
+void X(lrmv_work)(char TRANS, FLT alpha, X(lowrankmatrix) * L, FLT * x, FLT beta, FLT * y, FLT * w);
 void X(lrmm)(char TRANS, int p, FLT alpha, X(lowrankmatrix) * L, FLT * B, int LDB, FLT beta, FLT * C, int LDC);
 void X(ghmv)(char TRANS, FLT alpha, X(hierarchicalmatrix) * H, FLT * x, FLT beta, FLT * y);
+void X(ghmv_work)(char TRANS, FLT alpha, X(hierarchicalmatrix) * H, FLT * x, FLT beta, FLT * y, FLT * w);
 void X(ghmm)(char TRANS, int p, FLT alpha, X(hierarchicalmatrix) * H, FLT * B, int LDB, FLT beta, FLT * C, int LDC);
 
 int X(binarysearch)(FLT * x, int start, int stop, FLT y);
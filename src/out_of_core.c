@@ -0,0 +1,215 @@
+// Out-of-core execution that streams blocks of columns of an array through memory.
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#ifdef _WIN32
+    #include <sys/stat.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#endif
+#include "fasttransforms.h"
+#include "ftinternal.h"
+
+/*
+The columns 0 ≤ j < M of an array with leading dimension LDA are visited in windows that end on
+the columns first + k*step, for k ≥ 1, and on M, and each window is transformed by a kernel that
+sees only its columns. A file is read into one buffer of a window: while a window is read and
+transformed, the operating system is asked to read the next one ahead, and once it is written, its write-back
+is started and the previous window, by then on disk, is dropped from the page cache. A mapped
+array is transformed in place with the same hints. The resident set is then one or two windows
+whatever the size of the array, and the throughput falls to that of the disk at worst.
+*/
+
+static size_t ooc_block_size = 67108864;
+
+void ft_set_out_of_core_block_size(const size_t bytes) {ooc_block_size = bytes;}
+
+size_t ft_get_out_of_core_block_size(void) {return ooc_block_size;}
+
+// The number of columns of LDA doubles in a window, as a multiple of align. A block size that
+// holds more than the M columns is clamped to them, so the window is representable as an int.
+int ft_out_of_core_window(const int LDA, const int M, const int align) {
+    size_t cols = ooc_block_size/((size_t) MAX(LDA, 1)*align*sizeof(double));
+    cols = MIN(cols, ((size_t) MAX(M, 1)+align-1)/align);
+    cols = MIN(cols, (size_t) (INT_MAX/align));
+    return align*(int) MAX(cols, 1);
+}
+
+static int ooc_window_end(const int j0, const int M, const int first, const int step) {
+    return j0 < first+step ? MIN(first+step, M) : MIN(first + step*((j0-first)/step+1), M);
+}
+
+#ifdef _WIN32
+static int ooc_read(FILE * fp, double * A, const size_t bytes, const int64_t offset) {
+    return _fseeki64(fp, offset, SEEK_SET) != 0 || fread(A, 1, bytes, fp) != bytes;
+}
+
+static int ooc_write(FILE * fp, const double * A, const size_t bytes, const int64_t offset) {
+    return _fseeki64(fp, offset, SEEK_SET) != 0 || fwrite(A, 1, bytes, fp) != bytes;
+}
+#else
+// pread and pwrite may move fewer bytes than asked for, and are retried until they are done.
+static int ooc_read(int fd, double * A, const size_t bytes, const int64_t offset) {
+    char * p = (char *) A;
+    for (size_t k = 0; k < bytes;) {
+        ssize_t r = pread(fd, p+k, bytes-k, offset+k);
+        if (r <= 0)
+            return 1;
+        k += r;
+    }
+    return 0;
+}
+
+static int ooc_write(int fd, const double * A, const size_t bytes, const int64_t offset) {
+    const char * p = (const char *) A;
+    for (size_t k = 0; k < bytes;) {
+        ssize_t r = pwrite(fd, p+k, bytes-k, offset+k);
+        if (r <= 0)
+            return 1;
+        k += r;
+    }
+    return 0;
+}
+
+static void ooc_prefetch(int fd, const int64_t offset, const size_t bytes) {
+    #ifdef POSIX_FADV_WILLNEED
+        posix_fadvise(fd, offset, bytes, POSIX_FADV_WILLNEED);
+    #endif
+}
+
+static void ooc_write_back(int fd, const int64_t offset, const size_t bytes) {
+    #ifdef SYNC_FILE_RANGE_WRITE
+        sync_file_range(fd, offset, bytes, SYNC_FILE_RANGE_WRITE);
+    #endif
+}
+
+static void ooc_release(int fd, const int64_t offset, const size_t bytes) {
+    #ifdef SYNC_FILE_RANGE_WRITE
+        sync_file_range(fd, offset, bytes, SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);
+    #endif
+    #ifdef POSIX_FADV_DONTNEED
+        posix_fadvise(fd, offset, bytes, POSIX_FADV_DONTNEED);
+    #endif
+}
+#endif
+
+int ft_stream_columns_file(const char * filename, const size_t offset, const int LDA, const int M, const int first, const int step, void (*kernel)(const void * ctx, double * A, const int LDA, const int j0, const int j1), const void * ctx) {
+    size_t col = (size_t) LDA*sizeof(double);
+    const char * error = NULL;
+#ifdef _WIN32
+    FILE * fp = fopen(filename, "r+b");
+    struct stat st;
+    if (fp == NULL || stat(filename, &st) != 0)
+        error = "cannot be opened";
+#else
+    int fd = open(filename, O_RDWR);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0)
+        error = "cannot be opened";
+#endif
+    else if (st.st_size < (int64_t) (offset + col*M))
+        error = "is too short for the array";
+    double * W = error == NULL ? VMALLOC((first+step)*col) : NULL;
+    #ifdef POSIX_FADV_SEQUENTIAL
+        if (error == NULL)
+            posix_fadvise(fd, offset, col*M, POSIX_FADV_SEQUENTIAL);
+    #endif
+    int64_t prev = -1;
+    size_t prevbytes = 0;
+    for (int j0 = 0, j1; error == NULL && j0 < M; j0 = j1) {
+        j1 = ooc_window_end(j0, M, first, step);
+        int64_t off = offset + (int64_t) (col*j0);
+        size_t bytes = col*(j1-j0);
+#ifdef _WIN32
+        if (ooc_read(fp, W, bytes, off)) {
+            error = "cannot be read";
+            break;
+        }
+        kernel(ctx, W, LDA, j0, j1);
+        if (ooc_write(fp, W, bytes, off))
+            error = "cannot be written";
+#else
+        if (j1 < M)
+            ooc_prefetch(fd, off+bytes, col*(ooc_window_end(j1, M, first, step)-j1));
+        if (ooc_read(fd, W, bytes, off)) {
+            error = "cannot be read";
+            break;
+        }
+        kernel(ctx, W, LDA, j0, j1);
+        if (ooc_write(fd, W, bytes, off)) {
+            error = "cannot be written";
+            break;
+        }
+        ooc_write_back(fd, off, bytes);
+        if (prev >= 0)
+            ooc_release(fd, prev, prevbytes);
+        prev = off;
+        prevbytes = bytes;
+#endif
+    }
+#ifdef _WIN32
+    if (fp != NULL && fclose(fp) != 0 && error == NULL)
+        error = "cannot be written";
+#else
+    if (prev >= 0)
+        ooc_release(fd, prev, prevbytes);
+    if (fd >= 0)
+        close(fd);
+#endif
+    VFREE(W);
+    if (error != NULL) {
+        printf(RED("FastTransforms: the array in %s %s.")"\n", filename, error);
+        return -1;
+    }
+    return 0;
+}
+
+void ft_stream_columns_mapped(double * A, const int LDA, const int M, const int first, const int step, void (*kernel)(const void * ctx, double * A, const int LDA, const int j0, const int j1), const void * ctx) {
+#ifdef _WIN32
+    for (int j0 = 0, j1; j0 < M; j0 = j1) {
+        j1 = ooc_window_end(j0, M, first, step);
+        kernel(ctx, A+(size_t) LDA*j0, LDA, j0, j1);
+    }
+#else
+    // The hints take whole pages, which may reach into the neighbouring windows.
+    uintptr_t page = sysconf(_SC_PAGESIZE);
+    for (int j0 = 0, j1; j0 < M; j0 = j1) {
+        j1 = ooc_window_end(j0, M, first, step);
+        if (j1 < M) {
+            uintptr_t lo = (uintptr_t) (A+(size_t) LDA*j1) & -page;
+            uintptr_t hi = (uintptr_t) (A+(size_t) LDA*ooc_window_end(j1, M, first, step));
+            madvise((void *) lo, hi-lo, MADV_WILLNEED);
+        }
+        kernel(ctx, A+(size_t) LDA*j0, LDA, j0, j1);
+        uintptr_t lo = (uintptr_t) (A+(size_t) LDA*j0) & -page;
+        uintptr_t hi = (uintptr_t) (A+(size_t) LDA*j1);
+        msync((void *) lo, hi-lo, MS_ASYNC);
+    }
+#endif
+}
+
+typedef struct {
+    ft_tb_eigen_FMM * F;
+    char TRANS;
+} ooc_bfmm_context;
+
+static void ooc_bfmm_kernel(const void * ctx, double * A, const int LDA, const int j0, const int j1) {
+    const ooc_bfmm_context * B = ctx;
+    ft_bfmm(B->TRANS, B->F, A, LDA, j1-j0);
+}
+
+int ft_bfmm_file(char TRANS, ft_tb_eigen_FMM * F, const char * filename, const size_t offset, const int N) {
+    ooc_bfmm_context B = {F, TRANS};
+    return ft_stream_columns_file(filename, offset, F->n, N, 0, ft_out_of_core_window(F->n, N, 1), ooc_bfmm_kernel, &B);
+}
+
+void ft_bfmm_mapped(char TRANS, ft_tb_eigen_FMM * F, double * A, const int N) {
+    ooc_bfmm_context B = {F, TRANS};
+    ft_stream_columns_mapped(A, F->n, N, 0, ft_out_of_core_window(F->n, N, 1), ooc_bfmm_kernel, &B);
+}
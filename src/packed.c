@@ -0,0 +1,118 @@
+// Blocked packed storage of upper-triangular matrices and its level-3 kernels.
+
+#include "ftinternal.h"
+
+// Block column J of an n x n upper-triangular matrix holds the rows 0 <= i < min((J+1)*nb, n)
+// of the columns J*nb <= j < min((J+1)*nb, n), in column-major order. Only the diagonal blocks
+// carry zeros, and every block column but the last has the same place and shape for all n.
+
+#define NB FT_PACKED_BLOCK
+
+static inline int packed_rows(const int jb, const int n) {return MIN((jb+1)*NB, n);}
+static inline int packed_cols(const int jb, const int n) {return MIN(NB, n-jb*NB);}
+static inline size_t packed_offset(const int jb) {return (size_t) NB*NB*jb*(jb+1)/2;}
+
+size_t packed_size(const int n) {
+    int nb = (n+NB-1)/NB;
+    return nb ? packed_offset(nb-1) + (size_t) packed_rows(nb-1, n)*packed_cols(nb-1, n) : 0;
+}
+
+double * pack_upper(const double * A, const int n) {return extend_packed_upper(NULL, 0, A, n);}
+
+// Packs the columns j < np of an n x n upper-triangular matrix from the packed matrix P of
+// dimension np, and the others from the dense A. Complete block columns of P are copied whole.
+double * extend_packed_upper(const double * P, const int np, const double * A, const int n) {
+    double * Q = malloc(packed_size(n)*sizeof(double));
+    for (int jb = 0; jb*NB < n; jb++) {
+        double * QJ = Q + packed_offset(jb);
+        const double * PJ = jb*NB < np ? P + packed_offset(jb) : NULL;
+        int r = packed_rows(jb, n), c = packed_cols(jb, n);
+        if ((jb+1)*NB <= np) {
+            memcpy(QJ, PJ, (size_t) r*c*sizeof(double));
+            continue;
+        }
+        for (int j = 0; j < c; j++) {
+            int jj = jb*NB+j;
+            for (int i = 0; i <= jj; i++)
+                QJ[i+j*r] = jj < np ? PJ[i+j*packed_rows(jb, np)] : A[i+jj*n];
+            for (int i = jj+1; i < r; i++)
+                QJ[i+j*r] = 0.0;
+        }
+    }
+    return Q;
+}
+
+// Block (ib, jb) of a packed matrix of dimension np and its leading dimension.
+static inline const double * packed_block(const double * P, const int ib, const int jb) {return P + packed_offset(jb) + ib*NB;}
+static inline int packed_ld(const int np, const int jb) {return packed_rows(jb, np);}
+
+// The kernels below apply the leading k x k block of a packed matrix of dimension np >= k,
+// where k = m for CblasLeft and k = n for CblasRight, to the m x n matrix B.
+
+void packed_dtrmm(const enum CBLAS_SIDE side, const enum CBLAS_TRANSPOSE trans, const int m, const int n, const double * P, const int np, double * B, const int ldb) {
+    int k = side == CblasLeft ? m : n, nb = (k+NB-1)/NB;
+    #define BS(ib) MIN(NB, k-(ib)*NB)
+    if (side == CblasLeft && trans == CblasNoTrans) {
+        for (int ib = 0; ib < nb; ib++) {
+            cblas_dtrmm(CblasColMajor, CblasLeft, CblasUpper, CblasNoTrans, CblasNonUnit, BS(ib), n, 1.0, packed_block(P, ib, ib), packed_ld(np, ib), B+ib*NB, ldb);
+            for (int jb = ib+1; jb < nb; jb++)
+                cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, BS(ib), n, BS(jb), 1.0, packed_block(P, ib, jb), packed_ld(np, jb), B+jb*NB, ldb, 1.0, B+ib*NB, ldb);
+        }
+    }
+    else if (side == CblasLeft) {
+        for (int ib = nb-1; ib >= 0; ib--) {
+            cblas_dtrmm(CblasColMajor, CblasLeft, CblasUpper, CblasTrans, CblasNonUnit, BS(ib), n, 1.0, packed_block(P, ib, ib), packed_ld(np, ib), B+ib*NB, ldb);
+            for (int jb = 0; jb < ib; jb++)
+                cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, BS(ib), n, BS(jb), 1.0, packed_block(P, jb, ib), packed_ld(np, ib), B+jb*NB, ldb, 1.0, B+ib*NB, ldb);
+        }
+    }
+    else if (trans == CblasNoTrans) {
+        for (int jb = nb-1; jb >= 0; jb--) {
+            cblas_dtrmm(CblasColMajor, CblasRight, CblasUpper, CblasNoTrans, CblasNonUnit, m, BS(jb), 1.0, packed_block(P, jb, jb), packed_ld(np, jb), B+jb*NB*ldb, ldb);
+            for (int ib = 0; ib < jb; ib++)
+                cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, m, BS(jb), BS(ib), 1.0, B+ib*NB*ldb, ldb, packed_block(P, ib, jb), packed_ld(np, jb), 1.0, B+jb*NB*ldb, ldb);
+        }
+    }
+    else {
+        for (int ib = 0; ib < nb; ib++) {
+            cblas_dtrmm(CblasColMajor, CblasRight, CblasUpper, CblasTrans, CblasNonUnit, m, BS(ib), 1.0, packed_block(P, ib, ib), packed_ld(np, ib), B+ib*NB*ldb, ldb);
+            for (int jb = ib+1; jb < nb; jb++)
+                cblas_dgemm(CblasColMajor, CblasNoTrans, CblasTrans, m, BS(ib), BS(jb), 1.0, B+jb*NB*ldb, ldb, packed_block(P, ib, jb), packed_ld(np, jb), 1.0, B+ib*NB*ldb, ldb);
+        }
+    }
+    #undef BS
+}
+
+void packed_dtrsm(const enum CBLAS_SIDE side, const enum CBLAS_TRANSPOSE trans, const int m, const int n, const double * P, const int np, double * B, const int ldb) {
+    int k = side == CblasLeft ? m : n, nb = (k+NB-1)/NB;
+    #define BS(ib) MIN(NB, k-(ib)*NB)
+    if (side == CblasLeft && trans == CblasNoTrans) {
+        for (int ib = nb-1; ib >= 0; ib--) {
+            for (int jb = ib+1; jb < nb; jb++)
+                cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, BS(ib), n, BS(jb), -1.0, packed_block(P, ib, jb), packed_ld(np, jb), B+jb*NB, ldb, 1.0, B+ib*NB, ldb);
+            cblas_dtrsm(CblasColMajor, CblasLeft, CblasUpper, CblasNoTrans, CblasNonUnit, BS(ib), n, 1.0, packed_block(P, ib, ib), packed_ld(np, ib), B+ib*NB, ldb);
+        }
+    }
+    else if (side == CblasLeft) {
+        for (int ib = 0; ib < nb; ib++) {
+            for (int jb = 0; jb < ib; jb++)
+                cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, BS(ib), n, BS(jb), -1.0, packed_block(P, jb, ib), packed_ld(np, ib), B+jb*NB, ldb, 1.0, B+ib*NB, ldb);
+            cblas_dtrsm(CblasColMajor, CblasLeft, CblasUpper, CblasTrans, CblasNonUnit, BS(ib), n, 1.0, packed_block(P, ib, ib), packed_ld(np, ib), B+ib*NB, ldb);
+        }
+    }
+    else if (trans == CblasNoTrans) {
+        for (int jb = 0; jb < nb; jb++) {
+            for (int ib = 0; ib < jb; ib++)
+                cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, m, BS(jb), BS(ib), -1.0, B+ib*NB*ldb, ldb, packed_block(P, ib, jb), packed_ld(np, jb), 1.0, B+jb*NB*ldb, ldb);
+            cblas_dtrsm(CblasColMajor, CblasRight, CblasUpper, CblasNoTrans, CblasNonUnit, m, BS(jb), 1.0, packed_block(P, jb, jb), packed_ld(np, jb), B+jb*NB*ldb, ldb);
+        }
+    }
+    else {
+        for (int ib = nb-1; ib >= 0; ib--) {
+            for (int jb = ib+1; jb < nb; jb++)
+                cblas_dgemm(CblasColMajor, CblasNoTrans, CblasTrans, m, BS(ib), BS(jb), -1.0, B+jb*NB*ldb, ldb, packed_block(P, ib, jb), packed_ld(np, jb), 1.0, B+ib*NB*ldb, ldb);
+            cblas_dtrsm(CblasColMajor, CblasRight, CblasUpper, CblasTrans, CblasNonUnit, m, BS(ib), 1.0, packed_block(P, ib, ib), packed_ld(np, ib), B+ib*NB*ldb, ldb);
+        }
+    }
+    #undef BS
+}
@@ -2,80 +2,82 @@
 
 #include "ftinternal.h"
 
-void permute(const double * A, double * B, const int N, const int M, const int L) {
+void permute_lda(const double * A, double * B, const int N, const int M, const int L, const int LDA) {
     int NB = VALIGN(N);
     #pragma omp parallel for if (N < 2*M)
     for (int j = 0; j < M; j += L)
-        for (int i = 0; i < L*N; i++)
-            B[(L*i)%(L*N)+(L*i)/(L*N)+j*NB] = A[i+j*N];
+        for (int k = 0; k < L; k++)
+            for (int i = 0; i < N; i++)
+                B[L*i+k+j*NB] = A[i+(j+k)*LDA];
 }
 
-void permute_t(double * A, const double * B, const int N, const int M, const int L) {
+void permute_t_lda(double * A, const double * B, const int N, const int M, const int L, const int LDA) {
     int NB = VALIGN(N);
     #pragma omp parallel for if (N < 2*M)
     for (int j = 0; j < M; j += L)
-        for (int i = 0; i < L*N; i++)
-            A[i+j*N] = B[(L*i)%(L*N)+(L*i)/(L*N)+j*NB];
+        for (int k = 0; k < L; k++)
+            for (int i = 0; i < N; i++)
+                A[i+(j+k)*LDA] = B[L*i+k+j*NB];
 }
 
 
-void permute_sph(const double * A, double * B, const int N, const int M, const int L) {
+void permute_sph_lda(const double * A, double * B, const int N, const int M, const int L, const int LDA) {
     int NB = VALIGN(N);
     if (L == 2) {
         for (int i = 0; i < N; i++)
             B[i] = A[i];
-        permute(A+N, B+NB, N, M-1, 2);
+        permute_lda(A+LDA, B+NB, N, M-1, 2, LDA);
     }
     else {
-        permute_sph(A, B, N, M%(2*L), L/2);
-        permute(A+(M%(2*L))*N, B+(M%(2*L))*NB, N, M-M%(2*L), L);
+        permute_sph_lda(A, B, N, M%(2*L), L/2, LDA);
+        permute_lda(A+(M%(2*L))*LDA, B+(M%(2*L))*NB, N, M-M%(2*L), L, LDA);
     }
 }
 
-void permute_t_sph(double * A, const double * B, const int N, const int M, const int L) {
+void permute_t_sph_lda(double * A, const double * B, const int N, const int M, const int L, const int LDA) {
     int NB = VALIGN(N);
     if (L == 2) {
         for (int i = 0; i < N; i++)
             A[i] = B[i];
-        permute_t(A+N, B+NB, N, M-1, 2);
+        permute_t_lda(A+LDA, B+NB, N, M-1, 2, LDA);
     }
     else {
-        permute_t_sph(A, B, N, M%(2*L), L/2);
-        permute_t(A+(M%(2*L))*N, B+(M%(2*L))*NB, N, M-M%(2*L), L);
+        permute_t_sph_lda(A, B, N, M%(2*L), L/2, LDA);
+        permute_t_lda(A+(M%(2*L))*LDA, B+(M%(2*L))*NB, N, M-M%(2*L), L, LDA);
     }
 }
 
-void permute_tri(const double * A, double * B, const int N, const int M, const int L) {
+void permute_tri_lda(const double * A, double * B, const int N, const int M, const int L, const int LDA) {
     int NB = VALIGN(N);
     if (L == 2) {
         if (M%2) {
             for (int i = 0; i < N; i++)
                 B[i] = A[i];
-            permute(A+N, B+NB, N, M-1, 2);
+            permute_lda(A+LDA, B+NB, N, M-1, 2, LDA);
         } else {
-            permute(A, B, N, M, 2);
+            permute_lda(A, B, N, M, 2, LDA);
         }
     }
     else {
-        permute_tri(A, B, N, M%(2*L), L/2);
-        permute(A+(M%(2*L))*N, B+(M%(2*L))*NB, N, M-M%(2*L), L);
+        permute_tri_lda(A, B, N, M%(2*L), L/2, LDA);
+        permute_lda(A+(M%(2*L))*LDA, B+(M%(2*L))*NB, N, M-M%(2*L), L, LDA);
     }
 }
 
-void permute_t_tri(double * A, const double * B, const int N, const int M, const int L) {
+void permute_t_tri_lda(double * A, const double * B, const int N, const int M, const int L, const int LDA) {
     int NB = VALIGN(N);
     if (L == 2) {
         if (M%2) {
             for (int i = 0; i < N; i++)
                 A[i] = B[i];
-            permute_t(A+N, B+NB, N, M-1, 2);
+            permute_t_lda(A+LDA, B+NB, N, M-1, 2, LDA);
         } else {
-            permute_t(A, B, N, M, 2);
+            permute_t_lda(A, B, N, M, 2, LDA);
         }
     }
     else {
-        permute_t_tri(A, B, N, M%(2*L), L/2);
-        permute_t(A+(M%(2*L))*N, B+(M%(2*L))*NB, N, M-M%(2*L), L);
+        permute_t_tri_lda(A, B, N, M%(2*L), L/2, LDA);
+        permute_t_lda(A+(M%(2*L))*LDA, B+(M%(2*L))*NB, N, M-M%(2*L), L, LDA);
     }
 }
 
@@ -89,14 +91,23 @@ void swap_warp(double * A, double * B, const int N) {
     }
 }
 
-void warp(double * A, const int N, const int M, const int L) {
+// Swaps the leading N x M blocks of two arrays with leading dimension LDA.
+static inline void swap_warp_lda(double * A, double * B, const int N, const int M, const int LDA) {
+    if (LDA == N)
+        swap_warp(A, B, N*M);
+    else
+        for (int j = 0; j < M; j++)
+            swap_warp(A+j*LDA, B+j*LDA, N);
+}
+
+void warp_lda(double * A, const int N, const int M, const int L, const int LDA) {
     for (int j = 2; j <= L; j <<= 1)
         for (int i = M%(4*L); i < M; i += 4*j)
-            swap_warp(A+(i+j)*N, A+(i+j*2)*N, j*N);
+            swap_warp_lda(A+(i+j)*LDA, A+(i+j*2)*LDA, N, j, LDA);
 }
 
-void warp_t(double * A, const int N, const int M, const int L) {
+void warp_t_lda(double * A, const int N, const int M, const int L, const int LDA) {
     for (int j = L; j >= 2; j >>= 1)
         for (int i = M%(4*L); i < M; i += 4*j)
-            swap_warp(A+(i+j)*N, A+(i+j*2)*N, j*N);
+            swap_warp_lda(A+(i+j)*LDA, A+(i+j*2)*LDA, N, j, LDA);
 }
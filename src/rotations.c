@@ -9,6 +9,44 @@ void ft_destroy_rotation_plan(ft_rotation_plan * RP) {
     free(RP);
 }
 
+ft_rotation_plan * ft_view_rotation_plan(const ft_rotation_plan * RP, const int n) {
+    if (n > RP->n) {
+        printf(RED("FastTransforms: ft_view_rotation_plan: a view may not exceed the degree of its plan.")"\n");
+        exit(EXIT_FAILURE);
+    }
+    ft_rotation_plan * RV = malloc(sizeof(ft_rotation_plan));
+    *RV = *RP;
+    RV->n = n;
+    return RV;
+}
+
+void ft_destroy_rotation_plan_view(ft_rotation_plan * RV) {free(RV);}
+
+static ft_rotation_plan * rotation_plan(double * s, double * c, const int n, const size_t length) {
+    ft_rotation_plan * RP = malloc(sizeof(ft_rotation_plan));
+    RP->s = s;
+    RP->c = c;
+    RP->n = RP->ns = n;
+    RP->length = length;
+    return RP;
+}
+
+// Moves the tables of the extension RE into RP.
+// The tables of a plan loaded from a plan file belong to the file, which takes over the new ones.
+static void extend_in_place(ft_rotation_plan * RP, ft_rotation_plan * RE) {
+    ft_plan_file * PF = ft_plan_file_owning(RP);
+    if (PF == NULL) {
+        free(RP->s);
+        free(RP->c);
+    }
+    else {
+        ft_plan_file_own(PF, RE->s, free);
+        ft_plan_file_own(PF, RE->c, free);
+    }
+    *RP = *RE;
+    free(RE);
+}
+
 static inline void apply_givens(const double S, const double C, double * X, double * Y) {
     double x = C*X[0] + S*Y[0];
     double y = C*Y[0] - S*X[0];
@@ -110,137 +148,182 @@ static inline void apply_givens_t(const double S, const double C, double * X, do
     }
 #endif
 
-#define s(l,m) s[l+(m)*(2*n+1-(m))/2]
-#define c(l,m) c[l+(m)*(2*n+1-(m))/2]
+#define s(l,m) s[l+(m)*(2*ns+1-(m))/2]
+#define c(l,m) c[l+(m)*(2*ns+1-(m))/2]
+
+ft_rotation_plan * ft_plan_rotsphere(const int n) {return extend_rotsphere(NULL, n);}
 
-ft_rotation_plan * ft_plan_rotsphere(const int n) {
+// An extension copies the leading entries of every column from the tables of RP, laid out for
+// degree n0, and computes the others. RP may be NULL.
+
+ft_rotation_plan * extend_rotsphere(const ft_rotation_plan * RP, const int n) {
+    int n0 = RP == NULL ? 0 : RP->ns, ns = n;
     double * s = malloc(n*(n+1)/2 * sizeof(double));
     double * c = malloc(n*(n+1)/2 * sizeof(double));
     double nums, numc, den;
-    for (int m = 0; m < n; m++)
-        for (int l = 0; l < n-m; l++) {
+    for (int m = 0; m < n; m++) {
+        if (m < n0) {
+            memcpy(&s(0, m), RP->s+m*(2*n0+1-m)/2, (n0-m)*sizeof(double));
+            memcpy(&c(0, m), RP->c+m*(2*n0+1-m)/2, (n0-m)*sizeof(double));
+        }
+        for (int l = MAX(n0-m, 0); l < n-m; l++) {
             nums = (l+1)*(l+2);
             numc = (2*m+2)*(2*l+2*m+5);
             den = (l+2*m+3)*(l+2*m+4);
             s(l, m) = sqrt(nums/den);
             c(l, m) = sqrt(numc/den);
         }
-    ft_rotation_plan * RP = malloc(sizeof(ft_rotation_plan));
-    RP->s = s;
-    RP->c = c;
-    RP->n = n;
-    return RP;
+    }
+    return rotation_plan(s, c, n, n*(n+1)/2);
+}
+
+void ft_extend_rotsphere(ft_rotation_plan * RP, const int n) {
+    if (n > RP->n)
+        extend_in_place(RP, extend_rotsphere(RP, n));
 }
 
 void ft_kernel_sph_hi2lo(const ft_rotation_plan * RP, const int m, double * A) {
-    int n = RP->n;
+    int n = RP->n, ns = RP->ns;
     for (int j = m-2; j >= 0; j -= 2)
         for (int l = n-3-j; l >= 0; l--)
             apply_givens(RP->s(l, j), RP->c(l, j), A+l, A+l+2);
 }
 
 void ft_kernel_sph_lo2hi(const ft_rotation_plan * RP, const int m, double * A) {
-    int n = RP->n;
+    int n = RP->n, ns = RP->ns;
     for (int j = m%2; j < m-1; j += 2)
         for (int l = 0; l <= n-3-j; l++)
             apply_givens_t(RP->s(l, j), RP->c(l, j), A+l, A+l+2);
 }
 
-void ft_kernel_sph_hi2lo_SSE(const ft_rotation_plan * RP, const int m, double * A) {
-    int n = RP->n;
+// The rotations only couple rows l and l+2, so the rows of either parity form an independent
+// chain. The kernels below rotate the chain l = p (mod 2) if p is 0 or 1, and both if p < 0.
+static inline int chain_last(const int l, const int p) {return p < 0 ? l : l - ((l-p)&1);}
+static inline int chain_first(const int p) {return p < 0 ? 0 : p;}
+static inline int chain_step(const int p) {return p < 0 ? 1 : 2;}
+
+static inline void kernel_sph_hi2lo_SSE(const ft_rotation_plan * RP, const int m, double * A, const int p) {
+    int n = RP->n, ns = RP->ns;
     for (int j = m-2; j >= 0; j -= 2)
-        for (int l = n-3-j; l >= 0; l--)
+        for (int l = chain_last(n-3-j, p); l >= 0; l -= chain_step(p))
             apply_givens_SSE(RP->s(l, j), RP->c(l, j), A+2*l, A+2*(l+2));
 }
 
-void ft_kernel_sph_lo2hi_SSE(const ft_rotation_plan * RP, const int m, double * A) {
-    int n = RP->n;
+static inline void kernel_sph_lo2hi_SSE(const ft_rotation_plan * RP, const int m, double * A, const int p) {
+    int n = RP->n, ns = RP->ns;
     for (int j = m%2; j < m-1; j += 2)
-        for (int l = 0; l <= n-3-j; l++)
+        for (int l = chain_first(p); l <= n-3-j; l += chain_step(p))
             apply_givens_t_SSE(RP->s(l, j), RP->c(l, j), A+2*l, A+2*(l+2));
 }
 
-void ft_kernel_sph_hi2lo_AVX(const ft_rotation_plan * RP, const int m, double * A) {
-    int n = RP->n;
-    for (int l = n-3-m; l >= 0; l--)
+static inline void kernel_sph_hi2lo_AVX(const ft_rotation_plan * RP, const int m, double * A, const int p) {
+    int n = RP->n, ns = RP->ns;
+    for (int l = chain_last(n-3-m, p); l >= 0; l -= chain_step(p))
         apply_givens_SSE(RP->s(l, m), RP->c(l, m), A+4*l+2, A+4*(l+2)+2);
     for (int j = m-2; j >= 0; j -= 2)
-        for (int l = n-3-j; l >= 0; l--)
+        for (int l = chain_last(n-3-j, p); l >= 0; l -= chain_step(p))
             apply_givens_AVX(RP->s(l, j), RP->c(l, j), A+4*l, A+4*(l+2));
 }
 
-void ft_kernel_sph_lo2hi_AVX(const ft_rotation_plan * RP, const int m, double * A) {
-    int n = RP->n;
+static inline void kernel_sph_lo2hi_AVX(const ft_rotation_plan * RP, const int m, double * A, const int p) {
+    int n = RP->n, ns = RP->ns;
     for (int j = m%2; j < m-1; j += 2)
-        for (int l = 0; l <= n-3-j; l++)
+        for (int l = chain_first(p); l <= n-3-j; l += chain_step(p))
             apply_givens_t_AVX(RP->s(l, j), RP->c(l, j), A+4*l, A+4*(l+2));
-    for (int l = 0; l <= n-3-m; l++)
+    for (int l = chain_first(p); l <= n-3-m; l += chain_step(p))
         apply_givens_t_SSE(RP->s(l, m), RP->c(l, m), A+4*l+2, A+4*(l+2)+2);
 }
 
-void ft_kernel_sph_hi2lo_AVX512(const ft_rotation_plan * RP, const int m, double * A) {
-    int n = RP->n;
-    for (int l = n-3-m; l >= 0; l--)
+static inline void kernel_sph_hi2lo_AVX512(const ft_rotation_plan * RP, const int m, double * A, const int p) {
+    int n = RP->n, ns = RP->ns;
+    for (int l = chain_last(n-3-m, p); l >= 0; l -= chain_step(p))
         apply_givens_SSE(RP->s(l, m), RP->c(l, m), A+8*l+2, A+8*(l+2)+2);
-    for (int l = n-7-m; l >= 0; l--)
+    for (int l = chain_last(n-7-m, p); l >= 0; l -= chain_step(p))
         apply_givens_SSE(RP->s(l, m+4), RP->c(l, m+4), A+8*l+6, A+8*(l+2)+6);
     for (int j = m+2; j >= m; j -= 2)
-        for (int l = n-3-j; l >= 0; l--)
+        for (int l = chain_last(n-3-j, p); l >= 0; l -= chain_step(p))
             apply_givens_AVX(RP->s(l, j), RP->c(l, j), A+8*l+4, A+8*(l+2)+4);
     for (int j = m-2; j >= 0; j -= 2)
-        for (int l = n-3-j; l >= 0; l--)
+        for (int l = chain_last(n-3-j, p); l >= 0; l -= chain_step(p))
             apply_givens_AVX512(RP->s(l, j), RP->c(l, j), A+8*l, A+8*(l+2));
 }
 
-void ft_kernel_sph_lo2hi_AVX512(const ft_rotation_plan * RP, const int m, double * A) {
-    int n = RP->n;
+static inline void kernel_sph_lo2hi_AVX512(const ft_rotation_plan * RP, const int m, double * A, const int p) {
+    int n = RP->n, ns = RP->ns;
     for (int j = m%2; j < m-1; j += 2)
-        for (int l = 0; l <= n-3-j; l++)
+        for (int l = chain_first(p); l <= n-3-j; l += chain_step(p))
             apply_givens_t_AVX512(RP->s(l, j), RP->c(l, j), A+8*l, A+8*(l+2));
     for (int j = m; j <= m+2; j += 2)
-        for (int l = 0; l <= n-3-j; l++)
+        for (int l = chain_first(p); l <= n-3-j; l += chain_step(p))
             apply_givens_t_AVX(RP->s(l, j), RP->c(l, j), A+8*l+4, A+8*(l+2)+4);
-    for (int l = 0; l <= n-7-m; l++)
+    for (int l = chain_first(p); l <= n-7-m; l += chain_step(p))
         apply_givens_t_SSE(RP->s(l, m+4), RP->c(l, m+4), A+8*l+6, A+8*(l+2)+6);
-    for (int l = 0; l <= n-3-m; l++)
+    for (int l = chain_first(p); l <= n-3-m; l += chain_step(p))
         apply_givens_t_SSE(RP->s(l, m), RP->c(l, m), A+8*l+2, A+8*(l+2)+2);
 }
 
-ft_rotation_plan * ft_plan_rottriangle(const int n, const double alpha, const double beta, const double gamma) {
+void ft_kernel_sph_hi2lo_SSE(const ft_rotation_plan * RP, const int m, double * A) {kernel_sph_hi2lo_SSE(RP, m, A, -1);}
+void ft_kernel_sph_hi2lo_SSE_parity(const ft_rotation_plan * RP, const int m, double * A, const int p) {kernel_sph_hi2lo_SSE(RP, m, A, p);}
+
+void ft_kernel_sph_lo2hi_SSE(const ft_rotation_plan * RP, const int m, double * A) {kernel_sph_lo2hi_SSE(RP, m, A, -1);}
+void ft_kernel_sph_lo2hi_SSE_parity(const ft_rotation_plan * RP, const int m, double * A, const int p) {kernel_sph_lo2hi_SSE(RP, m, A, p);}
+
+void ft_kernel_sph_hi2lo_AVX(const ft_rotation_plan * RP, const int m, double * A) {kernel_sph_hi2lo_AVX(RP, m, A, -1);}
+void ft_kernel_sph_hi2lo_AVX_parity(const ft_rotation_plan * RP, const int m, double * A, const int p) {kernel_sph_hi2lo_AVX(RP, m, A, p);}
+
+void ft_kernel_sph_lo2hi_AVX(const ft_rotation_plan * RP, const int m, double * A) {kernel_sph_lo2hi_AVX(RP, m, A, -1);}
+void ft_kernel_sph_lo2hi_AVX_parity(const ft_rotation_plan * RP, const int m, double * A, const int p) {kernel_sph_lo2hi_AVX(RP, m, A, p);}
+
+void ft_kernel_sph_hi2lo_AVX512(const ft_rotation_plan * RP, const int m, double * A) {kernel_sph_hi2lo_AVX512(RP, m, A, -1);}
+void ft_kernel_sph_hi2lo_AVX512_parity(const ft_rotation_plan * RP, const int m, double * A, const int p) {kernel_sph_hi2lo_AVX512(RP, m, A, p);}
+
+void ft_kernel_sph_lo2hi_AVX512(const ft_rotation_plan * RP, const int m, double * A) {kernel_sph_lo2hi_AVX512(RP, m, A, -1);}
+void ft_kernel_sph_lo2hi_AVX512_parity(const ft_rotation_plan * RP, const int m, double * A, const int p) {kernel_sph_lo2hi_AVX512(RP, m, A, p);}
+
+ft_rotation_plan * ft_plan_rottriangle(const int n, const double alpha, const double beta, const double gamma) {return extend_rottriangle(NULL, n, alpha, beta, gamma);}
+
+ft_rotation_plan * extend_rottriangle(const ft_rotation_plan * RP, const int n, const double alpha, const double beta, const double gamma) {
+    int n0 = RP == NULL ? 0 : RP->ns, ns = n;
     double * s = malloc(n*(n+1)/2 * sizeof(double));
     double * c = malloc(n*(n+1)/2 * sizeof(double));
     double nums, numc, den;
-    for (int m = 0; m < n; m++)
-        for (int l = 0; l < n-m; l++) {
+    for (int m = 0; m < n; m++) {
+        if (m < n0) {
+            memcpy(&s(0, m), RP->s+m*(2*n0+1-m)/2, (n0-m)*sizeof(double));
+            memcpy(&c(0, m), RP->c+m*(2*n0+1-m)/2, (n0-m)*sizeof(double));
+        }
+        for (int l = MAX(n0-m, 0); l < n-m; l++) {
             nums = (l+1)*(l+alpha+1);
             numc = (2*m+beta+gamma+2)*(2*l+2*m+alpha+beta+gamma+4);
             den = (l+2*m+beta+gamma+3)*(l+2*m+alpha+beta+gamma+3);
             s(l, m) = sqrt(nums/den);
             c(l, m) = sqrt(numc/den);
         }
-    ft_rotation_plan * RP = malloc(sizeof(ft_rotation_plan));
-    RP->s = s;
-    RP->c = c;
-    RP->n = n;
-    return RP;
+    }
+    return rotation_plan(s, c, n, n*(n+1)/2);
+}
+
+void ft_extend_rottriangle(ft_rotation_plan * RP, const int n, const double alpha, const double beta, const double gamma) {
+    if (n > RP->n)
+        extend_in_place(RP, extend_rottriangle(RP, n, alpha, beta, gamma));
 }
 
 void ft_kernel_tri_hi2lo(const ft_rotation_plan * RP, const int m, double * A) {
-    int n = RP->n;
+    int n = RP->n, ns = RP->ns;
     for (int j = m-1; j >= 0; j--)
         for (int l = n-2-j; l >= 0; l--)
             apply_givens(RP->s(l, j), RP->c(l, j), A+l, A+l+1);
 }
 
 void ft_kernel_tri_lo2hi(const ft_rotation_plan * RP, const int m, double * A) {
-    int n = RP->n;
+    int n = RP->n, ns = RP->ns;
     for (int j = 0; j < m; j++)
         for (int l = 0; l <= n-2-j; l++)
             apply_givens_t(RP->s(l, j), RP->c(l, j), A+l, A+l+1);
 }
 
 void ft_kernel_tri_hi2lo_SSE(const ft_rotation_plan * RP, const int m, double * A) {
-    int n = RP->n;
+    int n = RP->n, ns = RP->ns;
     for (int l = n-2-m; l >= 0; l--)
         apply_givens(RP->s(l, m), RP->c(l, m), A+2*l+1, A+2*(l+1)+1);
     for (int j = m-1; j >= 0; j--)
@@ -249,7 +332,7 @@ void ft_kernel_tri_hi2lo_SSE(const ft_rotation_plan * RP, const int m, double *
 }
 
 void ft_kernel_tri_lo2hi_SSE(const ft_rotation_plan * RP, const int m, double * A) {
-    int n = RP->n;
+    int n = RP->n, ns = RP->ns;
     for (int j = 0; j < m; j++)
         for (int l = 0; l <= n-2-j; l++)
             apply_givens_t_SSE(RP->s(l, j), RP->c(l, j), A+2*l, A+2*(l+1));
@@ -258,7 +341,7 @@ void ft_kernel_tri_lo2hi_SSE(const ft_rotation_plan * RP, const int m, double *
 }
 
 void ft_kernel_tri_hi2lo_AVX(const ft_rotation_plan * RP, const int m, double * A) {
-    int n = RP->n;
+    int n = RP->n, ns = RP->ns;
     for (int l = n-2-m; l >= 0; l--)
         apply_givens(RP->s(l, m), RP->c(l, m), A+4*l+1, A+4*(l+1)+1);
     for (int l = n-4-m; l >= 0; l--)
@@ -272,7 +355,7 @@ void ft_kernel_tri_hi2lo_AVX(const ft_rotation_plan * RP, const int m, double *
 }
 
 void ft_kernel_tri_lo2hi_AVX(const ft_rotation_plan * RP, const int m, double * A) {
-    int n = RP->n;
+    int n = RP->n, ns = RP->ns;
     for (int j = 0; j < m; j++)
         for (int l = 0; l <= n-2-j; l++)
             apply_givens_t_AVX(RP->s(l, j), RP->c(l, j), A+4*l, A+4*(l+1));
@@ -286,7 +369,7 @@ void ft_kernel_tri_lo2hi_AVX(const ft_rotation_plan * RP, const int m, double *
 }
 
 void ft_kernel_tri_hi2lo_AVX512(const ft_rotation_plan * RP, const int m, double * A) {
-    int n = RP->n;
+    int n = RP->n, ns = RP->ns;
     for (int l = n-2-m; l >= 0; l--)
         apply_givens(RP->s(l, m), RP->c(l, m), A+8*l+1, A+8*(l+1)+1);
     for (int l = n-4-m; l >= 0; l--)
@@ -310,7 +393,7 @@ void ft_kernel_tri_hi2lo_AVX512(const ft_rotation_plan * RP, const int m, double
 }
 
 void ft_kernel_tri_lo2hi_AVX512(const ft_rotation_plan * RP, const int m, double * A) {
-    int n = RP->n;
+    int n = RP->n, ns = RP->ns;
     for (int j = 0; j < m; j++)
         for (int l = 0; l <= n-2-j; l++)
             apply_givens_t_AVX512(RP->s(l, j), RP->c(l, j), A+8*l, A+8*(l+1));
@@ -336,57 +419,66 @@ void ft_kernel_tri_lo2hi_AVX512(const ft_rotation_plan * RP, const int m, double
 #undef s
 #undef c
 
-#define s(l,m) s[l+(m)*n-(m)/2*((m)+1)/2]
-#define c(l,m) c[l+(m)*n-(m)/2*((m)+1)/2]
+#define s(l,m) s[l+(m)*ns-(m)/2*(((m)+1)/2)]
+#define c(l,m) c[l+(m)*ns-(m)/2*(((m)+1)/2)]
 
-ft_rotation_plan * ft_plan_rotdisk(const int n) {
+ft_rotation_plan * ft_plan_rotdisk(const int n) {return extend_rotdisk(NULL, n);}
+
+ft_rotation_plan * extend_rotdisk(const ft_rotation_plan * RP, const int n) {
+    int n0 = RP == NULL ? 0 : RP->ns, ns = n;
     double * s = malloc(n*n * sizeof(double));
     double * c = malloc(n*n * sizeof(double));
     double numc, den;
-    for (int m = 0; m < 2*n-1; m++)
-        for (int l = 0; l < n-(m+1)/2; l++) {
+    for (int m = 0; m < 2*n-1; m++) {
+        if (m < 2*n0-1) {
+            memcpy(&s(0, m), RP->s+m*n0-m/2*((m+1)/2), (n0-(m+1)/2)*sizeof(double));
+            memcpy(&c(0, m), RP->c+m*n0-m/2*((m+1)/2), (n0-(m+1)/2)*sizeof(double));
+        }
+        for (int l = MAX(n0-(m+1)/2, 0); l < n-(m+1)/2; l++) {
             numc = (m+1)*(2*l+m+3);
             den = (l+m+2)*(l+m+2);
             s(l, m) = -((double) (l+1))/((double) (l+m+2));
             c(l, m) = sqrt(numc/den);
         }
-    ft_rotation_plan * RP = malloc(sizeof(ft_rotation_plan));
-    RP->s = s;
-    RP->c = c;
-    RP->n = n;
-    return RP;
+    }
+    return rotation_plan(s, c, n, n*n);
+}
+
+void ft_extend_rotdisk(ft_rotation_plan * RP, const int n) {
+    if (n > RP->n)
+        extend_in_place(RP, extend_rotdisk(RP, n));
 }
 
 void ft_kernel_disk_hi2lo(const ft_rotation_plan * RP, const int m, double * A) {
-    int n = RP->n;
+    int n = RP->n, ns = RP->ns;
     for (int j = m-2; j >= 0; j -= 2)
         for (int l = n-2-(j+1)/2; l >= 0; l--)
             apply_givens(RP->s(l, j), RP->c(l, j), A+l, A+l+1);
 }
 
 void ft_kernel_disk_lo2hi(const ft_rotation_plan * RP, const int m, double * A) {
-    int n = RP->n;
+    int n = RP->n, ns = RP->ns;
     for (int j = m%2; j < m-1; j += 2)
         for (int l = 0; l <= n-2-(j+1)/2; l++)
             apply_givens_t(RP->s(l, j), RP->c(l, j), A+l, A+l+1);
 }
 
 void ft_kernel_disk_hi2lo_SSE(const ft_rotation_plan * RP, const int m, double * A) {
-    int n = RP->n;
+    int n = RP->n, ns = RP->ns;
     for (int j = m-2; j >= 0; j -= 2)
         for (int l = n-2-(j+1)/2; l >= 0; l--)
             apply_givens_SSE(RP->s(l, j), RP->c(l, j), A+2*l, A+2*(l+1));
 }
 
 void ft_kernel_disk_lo2hi_SSE(const ft_rotation_plan * RP, const int m, double * A) {
-    int n = RP->n;
+    int n = RP->n, ns = RP->ns;
     for (int j = m%2; j < m-1; j += 2)
         for (int l = 0; l <= n-2-(j+1)/2; l++)
             apply_givens_t_SSE(RP->s(l, j), RP->c(l, j), A+2*l, A+2*(l+1));
 }
 
 void ft_kernel_disk_hi2lo_AVX(const ft_rotation_plan * RP, const int m, double * A) {
-    int n = RP->n;
+    int n = RP->n, ns = RP->ns;
     for (int l = n-2-(m+1)/2; l >= 0; l--)
         apply_givens_SSE(RP->s(l, m), RP->c(l, m), A+4*l+2, A+4*(l+1)+2);
     for (int j = m-2; j >= 0; j -= 2)
@@ -395,7 +487,7 @@ void ft_kernel_disk_hi2lo_AVX(const ft_rotation_plan * RP, const int m, double *
 }
 
 void ft_kernel_disk_lo2hi_AVX(const ft_rotation_plan * RP, const int m, double * A) {
-    int n = RP->n;
+    int n = RP->n, ns = RP->ns;
     for (int j = m%2; j < m-1; j += 2)
         for (int l = 0; l <= n-2-(j+1)/2; l++)
             apply_givens_t_AVX(RP->s(l, j), RP->c(l, j), A+4*l, A+4*(l+1));
@@ -404,7 +496,7 @@ void ft_kernel_disk_lo2hi_AVX(const ft_rotation_plan * RP, const int m, double *
 }
 
 void ft_kernel_disk_hi2lo_AVX512(const ft_rotation_plan * RP, const int m, double * A) {
-    int n = RP->n;
+    int n = RP->n, ns = RP->ns;
     for (int l = n-2-(m+1)/2; l >= 0; l--)
         apply_givens_SSE(RP->s(l, m), RP->c(l, m), A+8*l+2, A+8*(l+1)+2);
     for (int l = n-4-(m+1)/2; l >= 0; l--)
@@ -418,7 +510,7 @@ void ft_kernel_disk_hi2lo_AVX512(const ft_rotation_plan * RP, const int m, doubl
 }
 
 void ft_kernel_disk_lo2hi_AVX512(const ft_rotation_plan * RP, const int m, double * A) {
-    int n = RP->n;
+    int n = RP->n, ns = RP->ns;
     for (int j = m%2; j < m-1; j += 2)
         for (int l = 0; l <= n-2-(j+1)/2; l++)
             apply_givens_t_AVX512(RP->s(l, j), RP->c(l, j), A+8*l, A+8*(l+1));
@@ -434,11 +526,11 @@ void ft_kernel_disk_lo2hi_AVX512(const ft_rotation_plan * RP, const int m, doubl
 #undef s
 #undef c
 
-#define s(l,m) s[l+(m)*(2*n+1-(m))/2]
-#define c(l,m) c[l+(m)*(2*n+1-(m))/2]
+#define s(l,m) s[l+(m)*(2*ns+1-(m))/2]
+#define c(l,m) c[l+(m)*(2*ns+1-(m))/2]
 
 void ft_kernel_tet_hi2lo(const ft_rotation_plan * RP, const int L, const int m, double * A) {
-    int n = RP->n;
+    int n = RP->n, ns = RP->ns;
     double s, c;
     for (int j = m-1; j >= 0; j--) {
         for (int l = L-2-j; l >= 0; l--) {
@@ -451,7 +543,7 @@ void ft_kernel_tet_hi2lo(const ft_rotation_plan * RP, const int L, const int m,
 }
 
 void ft_kernel_tet_lo2hi(const ft_rotation_plan * RP, const int L, const int m, double * A) {
-    int n = RP->n;
+    int n = RP->n, ns = RP->ns;
     double s, c;
     for (int j = 0; j < m; j++) {
         for (int l = 0; l <= L-2-j; l++) {
@@ -464,7 +556,7 @@ void ft_kernel_tet_lo2hi(const ft_rotation_plan * RP, const int L, const int m,
 }
 
 void ft_kernel_tet_hi2lo_SSE(const ft_rotation_plan * RP, const int L, const int m, double * A) {
-    int n = RP->n;
+    int n = RP->n, ns = RP->ns;
     int nb = VALIGN(n);
     double s, c;
     for (int j = m-1; j >= 0; j--) {
@@ -480,7 +572,7 @@ void ft_kernel_tet_hi2lo_SSE(const ft_rotation_plan * RP, const int L, const int
 }
 
 void ft_kernel_tet_lo2hi_SSE(const ft_rotation_plan * RP, const int L, const int m, double * A) {
-    int n = RP->n;
+    int n = RP->n, ns = RP->ns;
     int nb = VALIGN(n);
     double s, c;
     for (int j = 0; j < m; j++) {
@@ -496,7 +588,7 @@ void ft_kernel_tet_lo2hi_SSE(const ft_rotation_plan * RP, const int L, const int
 }
 
 void ft_kernel_tet_hi2lo_AVX(const ft_rotation_plan * RP, const int L, const int m, double * A) {
-    int n = RP->n;
+    int n = RP->n, ns = RP->ns;
     int nb = VALIGN(n);
     double s, c;
     for (int j = m-1; j >= 0; j--) {
@@ -514,7 +606,7 @@ void ft_kernel_tet_hi2lo_AVX(const ft_rotation_plan * RP, const int L, const int
 }
 
 void ft_kernel_tet_lo2hi_AVX(const ft_rotation_plan * RP, const int L, const int m, double * A) {
-    int n = RP->n;
+    int n = RP->n, ns = RP->ns;
     int nb = VALIGN(n);
     double s, c;
     for (int j = 0; j < m; j++) {
@@ -532,40 +624,52 @@ void ft_kernel_tet_lo2hi_AVX(const ft_rotation_plan * RP, const int L, const int
 }
 
 void ft_kernel_tet_hi2lo_AVX512(const ft_rotation_plan * RP, const int L, const int m, double * A) {
-    int n = RP->n;
+    ft_kernel_tet_hi2lo_AVX512_rows(RP, L, m, A, 0, RP->n);
+}
+
+void ft_kernel_tet_lo2hi_AVX512(const ft_rotation_plan * RP, const int L, const int m, double * A) {
+    ft_kernel_tet_lo2hi_AVX512_rows(RP, L, m, A, 0, RP->n);
+}
+
+// The rotations act on each row independently, so rows k0 <= k < k1 may be processed
+// concurrently with other row ranges. k0 must be a multiple of 8.
+void ft_kernel_tet_hi2lo_AVX512_rows(const ft_rotation_plan * RP, const int L, const int m, double * A, const int k0, const int k1) {
+    int n = RP->n, ns = RP->ns;
     int nb = VALIGN(n);
+    int r = k1-k0;
     double s, c;
     for (int j = m-1; j >= 0; j--) {
         for (int l = L-2-j; l >= 0; l--) {
             s = RP->s(l, j);
             c = RP->c(l, j);
-            for (int k = 0; k < n-n%8; k += 8)
+            for (int k = k0; k < k1-r%8; k += 8)
                 apply_givens_AVX512(s, c, A+k+nb*l, A+k+nb*(l+1));
-            for (int k = n-n%8; k < n-n%4; k += 4)
+            for (int k = k1-r%8; k < k1-r%4; k += 4)
                 apply_givens_AVX(s, c, A+k+nb*l, A+k+nb*(l+1));
-            for (int k = n-n%4; k < n-n%2; k += 2)
+            for (int k = k1-r%4; k < k1-r%2; k += 2)
                 apply_givens_SSE(s, c, A+k+nb*l, A+k+nb*(l+1));
-            for (int k = n-n%2; k < n; k++)
+            for (int k = k1-r%2; k < k1; k++)
                 apply_givens(s, c, A+k+nb*l, A+k+nb*(l+1));
         }
     }
 }
 
-void ft_kernel_tet_lo2hi_AVX512(const ft_rotation_plan * RP, const int L, const int m, double * A) {
-    int n = RP->n;
+void ft_kernel_tet_lo2hi_AVX512_rows(const ft_rotation_plan * RP, const int L, const int m, double * A, const int k0, const int k1) {
+    int n = RP->n, ns = RP->ns;
     int nb = VALIGN(n);
+    int r = k1-k0;
     double s, c;
     for (int j = 0; j < m; j++) {
         for (int l = 0; l <= L-2-j; l++) {
             s = RP->s(l, j);
             c = RP->c(l, j);
-            for (int k = 0; k < n-n%8; k += 8)
+            for (int k = k0; k < k1-r%8; k += 8)
                 apply_givens_t_AVX512(s, c, A+k+nb*l, A+k+nb*(l+1));
-            for (int k = n-n%8; k < n-n%4; k += 4)
+            for (int k = k1-r%8; k < k1-r%4; k += 4)
                 apply_givens_t_AVX(s, c, A+k+nb*l, A+k+nb*(l+1));
-            for (int k = n-n%4; k < n-n%2; k += 2)
+            for (int k = k1-r%4; k < k1-r%2; k += 2)
                 apply_givens_t_SSE(s, c, A+k+nb*l, A+k+nb*(l+1));
-            for (int k = n-n%2; k < n; k++)
+            for (int k = k1-r%2; k < k1; k++)
                 apply_givens_t(s, c, A+k+nb*l, A+k+nb*(l+1));
         }
     }
@@ -0,0 +1,301 @@
+// Binary plan files that may be mapped read-only into memory.
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <float.h>
+#ifdef _WIN32
+    #include <sys/stat.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#endif
+#include "fasttransforms.h"
+#include "ftinternal.h"
+
+/*
+A plan file is a 64-byte header followed by the arrays and the nodes of one plan, in the byte
+order of the machine that wrote it. Every node is a sequence of int64_t fields: integers, and the
+offsets of its arrays and child nodes from the start of the file, with 0 standing for NULL. The
+nodes are written after their children and the header holds the offset of the root. Arrays are
+aligned to 64 bytes so that a mapped file may be used in place, and only the per-thread
+workspaces of a loaded plan are allocated.
+*/
+
+#define FT_PLAN_FILE_MAGIC "FTPLAN\0\0"
+#define FT_PLAN_FILE_ENDIAN 0x01020304
+#define FT_PLAN_FILE_ALIGN 64
+
+typedef struct {
+    char magic[8];
+    uint32_t endian;
+    uint32_t version;
+    uint32_t kind;
+    uint32_t fltsize;
+    double eps;
+    int64_t size;
+    int64_t root;
+    char pad[16];
+} ft_plan_header;
+
+struct ft_planfilestruct {
+    char * base;
+    size_t size;
+    void ** allocations;
+    void (**deallocators)(void *);
+    int nallocations;
+    int capacity;
+    struct ft_planfilestruct * next;
+};
+
+// The open plan files, so that a plan can be recognized as one that a file owns.
+static ft_plan_file * ft_open_plan_files = NULL;
+
+int ft_plan_writer_open(ft_plan_writer * W, const char * filename, const int kind, const size_t fltsize, const double eps) {
+    ft_plan_header H;
+    memset(&H, 0, sizeof(ft_plan_header));
+    memcpy(H.magic, FT_PLAN_FILE_MAGIC, 8);
+    H.endian = FT_PLAN_FILE_ENDIAN;
+    H.version = FT_PLAN_FILE_VERSION;
+    H.kind = kind;
+    H.fltsize = fltsize;
+    H.eps = eps;
+    W->fp = fopen(filename, "wb");
+    W->offset = 0;
+    W->failed = W->fp == NULL;
+    if (W->failed) {
+        printf(RED("FastTransforms: cannot open %s for writing.")"\n", filename);
+        return -1;
+    }
+    ft_plan_write(W, &H, sizeof(ft_plan_header), 1);
+    return W->failed ? -1 : 0;
+}
+
+int64_t ft_plan_write(ft_plan_writer * W, const void * data, const size_t bytes, const size_t align) {
+    static const char zeros[FT_PLAN_FILE_ALIGN] = {0};
+    if (data == NULL || W->failed)
+        return 0;
+    size_t pad = (align - W->offset%align)%align;
+    if (fwrite(zeros, 1, pad, W->fp) != pad || fwrite(data, 1, bytes, W->fp) != bytes) {
+        W->failed = 1;
+        return 0;
+    }
+    int64_t offset = W->offset + pad;
+    W->offset = offset + bytes;
+    return offset;
+}
+
+int64_t ft_plan_write_array(ft_plan_writer * W, const void * data, const size_t bytes) {return ft_plan_write(W, data, bytes, FT_PLAN_FILE_ALIGN);}
+
+int64_t ft_plan_write_node(ft_plan_writer * W, const int64_t * fields, const int count) {return ft_plan_write(W, fields, count*sizeof(int64_t), sizeof(int64_t));}
+
+int ft_plan_writer_close(ft_plan_writer * W, const int64_t root) {
+    if (W->fp == NULL)
+        return -1;
+    if (!W->failed) {
+        int64_t trailer[2] = {W->offset, root};
+        W->failed = fseek(W->fp, offsetof(ft_plan_header, size), SEEK_SET) != 0 || fwrite(trailer, sizeof(int64_t), 2, W->fp) != 2;
+    }
+    W->failed |= fclose(W->fp) != 0;
+    W->fp = NULL;
+    if (W->failed)
+        printf(RED("FastTransforms: failed to write a plan file.")"\n");
+    return W->failed ? -1 : 0;
+}
+
+ft_plan_file * ft_open_plan_file(const char * filename) {
+    char * base = NULL;
+    size_t size = 0;
+#ifdef _WIN32
+    FILE * fp = fopen(filename, "rb");
+    struct stat st;
+    if (fp != NULL && stat(filename, &st) == 0 && st.st_size >= (off_t) sizeof(ft_plan_header)) {
+        size = st.st_size;
+        base = malloc(size);
+        if (fread(base, 1, size, fp) != size) {
+            free(base);
+            base = NULL;
+        }
+    }
+    if (fp != NULL)
+        fclose(fp);
+#else
+    int fd = open(filename, O_RDONLY);
+    struct stat st;
+    if (fd >= 0 && fstat(fd, &st) == 0 && st.st_size >= (off_t) sizeof(ft_plan_header)) {
+        size = st.st_size;
+        base = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+        if (base == MAP_FAILED)
+            base = NULL;
+    }
+    if (fd >= 0)
+        close(fd);
+#endif
+    if (base == NULL) {
+        printf(RED("FastTransforms: cannot read the plan file %s.")"\n", filename);
+        return NULL;
+    }
+    ft_plan_file * PF = malloc(sizeof(ft_plan_file));
+    PF->base = base;
+    PF->size = size;
+    PF->allocations = NULL;
+    PF->deallocators = NULL;
+    PF->nallocations = PF->capacity = 0;
+    #pragma omp critical(ft_open_plan_files)
+    {
+        PF->next = ft_open_plan_files;
+        ft_open_plan_files = PF;
+    }
+    const ft_plan_header * H = (const ft_plan_header *) base;
+    const char * error = NULL;
+    if (memcmp(H->magic, FT_PLAN_FILE_MAGIC, 8) != 0)
+        error = "is not a plan file";
+    else if (H->endian != FT_PLAN_FILE_ENDIAN)
+        error = "was written with another byte order";
+    else if (H->version != FT_PLAN_FILE_VERSION)
+        error = "was written by another version of the format";
+    else if (H->size != (int64_t) size || H->root <= 0 || H->root >= H->size)
+        error = "is truncated";
+    if (error != NULL) {
+        printf(RED("FastTransforms: %s %s.")"\n", filename, error);
+        ft_close_plan_file(PF);
+        return NULL;
+    }
+    return PF;
+}
+
+void ft_close_plan_file(ft_plan_file * PF) {
+    #pragma omp critical(ft_open_plan_files)
+    for (ft_plan_file ** Q = &ft_open_plan_files; *Q != NULL; Q = &(*Q)->next)
+        if (*Q == PF) {
+            *Q = PF->next;
+            break;
+        }
+    for (int k = PF->nallocations-1; k >= 0; k--)
+        PF->deallocators[k](PF->allocations[k]);
+    free(PF->allocations);
+    free(PF->deallocators);
+#ifdef _WIN32
+    free(PF->base);
+#else
+    munmap(PF->base, PF->size);
+#endif
+    free(PF);
+}
+
+const int64_t * ft_plan_file_root(const ft_plan_file * PF, const int kind, const size_t fltsize, const double eps) {
+    const ft_plan_header * H = (const ft_plan_header *) PF->base;
+    if (H->kind != (uint32_t) kind || H->fltsize != fltsize || H->eps != eps) {
+        printf(RED("FastTransforms: the plan file holds another kind or precision of plan.")"\n");
+        return NULL;
+    }
+    return ft_plan_file_at(PF, H->root);
+}
+
+void * ft_plan_file_at(const ft_plan_file * PF, const int64_t offset) {return offset == 0 ? NULL : PF->base + offset;}
+
+void * ft_plan_file_own(ft_plan_file * PF, void * data, void (*deallocate)(void * data)) {
+    if (PF->nallocations == PF->capacity) {
+        PF->capacity = 2*PF->capacity + 16;
+        PF->allocations = realloc(PF->allocations, PF->capacity*sizeof(void *));
+        PF->deallocators = realloc(PF->deallocators, PF->capacity*sizeof(void (*)(void *)));
+    }
+    PF->allocations[PF->nallocations] = data;
+    PF->deallocators[PF->nallocations++] = deallocate;
+    return data;
+}
+
+void * ft_plan_file_calloc(ft_plan_file * PF, const size_t count, const size_t size) {return ft_plan_file_own(PF, calloc(count, size), free);}
+
+ft_plan_file * ft_plan_file_owning(const void * data) {
+    ft_plan_file * owner = NULL;
+    #pragma omp critical(ft_open_plan_files)
+    for (ft_plan_file * PF = ft_open_plan_files; PF != NULL && owner == NULL; PF = PF->next)
+        for (int k = 0; k < PF->nallocations; k++)
+            if (PF->allocations[k] == data) {
+                owner = PF;
+                break;
+            }
+    return owner;
+}
+
+// A loaded harmonic plan may release or replace its workspace by streaming, so the file frees
+// whichever workspace the plan holds when it is closed.
+static void destroy_harmonic_workspace(void * P) {VFREE(((ft_harmonic_plan *) P)->B);}
+
+int64_t ft_write_rotation_plan(ft_plan_writer * W, const ft_rotation_plan * RP) {
+    if (RP == NULL)
+        return 0;
+    int64_t node[5] = {RP->n, RP->ns, RP->length, ft_plan_write_array(W, RP->s, RP->length*sizeof(double)), ft_plan_write_array(W, RP->c, RP->length*sizeof(double))};
+    return ft_plan_write_node(W, node, 5);
+}
+
+ft_rotation_plan * ft_read_rotation_plan(ft_plan_file * PF, const int64_t * node) {
+    if (node == NULL)
+        return NULL;
+    ft_rotation_plan * RP = ft_plan_file_calloc(PF, 1, sizeof(ft_rotation_plan));
+    RP->n = node[0];
+    RP->ns = node[1];
+    RP->length = node[2];
+    RP->s = ft_plan_file_at(PF, node[3]);
+    RP->c = ft_plan_file_at(PF, node[4]);
+    return RP;
+}
+
+int ft_save_rotation_plan(const ft_rotation_plan * RP, const char * filename) {
+    ft_plan_writer W;
+    if (ft_plan_writer_open(&W, filename, FT_PLAN_FILE_ROTATION, sizeof(double), DBL_EPSILON))
+        return -1;
+    return ft_plan_writer_close(&W, ft_write_rotation_plan(&W, RP));
+}
+
+ft_rotation_plan * ft_load_rotation_plan(ft_plan_file * PF) {
+    const int64_t * node = ft_plan_file_root(PF, FT_PLAN_FILE_ROTATION, sizeof(double), DBL_EPSILON);
+    return ft_read_rotation_plan(PF, node);
+}
+
+int ft_save_harmonic_plan(const ft_harmonic_plan * P, const char * filename) {
+    ft_plan_writer W;
+    if (ft_plan_writer_open(&W, filename, FT_PLAN_FILE_HARMONIC, sizeof(double), DBL_EPSILON))
+        return -1;
+    size_t bytes = packed_size(P->RP->ns)*sizeof(double);
+    double parameters[3] = {P->alpha, P->beta, P->gamma};
+    int64_t node[10] = {
+        ft_write_rotation_plan(&W, P->RP),
+        ft_plan_write_array(&W, P->P1, bytes),
+        ft_plan_write_array(&W, P->P2, bytes),
+        ft_plan_write_array(&W, P->P1inv, bytes),
+        ft_plan_write_array(&W, P->P2inv, bytes),
+        ft_write_tb_eigen_FMM(&W, P->F1),
+        ft_write_tb_eigen_FMM(&W, P->F2),
+        ft_plan_write_array(&W, parameters, sizeof(parameters)),
+        P->nthreads,
+        P->lwork
+    };
+    return ft_plan_writer_close(&W, ft_plan_write_node(&W, node, 10));
+}
+
+ft_harmonic_plan * ft_load_harmonic_plan(ft_plan_file * PF) {
+    const int64_t * node = ft_plan_file_root(PF, FT_PLAN_FILE_HARMONIC, sizeof(double), DBL_EPSILON);
+    if (node == NULL)
+        return NULL;
+    ft_harmonic_plan * P = ft_plan_file_calloc(PF, 1, sizeof(ft_harmonic_plan));
+    const double * parameters = ft_plan_file_at(PF, node[7]);
+    P->RP = ft_read_rotation_plan(PF, ft_plan_file_at(PF, node[0]));
+    P->P1 = ft_plan_file_at(PF, node[1]);
+    P->P2 = ft_plan_file_at(PF, node[2]);
+    P->P1inv = ft_plan_file_at(PF, node[3]);
+    P->P2inv = ft_plan_file_at(PF, node[4]);
+    P->F1 = ft_read_tb_eigen_FMM(PF, ft_plan_file_at(PF, node[5]));
+    P->F2 = ft_read_tb_eigen_FMM(PF, ft_plan_file_at(PF, node[6]));
+    P->alpha = parameters[0];
+    P->beta = parameters[1];
+    P->gamma = parameters[2];
+    P->nthreads = node[8];
+    P->lwork = node[9];
+    P->B = VMALLOC(P->lwork*sizeof(double));
+    ft_plan_file_own(PF, P, destroy_harmonic_workspace);
+    return P;
+}
@@ -0,0 +1,218 @@
+// Plan files of the factorizations, in the layout described in serialize.c.
+
+static int64_t X(write_densematrix)(ft_plan_writer * W, X(densematrix) * A) {
+    int64_t node[3] = {A->m, A->n, ft_plan_write_array(W, A->A, sizeof(FLT)*A->m*A->n)};
+    return ft_plan_write_node(W, node, 3);
+}
+
+static X(densematrix) * X(read_densematrix)(ft_plan_file * PF, const int64_t * node) {
+    X(densematrix) * A = ft_plan_file_calloc(PF, 1, sizeof(X(densematrix)));
+    A->m = node[0];
+    A->n = node[1];
+    A->A = ft_plan_file_at(PF, node[2]);
+    return A;
+}
+
+static int64_t X(write_lowrankmatrix)(ft_plan_writer * W, X(lowrankmatrix) * L) {
+    size_t r = L->r, sz = L->N == '2' ? r : L->N == '3' ? r*r : 0;
+    int64_t node[7] = {L->m, L->n, L->r, L->N, ft_plan_write_array(W, L->U, sizeof(FLT)*L->m*r), ft_plan_write_array(W, L->S, sizeof(FLT)*sz), ft_plan_write_array(W, L->V, sizeof(FLT)*L->n*r)};
+    return ft_plan_write_node(W, node, 7);
+}
+
+// lrmm reallocates the workspaces t1 and t2 to fit its block of columns, so they are released
+// with the block rather than tracked on their own.
+static void X(free_lowrankmatrix_temps)(void * data) {
+    X(lowrankmatrix) * L = data;
+    free(L->t1);
+    free(L->t2);
+    free(L);
+}
+
+static X(lowrankmatrix) * X(read_lowrankmatrix)(ft_plan_file * PF, const int64_t * node) {
+    X(lowrankmatrix) * L = ft_plan_file_own(PF, calloc(1, sizeof(X(lowrankmatrix))), X(free_lowrankmatrix_temps));
+    L->m = node[0];
+    L->n = node[1];
+    L->r = node[2];
+    L->N = node[3];
+    L->U = ft_plan_file_at(PF, node[4]);
+    L->S = ft_plan_file_at(PF, node[5]);
+    L->V = ft_plan_file_at(PF, node[6]);
+    L->t1 = calloc(L->r*FT_GET_MAX_THREADS(), sizeof(FLT));
+    L->t2 = calloc(L->r*FT_GET_MAX_THREADS(), sizeof(FLT));
+    L->p = FT_GET_MAX_THREADS();
+    return L;
+}
+
+static int64_t X(write_hierarchicalmatrix)(ft_plan_writer * W, X(hierarchicalmatrix) * H) {
+    int M = H->M, N = H->N;
+    int64_t * blocks = calloc(M*N, sizeof(int64_t));
+    for (int n = 0; n < N; n++)
+        for (int m = 0; m < M; m++)
+            switch (H->hash(m, n)) {
+                case 1: blocks[m+n*M] = X(write_hierarchicalmatrix)(W, H->hierarchicalmatrices(m, n)); break;
+                case 2: blocks[m+n*M] = X(write_densematrix)(W, H->densematrices(m, n)); break;
+                case 3: blocks[m+n*M] = X(write_lowrankmatrix)(W, H->lowrankmatrices(m, n)); break;
+            }
+    int64_t node[6] = {M, N, H->m, H->n, ft_plan_write_array(W, H->hash, M*N*sizeof(int)), ft_plan_write_node(W, blocks, M*N)};
+    free(blocks);
+    return ft_plan_write_node(W, node, 6);
+}
+
+static X(hierarchicalmatrix) * X(read_hierarchicalmatrix)(ft_plan_file * PF, const int64_t * node) {
+    X(hierarchicalmatrix) * H = ft_plan_file_calloc(PF, 1, sizeof(X(hierarchicalmatrix)));
+    int M = H->M = node[0], N = H->N = node[1];
+    H->m = node[2];
+    H->n = node[3];
+    H->hash = ft_plan_file_at(PF, node[4]);
+    const int64_t * blocks = ft_plan_file_at(PF, node[5]);
+    H->hierarchicalmatrices = ft_plan_file_calloc(PF, M*N, sizeof(X(hierarchicalmatrix) *));
+    H->densematrices = ft_plan_file_calloc(PF, M*N, sizeof(X(densematrix) *));
+    H->lowrankmatrices = ft_plan_file_calloc(PF, M*N, sizeof(X(lowrankmatrix) *));
+    for (int n = 0; n < N; n++)
+        for (int m = 0; m < M; m++)
+            switch (H->hash(m, n)) {
+                case 1: H->hierarchicalmatrices(m, n) = X(read_hierarchicalmatrix)(PF, ft_plan_file_at(PF, blocks[m+n*M])); break;
+                case 2: H->densematrices(m, n) = X(read_densematrix)(PF, ft_plan_file_at(PF, blocks[m+n*M])); break;
+                case 3: H->lowrankmatrices(m, n) = X(read_lowrankmatrix)(PF, ft_plan_file_at(PF, blocks[m+n*M])); break;
+            }
+    return H;
+}
+
+// A banded plan is stored as its data in the last slot and nothing else.
+int64_t X(write_tb_eigen_FMM)(ft_plan_writer * W, X(tb_eigen_FMM) * F) {
+    if (F == NULL)
+        return 0;
+    int n = F->n, s = n>>1, b = F->b;
+    int64_t node[10] = {n, b, 0, 0, 0, 0, 0, 0, 0, 0};
+    if (F->T != NULL)
+        node[9] = ft_plan_write_array(W, F->T->data, sizeof(FLT)*n*(b+1));
+    else if (n < TB_EIGEN_BLOCKSIZE) {
+        node[2] = ft_plan_write_array(W, F->lambda, sizeof(FLT)*n);
+        node[3] = ft_plan_write_array(W, F->V, sizeof(FLT)*n*n);
+    }
+    else {
+        node[2] = ft_plan_write_array(W, F->lambda, sizeof(FLT)*n);
+        node[4] = X(write_hierarchicalmatrix)(W, F->F0);
+        node[5] = X(write_tb_eigen_FMM)(W, F->F1);
+        node[6] = X(write_tb_eigen_FMM)(W, F->F2);
+        node[7] = ft_plan_write_array(W, F->X, sizeof(FLT)*s*b);
+        node[8] = ft_plan_write_array(W, F->Y, sizeof(FLT)*(n-s)*b);
+    }
+    return ft_plan_write_node(W, node, 10);
+}
+
+X(tb_eigen_FMM) * X(read_tb_eigen_FMM)(ft_plan_file * PF, const int64_t * node) {
+    if (node == NULL)
+        return NULL;
+    X(tb_eigen_FMM) * F = ft_plan_file_calloc(PF, 1, sizeof(X(tb_eigen_FMM)));
+    int n = F->n = node[0], s = n>>1;
+    F->b = node[1];
+    if (node[9]) {
+        F->T = ft_plan_file_calloc(PF, 1, sizeof(X(triangular_banded)));
+        F->T->data = ft_plan_file_at(PF, node[9]);
+        F->T->n = n;
+        F->T->b = F->b;
+        return F;
+    }
+    F->lambda = ft_plan_file_at(PF, node[2]);
+    if (n < TB_EIGEN_BLOCKSIZE)
+        F->V = ft_plan_file_at(PF, node[3]);
+    else {
+        F->F0 = X(read_hierarchicalmatrix)(PF, ft_plan_file_at(PF, node[4]));
+        F->F1 = X(read_tb_eigen_FMM)(PF, ft_plan_file_at(PF, node[5]));
+        F->F2 = X(read_tb_eigen_FMM)(PF, ft_plan_file_at(PF, node[6]));
+        F->X = ft_plan_file_at(PF, node[7]);
+        F->Y = ft_plan_file_at(PF, node[8]);
+        F->t1 = ft_plan_file_calloc(PF, s*FT_GET_MAX_THREADS(), sizeof(FLT));
+        F->t2 = ft_plan_file_calloc(PF, (n-s)*FT_GET_MAX_THREADS(), sizeof(FLT));
+    }
+    return F;
+}
+
+static int64_t X(write_symmetric_dpr1_eigen)(ft_plan_writer * W, X(symmetric_dpr1_eigen) * F) {
+    size_t n = F->n, iz = F->iz, id = F->id;
+    int64_t node[10] = {
+        n, iz, id,
+        ft_plan_write_array(W, F->v, sizeof(FLT)*id),
+        ft_plan_write_array(W, F->V, sizeof(FLT)*(n-iz)*(n-iz-id)),
+        ft_plan_write_array(W, F->lambda, sizeof(FLT)*n),
+        ft_plan_write_array(W, F->lambdalo, sizeof(FLT)*n),
+        ft_plan_write_array(W, F->lambdahi, sizeof(FLT)*n),
+        ft_plan_write_array(W, F->p, sizeof(int)*n),
+        ft_plan_write_array(W, F->q, sizeof(int)*n)
+    };
+    return ft_plan_write_node(W, node, 10);
+}
+
+static X(symmetric_dpr1_eigen) * X(read_symmetric_dpr1_eigen)(ft_plan_file * PF, const int64_t * node) {
+    X(symmetric_dpr1_eigen) * F = ft_plan_file_calloc(PF, 1, sizeof(X(symmetric_dpr1_eigen)));
+    F->n = node[0];
+    F->iz = node[1];
+    F->id = node[2];
+    F->v = ft_plan_file_at(PF, node[3]);
+    F->V = ft_plan_file_at(PF, node[4]);
+    F->lambda = ft_plan_file_at(PF, node[5]);
+    F->lambdalo = ft_plan_file_at(PF, node[6]);
+    F->lambdahi = ft_plan_file_at(PF, node[7]);
+    // perm marks the permutations as it applies them, so they are copied out of the file.
+    F->p = ft_plan_file_calloc(PF, F->n, sizeof(int));
+    F->q = ft_plan_file_calloc(PF, F->n, sizeof(int));
+    memcpy(F->p, ft_plan_file_at(PF, node[8]), F->n*sizeof(int));
+    memcpy(F->q, ft_plan_file_at(PF, node[9]), F->n*sizeof(int));
+    return F;
+}
+
+static int64_t X(write_tdc_eigen)(ft_plan_writer * W, X(tdc_eigen) * F) {
+    int n = F->n;
+    int64_t node[6] = {n, 0, 0, 0, 0, 0};
+    if (n < TDC_EIGEN_BLOCKSIZE) {
+        node[1] = ft_plan_write_array(W, F->V, sizeof(FLT)*n*n);
+        node[2] = ft_plan_write_array(W, F->lambda, sizeof(FLT)*n);
+    }
+    else {
+        node[3] = X(write_symmetric_dpr1_eigen)(W, F->F0);
+        node[4] = X(write_tdc_eigen)(W, F->F1);
+        node[5] = X(write_tdc_eigen)(W, F->F2);
+    }
+    return ft_plan_write_node(W, node, 6);
+}
+
+static X(tdc_eigen) * X(read_tdc_eigen)(ft_plan_file * PF, const int64_t * node) {
+    X(tdc_eigen) * F = ft_plan_file_calloc(PF, 1, sizeof(X(tdc_eigen)));
+    F->n = node[0];
+    if (F->n < TDC_EIGEN_BLOCKSIZE) {
+        F->V = ft_plan_file_at(PF, node[1]);
+        F->lambda = ft_plan_file_at(PF, node[2]);
+    }
+    else {
+        F->F0 = X(read_symmetric_dpr1_eigen)(PF, ft_plan_file_at(PF, node[3]));
+        F->F1 = X(read_tdc_eigen)(PF, ft_plan_file_at(PF, node[4]));
+        F->F2 = X(read_tdc_eigen)(PF, ft_plan_file_at(PF, node[5]));
+        // z is the workspace of tdmv.
+        F->z = ft_plan_file_calloc(PF, F->n, sizeof(FLT));
+    }
+    return F;
+}
+
+int X(save_tb_eigen_FMM)(X(tb_eigen_FMM) * F, const char * filename) {
+    ft_plan_writer W;
+    if (ft_plan_writer_open(&W, filename, FT_PLAN_FILE_TB_EIGEN_FMM, sizeof(FLT), Y(eps)()))
+        return -1;
+    return ft_plan_writer_close(&W, X(write_tb_eigen_FMM)(&W, F));
+}
+
+X(tb_eigen_FMM) * X(load_tb_eigen_FMM)(ft_plan_file * PF) {
+    return X(read_tb_eigen_FMM)(PF, ft_plan_file_root(PF, FT_PLAN_FILE_TB_EIGEN_FMM, sizeof(FLT), Y(eps)()));
+}
+
+int X(save_tdc_eigen)(X(tdc_eigen) * F, const char * filename) {
+    ft_plan_writer W;
+    if (ft_plan_writer_open(&W, filename, FT_PLAN_FILE_TDC_EIGEN, sizeof(FLT), Y(eps)()))
+        return -1;
+    return ft_plan_writer_close(&W, X(write_tdc_eigen)(&W, F));
+}
+
+X(tdc_eigen) * X(load_tdc_eigen)(ft_plan_file * PF) {
+    const int64_t * node = ft_plan_file_root(PF, FT_PLAN_FILE_TDC_EIGEN, sizeof(FLT), Y(eps)());
+    return node == NULL ? NULL : X(read_tdc_eigen)(PF, node);
+}
@@ -0,0 +1,6 @@
+// A loaded factorization belongs to its plan file, and is neither scaled nor destroyed.
+
+int X(save_tb_eigen_FMM)(X(tb_eigen_FMM) * F, const char * filename);
+X(tb_eigen_FMM) * X(load_tb_eigen_FMM)(ft_plan_file * PF);
+int X(save_tdc_eigen)(X(tdc_eigen) * F, const char * filename);
+X(tdc_eigen) * X(load_tdc_eigen)(ft_plan_file * PF);
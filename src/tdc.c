@@ -3,36 +3,61 @@
 
 #define TB_EIGEN_BLOCKSIZE 128
 #define TDC_EIGEN_BLOCKSIZE 128
+#define FT_BATCH_MIN 2
+#define FT_BATCH_BLOCK 64
+#define BLOCKRANK_TOL(tol) MAX(2*((int) floor(-log(tol)/2.271667761226165)), 2)
 
 #define FLT quadruple
 #define X(name) FT_CONCAT(ft_, name, q)
 #define Y(name) FT_CONCAT(, name, q)
-#define BLOCKRANK 2*((int) floor(-log(Y(eps)())/2.271667761226165))
+#define BLOCKRANK BLOCKRANK_TOL(Y(eps)())
 #define BLOCKSIZE 4*BLOCKRANK
 #include "tridiagonal_source.c"
 #include "hierarchical_source.c"
 #include "banded_source.c"
 #include "dprk_source.c"
 #include "tdc_source.c"
+#include "serialize_source.c"
 #undef FLT
 #undef X
 #undef Y
 #undef BLOCKRANK
 #undef BLOCKSIZE
 
+#define FLT quadruple
+#define X(name) FT_CONCAT(ft_, name, dd)
+#define Y(name) FT_CONCAT(, name, q)
+#define BLOCKRANK BLOCKRANK_TOL(Y(eps)())
+#define BLOCKSIZE 4*BLOCKRANK
+#define FT_USE_DDOUBLE
+#include "tridiagonal_source.c"
+#include "hierarchical_source.c"
+#include "banded_source.c"
+#include "dprk_source.c"
+#include "tdc_source.c"
+#undef FLT
+#undef X
+#undef Y
+#undef BLOCKRANK
+#undef BLOCKSIZE
+#undef FT_USE_DDOUBLE
+
 #define FLT long double
+#define FLT2 quadruple
 #define X(name) FT_CONCAT(ft_, name, l)
-#define X2(name) FT_CONCAT(ft_, name, q)
+#define X2(name) FT_CONCAT(ft_, name, dd)
 #define Y(name) FT_CONCAT(, name, l)
-#define BLOCKRANK 2*((int) floor(-log(Y(eps)())/2.271667761226165))
+#define BLOCKRANK BLOCKRANK_TOL(Y(eps)())
 #define BLOCKSIZE 4*BLOCKRANK
 #include "tridiagonal_source.c"
 #include "hierarchical_source.c"
 #include "banded_source.c"
 #include "dprk_source.c"
 #include "tdc_source.c"
+#include "serialize_source.c"
 #include "drop_precision.c"
 #undef FLT
+#undef FLT2
 #undef X
 #undef X2
 #undef Y
@@ -40,10 +65,11 @@
 #undef BLOCKSIZE
 
 #define FLT double
+#define FLT2 long double
 #define X(name) FT_CONCAT(ft_, name, )
 #define X2(name) FT_CONCAT(ft_, name, l)
 #define Y(name) FT_CONCAT(, name, )
-#define BLOCKRANK 2*((int) floor(-log(Y(eps)())/2.271667761226165))
+#define BLOCKRANK BLOCKRANK_TOL(Y(eps)())
 #define BLOCKSIZE 4*BLOCKRANK
 #define FT_USE_CBLAS_D
 #include "tridiagonal_source.c"
@@ -51,8 +77,10 @@
 #include "banded_source.c"
 #include "dprk_source.c"
 #include "tdc_source.c"
+#include "serialize_source.c"
 #include "drop_precision.c"
 #undef FLT
+#undef FLT2
 #undef X
 #undef X2
 #undef Y
@@ -61,10 +89,11 @@
 #undef FT_USE_CBLAS_D
 
 #define FLT float
+#define FLT2 double
 #define X(name) FT_CONCAT(ft_, name, f)
 #define X2(name) FT_CONCAT(ft_, name, )
 #define Y(name) FT_CONCAT(, name, f)
-#define BLOCKRANK 2*((int) floor(-log(Y(eps)())/2.271667761226165))
+#define BLOCKRANK BLOCKRANK_TOL(Y(eps)())
 #define BLOCKSIZE 4*BLOCKRANK
 #define FT_USE_CBLAS_S
 #include "tridiagonal_source.c"
@@ -72,8 +101,10 @@
 #include "banded_source.c"
 #include "dprk_source.c"
 #include "tdc_source.c"
+#include "serialize_source.c"
 #include "drop_precision.c"
 #undef FLT
+#undef FLT2
 #undef X
 #undef X2
 #undef Y
@@ -81,5 +112,6 @@
 #undef BLOCKSIZE
 #undef FT_USE_CBLAS_S
 
+#undef BLOCKRANK_TOL
 #undef TB_EIGEN_BLOCKSIZE
 #undef TDC_EIGEN_BLOCKSIZE
@@ -11,6 +11,9 @@ typedef struct {
     int stop;
 } unitrange;
 
+// A binary plan file opened by ft_open_plan_file.
+typedef struct ft_planfilestruct ft_plan_file;
+
 #define hash(m,n) hash[(m)+(n)*M]
 #define hierarchicalmatrices(m,n) hierarchicalmatrices[(m)+(n)*M]
 #define densematrices(m,n) densematrices[(m)+(n)*M]
@@ -24,19 +27,34 @@ typedef struct {
 #include "banded_source.h"
 #include "dprk_source.h"
 #include "tdc_source.h"
+#include "serialize_source.h"
+#undef FLT
+#undef X
+#undef Y
+
+// The quadruple-precision stage of long double plans, computed in double-double arithmetic.
+#define FLT __float128
+#define X(name) FT_CONCAT(ft_, name, dd)
+#define Y(name) FT_CONCAT(, name, q)
+#include "tridiagonal_source.h"
+#include "hierarchical_source.h"
+#include "banded_source.h"
+#include "dprk_source.h"
+#include "tdc_source.h"
 #undef FLT
 #undef X
 #undef Y
 
 #define FLT long double
 #define X(name) FT_CONCAT(ft_, name, l)
-#define X2(name) FT_CONCAT(ft_, name, q)
+#define X2(name) FT_CONCAT(ft_, name, dd)
 #define Y(name) FT_CONCAT(, name, l)
 #include "tridiagonal_source.h"
 #include "hierarchical_source.h"
 #include "banded_source.h"
 #include "dprk_source.h"
 #include "tdc_source.h"
+#include "serialize_source.h"
 #include "drop_precision.h"
 #undef FLT
 #undef X
@@ -52,6 +70,7 @@ typedef struct {
 #include "banded_source.h"
 #include "dprk_source.h"
 #include "tdc_source.h"
+#include "serialize_source.h"
 #include "drop_precision.h"
 #undef FLT
 #undef X
@@ -67,6 +86,7 @@ typedef struct {
 #include "banded_source.h"
 #include "dprk_source.h"
 #include "tdc_source.h"
+#include "serialize_source.h"
 #include "drop_precision.h"
 #undef FLT
 #undef X
@@ -0,0 +1,425 @@
+// Toeplitz-Hankel plans for the Legendre-Chebyshev connections at large degrees.
+
+#include "fasttransforms.h"
+#include "ftinternal.h"
+
+// In either parity p, the connection coefficients between indices 2i+p and 2j+p ≥ 2i+p are
+// scaled entries of T∘H, where T(j-i) is an upper-triangular Toeplitz matrix and H is the Hankel
+// matrix of
+//
+//     g(t) = 1/Γ(β+1) ∫_0^∞ e^{-ut}(1-e^{-u})^β du, t = i+j+p+s₀,
+//
+// which is Λ(t-1/2) = Γ(t)/Γ(t+1/2) for β = -1/2 and Λ(t-1/2)/(t+1/2) for β = 1/2. The
+// trapezoidal rule in log u turns g into a sum of exponentials, so that T∘H is a sum of
+// D_q T D_q with D_q = diag(e^{-u_q i}) and each T is applied by FFTs. The nodes that are smooth
+// over all t are replaced by a few Gaussian ones, and those that only matter for t < TH_DENSE are
+// dropped, the entries there being corrected densely. Only O(log n log 1/ε) nodes are kept, and
+// the plan is the FFTs of the Toeplitz symbols: there is no O(n²) or hierarchical precomputation.
+
+#define TH_STEP 0.25L      // Step in log u, exact in binary so that the nodes are exponentials of exact abscissae.
+#define TH_LOG 40.0L       // e^{-TH_LOG} is negligible.
+#define TH_SMOOTH 32.0L    // Nodes with u*t_max below this are smooth in t ...
+#define TH_GAUSS 16        // ... and replaced by this many Gaussian nodes.
+#define TH_DENSE 1024      // Entries with i+j < TH_DENSE are corrected densely.
+#define TH_BLOCK 256       // Block size of the exponentials e^{-u i}.
+
+typedef struct {
+    fftw_complex ** T; // The FFTs of the Toeplitz symbol, per level.
+    double * t;        // Its first TH_DENSE entries.
+    double * u;        // The nodes.
+    double * e;        // e^{-u i} for 0 ≤ i < TH_BLOCK, per node.
+    double * E;        // e^{-u b} for the multiples b of TH_BLOCK below m, per node from jE.
+    int * jE;
+    double * w;        // The weights, per parity, including the 1/N of the inverse FFT.
+    int * m;           // The lengths beyond which e^{-u i} is negligible.
+    int * level;       // The FFT levels that hold them.
+    double * c;        // g less its sum of exponentials for i+j < TH_DENSE, per parity.
+    double * s;        // The row scaling.
+    int r;
+} ft_th_term;
+
+struct ft_thstruct {
+    ft_th_term K[2];
+    double * c;        // The column scaling.
+    double * d;        // The diagonal, if it is not in the terms.
+    fftw_plan * forward;
+    fftw_plan * backward;
+    int * N;           // FFT lengths of the levels.
+    double * work;     // The scratch of ft_thmv.
+    int L;
+    int nterms;
+    int n;
+};
+
+// Λ(z) = Γ(z+1/2)/Γ(z+1), by its asymptotic series in w = z+1/4 for large z.
+static long double th_lambda(const long double z) {
+    if (z < 32)
+        return tgammal(z+0.5L)/tgammal(z+1);
+    long double w = z+0.25L, w2 = 1/(w*w);
+    return (1 + w2*(-1.0L/64 + w2*(21.0L/8192 + w2*(-671.0L/524288 + w2*180323.0L/134217728))))/sqrtl(w);
+}
+
+static long double th_hankel(const long double t, const long double beta) {
+    return beta < 0 ? th_lambda(t-0.5L) : th_lambda(t-0.5L)/(t+0.5L);
+}
+
+// The smallest 7-smooth integer no less than n.
+static int th_good_size(const int n) {
+    for (int m = MAX(n, 1);; m++) {
+        int k = m;
+        for (int p = 2; p < 8; p++)
+            while (k % p == 0)
+                k /= p;
+        if (k == 1)
+            return m;
+    }
+}
+
+// Nodes u and weights w of g to relative accuracy for t_min ≤ t ≤ t_max; returns their number.
+static int th_nodes(const long double beta, const long double tmin, const long double tmax, long double ** u, long double ** w) {
+    long double h = TH_STEP, b1 = beta+1, gb = tgammal(b1);
+    int klo = floorl((logl(b1*expl(-TH_LOG)) - b1*logl(tmax))/(b1*h)) - 1;
+    int khi = ceill(logl(TH_LOG/tmin)/h);
+    int nk = MAX(khi-klo+1, 0), ns = 0, r = 0;
+    long double * uk = malloc(nk*sizeof(long double));
+    long double * wk = malloc(nk*sizeof(long double));
+    for (int k = 0; k < nk; k++) {
+        uk[k] = expl((klo+k)*h);
+        wk[k] = h*uk[k]*powl(-expm1l(-uk[k]), beta)/gb;
+        if (uk[k]*tmax <= TH_SMOOTH)
+            ns++;
+    }
+    int G = MIN(TH_GAUSS, ns);
+    *u = malloc((G+nk-ns)*sizeof(long double));
+    *w = malloc((G+nk-ns)*sizeof(long double));
+    // The Gaussian nodes of the discrete measure of the smooth nodes, by Lanczos with full
+    // reorthogonalization on diag(u) and the Golub-Welsch eigenproblem.
+    if (G > 0) {
+        long double * Q = calloc(ns*(G+1), sizeof(long double));
+        ft_symmetric_tridiagonall * J = malloc(sizeof(ft_symmetric_tridiagonall));
+        J->a = calloc(G, sizeof(long double));
+        J->b = calloc(G, sizeof(long double));
+        J->n = G;
+        long double nrm = 0;
+        for (int k = 0; k < ns; k++)
+            nrm += wk[k];
+        for (int k = 0; k < ns; k++)
+            Q[k] = sqrtl(wk[k]/nrm);
+        for (int l = 0; l < G; l++) {
+            long double * q = Q+l*ns, * v = Q+(l+1)*ns;
+            for (int k = 0; k < ns; k++)
+                v[k] = uk[k]*q[k];
+            for (int i = 0; i <= l; i++) {
+                long double dot = 0;
+                for (int k = 0; k < ns; k++)
+                    dot += Q[k+i*ns]*v[k];
+                for (int k = 0; k < ns; k++)
+                    v[k] -= dot*Q[k+i*ns];
+                if (i == l)
+                    J->a[l] += dot;
+            }
+            long double bl = 0;
+            for (int k = 0; k < ns; k++)
+                bl += v[k]*v[k];
+            bl = sqrtl(bl);
+            if (l < G-1)
+                J->b[l] = bl;
+            for (int k = 0; k < ns; k++)
+                v[k] /= bl;
+        }
+        long double * V = calloc(G*G, sizeof(long double));
+        for (int i = 0; i < G; i++)
+            V[i+i*G] = 1;
+        ft_symmetric_tridiagonal_eigl(J, V, *u);
+        for (int i = 0; i < G; i++)
+            (*w)[i] = nrm*V[i*G]*V[i*G];
+        r = G;
+        free(V);
+        free(Q);
+        ft_destroy_symmetric_tridiagonall(J);
+    }
+    for (int k = ns; k < nk; k++) {
+        (*u)[r] = uk[k];
+        (*w)[r++] = wk[k];
+    }
+    free(uk);
+    free(wk);
+    return r;
+}
+
+static void * th_malloc(const size_t bytes) {
+    void * p = fftw_malloc(MAX(bytes, 1));
+    if (p == NULL) {
+        printf(RED("FastTransforms: toeplitz_hankel: cannot allocate %zu bytes.")"\n", bytes);
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+// ell[i] = e^{-u i} for 0 ≤ i < m ≤ K->m[q] at the node u = K->u[q], from the exponentials of
+// the plan with two roundings each, so that no exponential is computed in ft_thmv.
+static void th_exponentials(const ft_th_term * K, const int q, const int m, double * ell) {
+    const double * e = K->e+q*TH_BLOCK, * E = K->E+K->jE[q];
+    #pragma omp parallel for
+    for (int b = 0; b < m; b += TH_BLOCK)
+        for (int i = b; i < MIN(m, b+TH_BLOCK); i++)
+            ell[i] = E[b/TH_BLOCK]*e[i-b];
+}
+
+// A term with the Toeplitz symbol t of length n0 = ⌈n/2⌉, the Hankel function of β with offset s₀,
+// and the row scaling s, which it takes over.
+static void th_term(ft_toeplitz_hankel_plan * P, ft_th_term * K, double * t, const long double beta, const long double s0, double * s) {
+    int n = P->n, n0 = (n+1)/2, T0 = MIN(TH_DENSE, 2*n0-1);
+    K->s = s;
+    K->t = calloc(TH_DENSE, sizeof(double));
+    for (int i = 0; i < MIN(n0, TH_DENSE); i++)
+        K->t[i] = t[i];
+    K->T = malloc(P->L*sizeof(fftw_complex *));
+    double * buf = fftw_malloc(P->N[0]*sizeof(double));
+    for (int l = 0; l < P->L; l++) {
+        int N = P->N[l];
+        K->T[l] = fftw_malloc((N/2+1)*sizeof(fftw_complex));
+        for (int i = 0; i < N; i++)
+            buf[i] = 0;
+        for (int i = 0; i < MIN(n0, N/2); i++)
+            buf[i] = t[i];
+        fftw_execute_dft_r2c(P->forward[l], buf, K->T[l]);
+    }
+    fftw_free(buf);
+    free(t);
+    // The exponentials are needed for t ≥ T0 only, and not at all if every entry is corrected.
+    long double * u = NULL, * w = NULL;
+    long double tmin = T0+s0, tmax = 2*n0+s0;
+    K->r = T0 < 2*n0-1 ? th_nodes(beta, tmin, tmax, &u, &w) : 0;
+    K->u = malloc(K->r*sizeof(double));
+    K->w = malloc(2*K->r*sizeof(double));
+    K->m = malloc(K->r*sizeof(int));
+    K->level = malloc(K->r*sizeof(int));
+    K->jE = malloc((K->r+1)*sizeof(int));
+    K->jE[0] = 0;
+    for (int q = 0; q < K->r; q++) {
+        K->u[q] = u[q];
+        K->m[q] = MIN(n0, MAX(T0, (int) ceill(TH_LOG/u[q])));
+        int l = 0;
+        while (l+1 < P->L && P->N[l+1] >= 2*K->m[q]-1)
+            l++;
+        K->level[q] = l;
+        for (int p = 0; p < 2; p++)
+            K->w[q+p*K->r] = w[q]*expl(-u[q]*(p+s0))/P->N[l];
+        K->jE[q+1] = K->jE[q] + (K->m[q]+TH_BLOCK-1)/TH_BLOCK;
+    }
+    K->e = th_malloc(K->r*TH_BLOCK*sizeof(double));
+    K->E = th_malloc(K->jE[K->r]*sizeof(double));
+    for (int q = 0; q < K->r; q++) {
+        double uq = K->u[q];
+        for (int i = 0; i < TH_BLOCK; i++)
+            K->e[i+q*TH_BLOCK] = exp(-uq*i);
+        for (int b = 0; b < K->m[q]; b += TH_BLOCK)
+            K->E[K->jE[q]+b/TH_BLOCK] = exp(-uq*b);
+    }
+    K->c = calloc(2*TH_DENSE, sizeof(double));
+    for (int p = 0; p < 2; p++)
+        for (int i = 0; i < T0; i++) {
+            long double ti = i+p+s0, g = ti > 0 ? th_hankel(ti, beta) : 0;
+            for (int q = 0; q < K->r; q++)
+                g -= w[q]*expl(-u[q]*ti);
+            K->c[i+p*TH_DENSE] = ti > 0 ? g : 0;
+        }
+    free(u);
+    free(w);
+}
+
+// The FFT levels halve the window down to TH_DENSE.
+static ft_toeplitz_hankel_plan * th_plan(const int n) {
+    ft_toeplitz_hankel_plan * P = calloc(1, sizeof(ft_toeplitz_hankel_plan));
+    int n0 = (n+1)/2;
+    P->n = n;
+    P->L = 1;
+    while ((n0 >> P->L) >= TH_DENSE)
+        P->L++;
+    P->N = malloc(P->L*sizeof(int));
+    P->forward = malloc(P->L*sizeof(fftw_plan));
+    P->backward = malloc(P->L*sizeof(fftw_plan));
+    for (int l = 0; l < P->L; l++)
+        P->N[l] = th_good_size(2*((n0 + (1<<l) - 1) >> l));
+    double * buf = fftw_malloc(P->N[0]*sizeof(double));
+    fftw_complex * hat = fftw_malloc((P->N[0]/2+1)*sizeof(fftw_complex));
+    // Measuring the plans of these long transforms costs far more than it saves.
+    for (int l = 0; l < P->L; l++) {
+        P->forward[l] = fftw_plan_dft_r2c_1d(P->N[l], buf, hat, FFTW_ESTIMATE | FFTW_DESTROY_INPUT);
+        P->backward[l] = fftw_plan_dft_c2r_1d(P->N[l], hat, buf, FFTW_ESTIMATE | FFTW_DESTROY_INPUT);
+    }
+    fftw_free(buf);
+    fftw_free(hat);
+    P->work = th_malloc(ft_work_size_toeplitz_hankel_plan(P)*sizeof(double));
+    return P;
+}
+
+ft_toeplitz_hankel_plan * ft_plan_legendre_to_chebyshev_th(const int normleg, const int normcheb, const int n) {
+    ft_toeplitz_hankel_plan * P = th_plan(n);
+    int n0 = (n+1)/2;
+    double * t = malloc(n0*sizeof(double));
+    for (int i = 0; i < n0; i++)
+        t[i] = th_lambda(i);
+    double * s = malloc(n*sizeof(double));
+    P->c = malloc(n*sizeof(double));
+    for (int i = 0; i < n; i++) {
+        s[i] = (normcheb ? i ? sqrt(M_PI_2) : M_SQRT_PI : 1.0)*(i ? M_2_PI : M_1_PI);
+        P->c[i] = normleg ? sqrt(i+0.5) : 1.0;
+    }
+    P->nterms = 1;
+    th_term(P, P->K, t, -0.5L, 0.5L, s);
+    return P;
+}
+
+ft_toeplitz_hankel_plan * ft_plan_chebyshev_to_legendre_th(const int normcheb, const int normleg, const int n) {
+    ft_toeplitz_hankel_plan * P = th_plan(n);
+    int n0 = (n+1)/2;
+    double * tA = calloc(n0, sizeof(double));
+    double * tB = calloc(n0, sizeof(double));
+    for (int i = 1; i < n0; i++) {
+        long double v = th_lambda(i-1);
+        tA[i] = v/i;
+        tB[i] = v;
+    }
+    double * sA = malloc(n*sizeof(double));
+    double * sB = malloc(n*sizeof(double));
+    P->c = malloc(n*sizeof(double));
+    P->d = malloc(n*sizeof(double));
+    for (int i = 0; i < n; i++) {
+        double sclrow = normleg ? 1.0/sqrt(i+0.5) : 1.0;
+        P->c[i] = normcheb ? i ? sqrt(M_2_PI) : sqrt(M_1_PI) : 1.0;
+        sA[i] = -sclrow*i/4;
+        sB[i] = -sclrow*(i+1)/4;
+        P->d[i] = sclrow*(i ? M_SQRT_PI/(2*th_lambda(i)) : 1.0)*P->c[i];
+    }
+    P->nterms = 2;
+    th_term(P, P->K, tA, -0.5L, 0.0L, sA);
+    th_term(P, P->K+1, tB, 0.5L, 0.0L, sB);
+    return P;
+}
+
+void ft_destroy_toeplitz_hankel_plan(ft_toeplitz_hankel_plan * P) {
+    for (int k = 0; k < P->nterms; k++) {
+        ft_th_term * K = P->K+k;
+        for (int l = 0; l < P->L; l++)
+            fftw_free(K->T[l]);
+        free(K->T);
+        free(K->t);
+        free(K->u);
+        fftw_free(K->e);
+        fftw_free(K->E);
+        free(K->jE);
+        free(K->w);
+        free(K->m);
+        free(K->level);
+        free(K->c);
+        free(K->s);
+    }
+    for (int l = 0; l < P->L; l++) {
+        fftw_destroy_plan(P->forward[l]);
+        fftw_destroy_plan(P->backward[l]);
+    }
+    free(P->forward);
+    free(P->backward);
+    free(P->N);
+    fftw_free(P->work);
+    free(P->c);
+    free(P->d);
+    free(P);
+}
+
+size_t ft_summary_size_toeplitz_hankel_plan(ft_toeplitz_hankel_plan * P) {
+    size_t S = sizeof(double)*(P->n*(P->d == NULL ? 1 : 2) + ft_work_size_toeplitz_hankel_plan(P));
+    for (int k = 0; k < P->nterms; k++) {
+        ft_th_term * K = P->K+k;
+        S += sizeof(double)*(P->n + 3*TH_DENSE + (3+TH_BLOCK)*K->r + K->jE[K->r]) + sizeof(int)*(3*K->r+1);
+        for (int l = 0; l < P->L; l++)
+            S += sizeof(fftw_complex)*(P->N[l]/2+1);
+    }
+    return S;
+}
+
+// The FFT buffers come first in the scratch, and the spectrum is padded to 64 bytes so that both
+// are aligned as the buffers the FFTs were planned with.
+size_t ft_work_size_toeplitz_hankel_plan(const ft_toeplitz_hankel_plan * P) {
+    size_t N = P->N[0], n = P->n, n0 = (n+1)/2;
+    return (N+7)/8*8 + 2*(N/2+1) + n + 3*n0;
+}
+
+void ft_thmv(char TRANS, ft_toeplitz_hankel_plan * P, double * x) {
+    ft_thmv_work(TRANS, P, x, P->work);
+}
+
+// x ← A*x, x ← Aᵀ*x. In each parity, A is upper-triangular, its products are correlations with the
+// Toeplitz symbol, and those of Aᵀ are convolutions. The window of a node is reversed for the former.
+void ft_thmv_work(char TRANS, ft_toeplitz_hankel_plan * P, double * x, double * w) {
+    int n = P->n, n0 = (n+1)/2, T0 = MIN(TH_DENSE, 2*n0-1);
+    if (fftw_alignment_of(w) != fftw_alignment_of(P->work)) {
+        printf(RED("FastTransforms: thmv_work: the scratch is not aligned as by fftw_malloc.")"\n");
+        exit(EXIT_FAILURE);
+    }
+    double * buf = w;
+    fftw_complex * hat = (fftw_complex *) (w+(P->N[0]+7)/8*8);
+    double * y = (double *) (hat+P->N[0]/2+1);
+    double * z = y+n, * acc = z+n0, * ell = acc+n0;
+    for (int i = 0; i < n; i++)
+        y[i] = 0;
+    for (int k = 0; k < P->nterms; k++) {
+        ft_th_term * K = P->K+k;
+        for (int p = 0; p < 2; p++) {
+            int np = (n-p+1)/2;
+            for (int i = 0; i < np; i++) {
+                z[i] = (TRANS == 'N' ? P->c[2*i+p] : K->s[2*i+p])*x[2*i+p];
+                acc[i] = 0;
+            }
+            for (int q = 0; q < K->r; q++) {
+                int l = K->level[q], m = MIN(np, K->m[q]), N = P->N[l];
+                double wq = K->w[q+p*K->r];
+                th_exponentials(K, q, m, ell);
+                if (TRANS == 'N')
+                    for (int i = 0; i < m; i++)
+                        buf[i] = ell[m-1-i]*z[m-1-i];
+                else
+                    for (int i = 0; i < m; i++)
+                        buf[i] = ell[i]*z[i];
+                for (int i = m; i < N; i++)
+                    buf[i] = 0;
+                fftw_execute_dft_r2c(P->forward[l], buf, hat);
+                fftw_complex * T = K->T[l];
+                for (int i = 0; i < N/2+1; i++) {
+                    double re = hat[i][0]*T[i][0] - hat[i][1]*T[i][1];
+                    double im = hat[i][0]*T[i][1] + hat[i][1]*T[i][0];
+                    hat[i][0] = re;
+                    hat[i][1] = im;
+                }
+                fftw_execute_dft_c2r(P->backward[l], hat, buf);
+                if (TRANS == 'N')
+                    for (int i = 0; i < m; i++)
+                        acc[i] += wq*ell[i]*buf[m-1-i];
+                else
+                    for (int i = 0; i < m; i++)
+                        acc[i] += wq*ell[i]*buf[i];
+            }
+            double * c = K->c+p*TH_DENSE;
+            for (int i = 0; i < MIN(np, T0); i++)
+                for (int j = i; j < MIN(np, T0-i); j++) {
+                    if (TRANS == 'N')
+                        acc[i] += K->t[j-i]*c[i+j]*z[j];
+                    else
+                        acc[j] += K->t[j-i]*c[i+j]*z[i];
+                }
+            for (int i = 0; i < np; i++)
+                y[2*i+p] += (TRANS == 'N' ? K->s[2*i+p] : P->c[2*i+p])*acc[i];
+        }
+    }
+    for (int i = 0; i < n; i++)
+        x[i] = P->d == NULL ? y[i] : y[i] + P->d[i]*x[i];
+}
+
+#undef TH_STEP
+#undef TH_LOG
+#undef TH_SMOOTH
+#undef TH_GAUSS
+#undef TH_DENSE
+#undef TH_BLOCK
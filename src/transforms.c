@@ -3,21 +3,27 @@
 #include "fasttransforms.h"
 #include "ftinternal.h"
 
+// Integer shifts with at most this bandwidth are planned as banded products, not FMMs.
+#define BANDED_CONNECTION_MAX_BANDWIDTH 32
+
 #define FLT long double
 #define FLT2 quadruple
 #define X(name) FT_CONCAT(ft_, name, l)
-#define X2(name) FT_CONCAT(ft_, name, q)
+#define Y(name) FT_CONCAT(, name, l)
+#define X2(name) FT_CONCAT(ft_, name, dd)
 #define Y2(name) FT_CONCAT(, name, q)
 #include "transforms_source.c"
 #undef FLT
 #undef FLT2
 #undef X
 #undef X2
+#undef Y
 #undef Y2
 
 #define FLT double
 #define FLT2 long double
 #define X(name) FT_CONCAT(ft_, name, )
+#define Y(name) FT_CONCAT(, name, )
 #define X2(name) FT_CONCAT(ft_, name, l)
 #define Y2(name) FT_CONCAT(, name, l)
 #include "transforms_source.c"
@@ -25,11 +31,13 @@
 #undef FLT2
 #undef X
 #undef X2
+#undef Y
 #undef Y2
 
 #define FLT float
 #define FLT2 double
 #define X(name) FT_CONCAT(ft_, name, f)
+#define Y(name) FT_CONCAT(, name, f)
 #define X2(name) FT_CONCAT(ft_, name, )
 #define Y2(name) FT_CONCAT(, name, )
 #include "transforms_source.c"
@@ -37,9 +45,16 @@
 #undef FLT2
 #undef X
 #undef X2
+#undef Y
 #undef Y2
 
+#undef BANDED_CONNECTION_MAX_BANDWIDTH
+
 double * plan_legendre_to_chebyshev(const int normleg, const int normcheb, const int n) {
+    return plan_legendre_to_chebyshev_columns(normleg, normcheb, n, 0);
+}
+
+double * plan_legendre_to_chebyshev_columns(const int normleg, const int normcheb, const int n, const int j0) {
     ft_triangular_bandedl * A = ft_create_A_legendre_to_chebyshevl(n);
     ft_triangular_bandedl * B = ft_create_B_legendre_to_chebyshevl(n);
     long double * Vl = calloc(n*n, sizeof(long double));
@@ -49,7 +64,7 @@ double * plan_legendre_to_chebyshev(const int normleg, const int normcheb, const
         Vl[1+n] = 1;
     for (int i = 2; i < n; i++)
         Vl[i+i*n] = (2*i-1)*Vl[i-1+(i-1)*n]/(2*i);
-    ft_triangular_banded_eigenvectorsl(A, B, Vl);
+    ft_triangular_banded_eigenvectors_columnsl(A, B, Vl, j0);
     double * V = calloc(n*n, sizeof(double));
     long double * sclrow = malloc(n*sizeof(long double));
     long double * sclcol = malloc(n*sizeof(long double));
@@ -57,7 +72,7 @@ double * plan_legendre_to_chebyshev(const int normleg, const int normcheb, const
         sclrow[i] = normcheb ? i ? sqrtl(M_PI_2l) : sqrtl(M_PIl) : 1.0L;
         sclcol[i] = normleg ? sqrtl(i+0.5L) : 1.0L;
     }
-    for (int j = 0; j < n; j++)
+    for (int j = j0; j < n; j++)
         for (int i = j; i >= 0; i -= 2)
             V[i+j*n] = sclrow[i]*Vl[i+j*n]*sclcol[j];
     ft_destroy_triangular_bandedl(A);
@@ -69,6 +84,10 @@ double * plan_legendre_to_chebyshev(const int normleg, const int normcheb, const
 }
 
 double * plan_chebyshev_to_legendre(const int normcheb, const int normleg, const int n) {
+    return plan_chebyshev_to_legendre_columns(normcheb, normleg, n, 0);
+}
+
+double * plan_chebyshev_to_legendre_columns(const int normcheb, const int normleg, const int n, const int j0) {
     ft_triangular_bandedl * A = ft_create_A_chebyshev_to_legendrel(n);
     ft_triangular_bandedl * B = ft_create_B_chebyshev_to_legendrel(n);
     long double * Vl = calloc(n*n, sizeof(long double));
@@ -78,7 +97,7 @@ double * plan_chebyshev_to_legendre(const int normcheb, const int normleg, const
         Vl[1+n] = 1;
     for (int i = 2; i < n; i++)
         Vl[i+i*n] = (2*i)*Vl[i-1+(i-1)*n]/(2*i-1);
-    ft_triangular_banded_eigenvectorsl(A, B, Vl);
+    ft_triangular_banded_eigenvectors_columnsl(A, B, Vl, j0);
     double * V = calloc(n*n, sizeof(double));
     long double * sclrow = malloc(n*sizeof(long double));
     long double * sclcol = malloc(n*sizeof(long double));
@@ -86,7 +105,7 @@ double * plan_chebyshev_to_legendre(const int normcheb, const int normleg, const
         sclrow[i] = normleg ? 1.0L/sqrtl(i+0.5L) : 1.0L;
         sclcol[i] = normcheb ? i ? sqrtl(M_2_PIl) : sqrtl(M_1_PIl) : 1.0L;
     }
-    for (int j = 0; j < n; j++)
+    for (int j = j0; j < n; j++)
         for (int i = j; i >= 0; i -= 2)
             V[i+j*n] = sclrow[i]*Vl[i+j*n]*sclcol[j];
     ft_destroy_triangular_bandedl(A);
@@ -98,6 +117,10 @@ double * plan_chebyshev_to_legendre(const int normcheb, const int normleg, const
 }
 
 double * plan_ultraspherical_to_ultraspherical(const int norm1, const int norm2, const int n, const double lambda, const double mu) {
+    return plan_ultraspherical_to_ultraspherical_columns(norm1, norm2, n, lambda, mu, 0);
+}
+
+double * plan_ultraspherical_to_ultraspherical_columns(const int norm1, const int norm2, const int n, const double lambda, const double mu, const int j0) {
     ft_triangular_bandedl * A = ft_create_A_ultraspherical_to_ultrasphericall(n, lambda, mu);
     ft_triangular_bandedl * B = ft_create_B_ultraspherical_to_ultrasphericall(n, mu);
     long double * Vl = calloc(n*n, sizeof(long double));
@@ -106,7 +129,7 @@ double * plan_ultraspherical_to_ultraspherical(const int norm1, const int norm2,
         Vl[0] = 1;
     for (int i = 1; i < n; i++)
         Vl[i+i*n] = (i-1+lambdal)*Vl[i-1+(i-1)*n]/(i-1+mul);
-    ft_triangular_banded_eigenvectorsl(A, B, Vl);
+    ft_triangular_banded_eigenvectors_columnsl(A, B, Vl, j0);
     double * V = calloc(n*n, sizeof(double));
     long double * sclrow = calloc(n, sizeof(long double));
     long double * sclcol = calloc(n, sizeof(long double));
@@ -118,7 +141,7 @@ double * plan_ultraspherical_to_ultraspherical(const int norm1, const int norm2,
         sclrow[i] = norm2 ? sqrtl((i-1+mul)/i*(i-1+2*mul)/(i+mul))*sclrow[i-1] : 1.0L;
         sclcol[i] = norm1 ? sqrtl(i/(i-1+lambdal)*(i+lambdal)/(i-1+2*lambdal))*sclcol[i-1] : 1.0L;
     }
-    for (int j = 0; j < n; j++)
+    for (int j = j0; j < n; j++)
         for (int i = j; i >= 0; i -= 2)
             V[i+j*n] = sclrow[i]*Vl[i+j*n]*sclcol[j];
     ft_destroy_triangular_bandedl(A);
@@ -130,6 +153,10 @@ double * plan_ultraspherical_to_ultraspherical(const int norm1, const int norm2,
 }
 
 double * plan_jacobi_to_jacobi(const int norm1, const int norm2, const int n, const double alpha, const double beta, const double gamma, const double delta) {
+    return plan_jacobi_to_jacobi_columns(norm1, norm2, n, alpha, beta, gamma, delta, 0);
+}
+
+double * plan_jacobi_to_jacobi_columns(const int norm1, const int norm2, const int n, const double alpha, const double beta, const double gamma, const double delta, const int j0) {
     ft_triangular_bandedl * A = ft_create_A_jacobi_to_jacobil(n, alpha, beta, gamma, delta);
     ft_triangular_bandedl * B = ft_create_B_jacobi_to_jacobil(n, gamma, delta);
     long double alphal = alpha, betal = beta, gammal = gamma, deltal = delta;
@@ -140,7 +167,7 @@ double * plan_jacobi_to_jacobi(const int norm1, const int norm2, const int n, co
         Vl[1+n] = (alphal+betal+2)/(gammal+deltal+2);
     for (int i = 2; i < n; i++)
         Vl[i+i*n] = (2*i+alphal+betal-1)/(i+alphal+betal)*(2*i+alphal+betal)/(2*i+gammal+deltal-1)*(i+gammal+deltal)/(2*i+gammal+deltal)*Vl[i-1+(i-1)*n];
-    ft_triangular_banded_eigenvectorsl(A, B, Vl);
+    ft_triangular_banded_eigenvectors_columnsl(A, B, Vl, j0);
     double * V = calloc(n*n, sizeof(double));
     long double * sclrow = calloc(n, sizeof(long double));
     long double * sclcol = calloc(n, sizeof(long double));
@@ -156,7 +183,7 @@ double * plan_jacobi_to_jacobi(const int norm1, const int norm2, const int n, co
         sclrow[i] = norm2 ? sqrtl((i+gammal)/i*(i+deltal)/(i+gammal+deltal)*(2*i+gammal+deltal-1)/(2*i+gammal+deltal+1))*sclrow[i-1] : 1.0L;
         sclcol[i] = norm1 ? sqrtl(i/(i+alphal)*(i+alphal+betal)/(i+betal)*(2*i+alphal+betal+1)/(2*i+alphal+betal-1))*sclcol[i-1] : 1.0L;
     }
-    for (int j = 0; j < n; j++)
+    for (int j = j0; j < n; j++)
         for (int i = 0; i <= j; i++)
             V[i+j*n] = sclrow[i]*Vl[i+j*n]*sclcol[j];
     ft_destroy_triangular_bandedl(A);
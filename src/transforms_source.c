@@ -1,3 +1,27 @@
+// The tolerance of the factorization in the next precision up. At the working precision, it is
+// that of the next precision, so that the default plans are as accurate as before.
+static inline FLT2 X(tol2)(const FLT tol) {return tol > Y(eps)() ? tol : Y2(eps)();}
+
+// The shift k ≥ 0 from a to b = a+k, or -1 if b-a is not a nonnegative integer.
+static inline int X(integer_shift)(const FLT a, const FLT b) {
+    FLT k = b-a;
+    return k >= 0 && k == Y(floor)(k) && k <= BANDED_CONNECTION_MAX_BANDWIDTH ? (int) k : -1;
+}
+
+// An integer shift up in the parameters is a banded product U of raisings, which the plan
+// applies directly: it is U normalized to a unit diagonal and scaled as the FMM plan would be.
+static X(tb_eigen_FMM) * X(plan_banded_connection)(X2(banded) * U, const FLT2 * sclrow, const FLT2 * sclcol) {
+    int n = U->n, b = U->u;
+    X(triangular_banded) * T = X(calloc_triangular_banded)(n, b);
+    for (int j = 0; j < n; j++) {
+        FLT2 ujj = X2(get_banded_index)(U, j, j);
+        for (int i = MAX(j-b, 0); i <= j; i++)
+            X(set_triangular_banded_index)(T, sclrow[i]*(X2(get_banded_index)(U, i, j)/ujj)*sclcol[j], i, j);
+    }
+    X2(destroy_banded)(U);
+    return X(tb_banded_FMM)(T);
+}
+
 static inline X2(triangular_banded) * X2(create_A_legendre_to_chebyshev)(const int n) {
     X2(triangular_banded) * A = X2(calloc_triangular_banded)(n, 2);
     if (n > 1)
@@ -22,10 +46,12 @@ static inline X2(triangular_banded) * X2(create_B_legendre_to_chebyshev)(const i
     return B;
 }
 
-X(tb_eigen_FMM) * X(plan_legendre_to_chebyshev)(const int normleg, const int normcheb, const int n) {
+X(tb_eigen_FMM) * X(plan_legendre_to_chebyshev)(const int normleg, const int normcheb, const int n) {return X(plan_legendre_to_chebyshev_tol)(normleg, normcheb, n, Y(eps)());}
+
+X(tb_eigen_FMM) * X(plan_legendre_to_chebyshev_tol)(const int normleg, const int normcheb, const int n, const FLT tol) {
     X2(triangular_banded) * A = X2(create_A_legendre_to_chebyshev)(n);
     X2(triangular_banded) * B = X2(create_B_legendre_to_chebyshev)(n);
-    X2(tb_eigen_FMM) * F2 = X2(tb_eig_FMM)(A, B);
+    X2(tb_eigen_FMM) * F2 = X2(tb_eig_FMM_tol)(A, B, X(tol2)(tol));
     FLT2 * sclrow = malloc(n*sizeof(FLT2));
     FLT2 * sclcol = malloc(n*sizeof(FLT2));
     FLT2 t = 1, sqrtpi = Y2(tgamma)(0.5);
@@ -45,10 +71,9 @@ X(tb_eigen_FMM) * X(plan_legendre_to_chebyshev)(const int normleg, const int nor
     }
     X2(scale_rows_tb_eigen_FMM)(1, sclrow, F2);
     X2(scale_columns_tb_eigen_FMM)(1, sclcol, F2);
-    X(tb_eigen_FMM) * F = X(drop_precision_tb_eigen_FMM)(F2);
+    X(tb_eigen_FMM) * F = X(drop_precision_destroy_tb_eigen_FMM_tol)(F2, tol);
     X2(destroy_triangular_banded)(A);
     X2(destroy_triangular_banded)(B);
-    X2(destroy_tb_eigen_FMM)(F2);
     free(sclrow);
     free(sclcol);
     return F;
@@ -78,10 +103,12 @@ static inline X2(triangular_banded) * X2(create_B_chebyshev_to_legendre)(const i
     return B;
 }
 
-X(tb_eigen_FMM) * X(plan_chebyshev_to_legendre)(const int normcheb, const int normleg, const int n) {
+X(tb_eigen_FMM) * X(plan_chebyshev_to_legendre)(const int normcheb, const int normleg, const int n) {return X(plan_chebyshev_to_legendre_tol)(normcheb, normleg, n, Y(eps)());}
+
+X(tb_eigen_FMM) * X(plan_chebyshev_to_legendre_tol)(const int normcheb, const int normleg, const int n, const FLT tol) {
     X2(triangular_banded) * A = X2(create_A_chebyshev_to_legendre)(n);
     X2(triangular_banded) * B = X2(create_B_chebyshev_to_legendre)(n);
-    X2(tb_eigen_FMM) * F2 = X2(tb_eig_FMM)(A, B);
+    X2(tb_eigen_FMM) * F2 = X2(tb_eig_FMM_tol)(A, B, X(tol2)(tol));
     FLT2 * sclrow = malloc(n*sizeof(FLT2));
     FLT2 * sclcol = malloc(n*sizeof(FLT2));
     FLT2 t = 1, sqrt_1_pi = 1/Y2(tgamma)(0.5);
@@ -101,10 +128,9 @@ X(tb_eigen_FMM) * X(plan_chebyshev_to_legendre)(const int normcheb, const int no
     }
     X2(scale_rows_tb_eigen_FMM)(1, sclrow, F2);
     X2(scale_columns_tb_eigen_FMM)(1, sclcol, F2);
-    X(tb_eigen_FMM) * F = X(drop_precision_tb_eigen_FMM)(F2);
+    X(tb_eigen_FMM) * F = X(drop_precision_destroy_tb_eigen_FMM_tol)(F2, tol);
     X2(destroy_triangular_banded)(A);
     X2(destroy_triangular_banded)(B);
-    X2(destroy_tb_eigen_FMM)(F2);
     free(sclrow);
     free(sclcol);
     return F;
@@ -134,12 +160,9 @@ static inline X2(triangular_banded) * X2(create_B_ultraspherical_to_ultraspheric
     return B;
 }
 
-X(tb_eigen_FMM) * X(plan_ultraspherical_to_ultraspherical)(const int norm1, const int norm2, const int n, const FLT lambda, const FLT mu) {
-    X2(triangular_banded) * A = X2(create_A_ultraspherical_to_ultraspherical)(n, lambda, mu);
-    X2(triangular_banded) * B = X2(create_B_ultraspherical_to_ultraspherical)(n, mu);
-    X2(tb_eigen_FMM) * F2 = X2(tb_eig_FMM)(A, B);
-    FLT2 * sclrow = malloc(n*sizeof(FLT2));
-    FLT2 * sclcol = malloc(n*sizeof(FLT2));
+X(tb_eigen_FMM) * X(plan_ultraspherical_to_ultraspherical)(const int norm1, const int norm2, const int n, const FLT lambda, const FLT mu) {return X(plan_ultraspherical_to_ultraspherical_tol)(norm1, norm2, n, lambda, mu, Y(eps)());}
+
+static inline void X(scale_ultraspherical_to_ultraspherical)(const int norm1, const int norm2, const int n, const FLT lambda, const FLT mu, FLT2 * sclrow, FLT2 * sclcol) {
     FLT2 lambda2 = lambda, mu2 = mu;
     if (n > 0) {
         sclrow[0] = norm2 ? Y2(sqrt)(Y2(tgamma)(0.5)*Y2(tgamma)(mu2+0.5)/Y2(tgamma)(mu2+1)) : 1;
@@ -149,12 +172,43 @@ X(tb_eigen_FMM) * X(plan_ultraspherical_to_ultraspherical)(const int norm1, cons
         sclrow[i] = norm2 ? Y2(sqrt)((i-1+mu2)/i*(i-1+2*mu2)/(i+mu2))*sclrow[i-1] : 1;
         sclcol[i] = norm1 ? Y2(sqrt)(i/(i-1+lambda2)*(i+lambda2)/(i-1+2*lambda2))*(i-1+lambda2)/(i-1+mu2)*sclcol[i-1] : (i-1+lambda2)/(i-1+mu2)*sclcol[i-1];
     }
+}
+
+// C^{(λ)} ↗ C^{(λ+k)} as the product of k raisings.
+static inline X2(banded) * X2(create_ultraspherical_raising_product)(const int n, const FLT2 lambda, const int k) {
+    X2(banded) * U = X2(calloc_banded)(n, n, 0, 0);
+    for (int i = 0; i < n; i++)
+        X2(set_banded_index)(U, 1, i, i);
+    for (int l = 0; l < k; l++) {
+        X2(banded) * R = X2(create_ultraspherical_raising)(n, n, lambda+l);
+        X2(banded) * V = X2(calloc_banded)(n, n, 0, U->u+2);
+        X2(gbmm)(1, R, U, 0, V);
+        X2(destroy_banded)(R);
+        X2(destroy_banded)(U);
+        U = V;
+    }
+    return U;
+}
+
+X(tb_eigen_FMM) * X(plan_ultraspherical_to_ultraspherical_tol)(const int norm1, const int norm2, const int n, const FLT lambda, const FLT mu, const FLT tol) {
+    FLT2 * sclrow = malloc(n*sizeof(FLT2));
+    FLT2 * sclcol = malloc(n*sizeof(FLT2));
+    X(scale_ultraspherical_to_ultraspherical)(norm1, norm2, n, lambda, mu, sclrow, sclcol);
+    int k = X(integer_shift)(lambda, mu);
+    if (lambda != 0 && k >= 0 && 2*k <= BANDED_CONNECTION_MAX_BANDWIDTH) {
+        X(tb_eigen_FMM) * F = X(plan_banded_connection)(X2(create_ultraspherical_raising_product)(n, lambda, k), sclrow, sclcol);
+        free(sclrow);
+        free(sclcol);
+        return F;
+    }
+    X2(triangular_banded) * A = X2(create_A_ultraspherical_to_ultraspherical)(n, lambda, mu);
+    X2(triangular_banded) * B = X2(create_B_ultraspherical_to_ultraspherical)(n, mu);
+    X2(tb_eigen_FMM) * F2 = X2(tb_eig_FMM_tol)(A, B, X(tol2)(tol));
     X2(scale_rows_tb_eigen_FMM)(1, sclrow, F2);
     X2(scale_columns_tb_eigen_FMM)(1, sclcol, F2);
-    X(tb_eigen_FMM) * F = X(drop_precision_tb_eigen_FMM)(F2);
+    X(tb_eigen_FMM) * F = X(drop_precision_destroy_tb_eigen_FMM_tol)(F2, tol);
     X2(destroy_triangular_banded)(A);
     X2(destroy_triangular_banded)(B);
-    X2(destroy_tb_eigen_FMM)(F2);
     free(sclrow);
     free(sclcol);
     return F;
@@ -192,12 +246,9 @@ static inline X2(triangular_banded) * X2(create_B_jacobi_to_jacobi)(const int n,
     return B;
 }
 
-X(tb_eigen_FMM) * X(plan_jacobi_to_jacobi)(const int norm1, const int norm2, const int n, const FLT alpha, const FLT beta, const FLT gamma, const FLT delta) {
-    X2(triangular_banded) * A = X2(create_A_jacobi_to_jacobi)(n, alpha, beta, gamma, delta);
-    X2(triangular_banded) * B = X2(create_B_jacobi_to_jacobi)(n, gamma, delta);
-    X2(tb_eigen_FMM) * F2 = X2(tb_eig_FMM)(A, B);
-    FLT2 * sclrow = malloc(n*sizeof(FLT2));
-    FLT2 * sclcol = malloc(n*sizeof(FLT2));
+X(tb_eigen_FMM) * X(plan_jacobi_to_jacobi)(const int norm1, const int norm2, const int n, const FLT alpha, const FLT beta, const FLT gamma, const FLT delta) {return X(plan_jacobi_to_jacobi_tol)(norm1, norm2, n, alpha, beta, gamma, delta, Y(eps)());}
+
+static inline void X(scale_jacobi_to_jacobi)(const int norm1, const int norm2, const int n, const FLT alpha, const FLT beta, const FLT gamma, const FLT delta, FLT2 * sclrow, FLT2 * sclcol) {
     FLT2 alpha2 = alpha, beta2 = beta, gamma2 = gamma, delta2 = delta;
     if (n > 0) {
         sclrow[0] = norm2 ? Y2(sqrt)(Y2(pow)(2, gamma2+delta2+1)*Y2(tgamma)(gamma2+1)*Y2(tgamma)(delta2+1)/Y2(tgamma)(gamma2+delta2+2)) : 1;
@@ -211,12 +262,49 @@ X(tb_eigen_FMM) * X(plan_jacobi_to_jacobi)(const int norm1, const int norm2, con
         sclrow[i] = norm2 ? Y2(sqrt)((i+gamma2)/i*(i+delta2)/(i+gamma2+delta2)*(2*i+gamma2+delta2-1)/(2*i+gamma2+delta2+1))*sclrow[i-1] : 1;
         sclcol[i] = norm1 ? Y2(sqrt)(i/(i+alpha2)*(i+alpha2+beta2)/(i+beta2)*(2*i+alpha2+beta2+1)/(2*i+alpha2+beta2-1))*(2*i+alpha2+beta2-1)/(i+alpha2+beta2)*(2*i+alpha2+beta2)/(2*i+gamma2+delta2-1)*(i+gamma2+delta2)/(2*i+gamma2+delta2)*sclcol[i-1] : (2*i+alpha2+beta2-1)/(i+alpha2+beta2)*(2*i+alpha2+beta2)/(2*i+gamma2+delta2-1)*(i+gamma2+delta2)/(2*i+gamma2+delta2)*sclcol[i-1];
     }
+}
+
+// P^{(α,β)} ↗ P^{(α+k,β+l)} as min(k,l) symmetric raisings followed by |k-l| one-sided ones.
+static inline X2(banded) * X2(create_jacobi_raising_product)(const int n, const FLT2 alpha, const FLT2 beta, const int k, const int l) {
+    X2(banded) * U = X2(calloc_banded)(n, n, 0, 0);
+    for (int i = 0; i < n; i++)
+        X2(set_banded_index)(U, 1, i, i);
+    for (int i = 0; i < MAX(k, l); i++) {
+        X2(banded) * R;
+        if (i < MIN(k, l))
+            R = X2(create_jacobi_raising)(n, n, alpha+i, beta+i);
+        else if (k > l)
+            R = X2(create_jacobi_raising_alpha)(n, n, alpha+i, beta+l);
+        else
+            R = X2(create_jacobi_raising_beta)(n, n, alpha+k, beta+i);
+        X2(banded) * V = X2(calloc_banded)(n, n, 0, U->u+R->u);
+        X2(gbmm)(1, R, U, 0, V);
+        X2(destroy_banded)(R);
+        X2(destroy_banded)(U);
+        U = V;
+    }
+    return U;
+}
+
+X(tb_eigen_FMM) * X(plan_jacobi_to_jacobi_tol)(const int norm1, const int norm2, const int n, const FLT alpha, const FLT beta, const FLT gamma, const FLT delta, const FLT tol) {
+    FLT2 * sclrow = malloc(n*sizeof(FLT2));
+    FLT2 * sclcol = malloc(n*sizeof(FLT2));
+    X(scale_jacobi_to_jacobi)(norm1, norm2, n, alpha, beta, gamma, delta, sclrow, sclcol);
+    int k = X(integer_shift)(alpha, gamma), l = X(integer_shift)(beta, delta);
+    if (k >= 0 && l >= 0 && k+l <= BANDED_CONNECTION_MAX_BANDWIDTH) {
+        X(tb_eigen_FMM) * F = X(plan_banded_connection)(X2(create_jacobi_raising_product)(n, alpha, beta, k, l), sclrow, sclcol);
+        free(sclrow);
+        free(sclcol);
+        return F;
+    }
+    X2(triangular_banded) * A = X2(create_A_jacobi_to_jacobi)(n, alpha, beta, gamma, delta);
+    X2(triangular_banded) * B = X2(create_B_jacobi_to_jacobi)(n, gamma, delta);
+    X2(tb_eigen_FMM) * F2 = X2(tb_eig_FMM_tol)(A, B, X(tol2)(tol));
     X2(scale_rows_tb_eigen_FMM)(1, sclrow, F2);
     X2(scale_columns_tb_eigen_FMM)(1, sclcol, F2);
-    X(tb_eigen_FMM) * F = X(drop_precision_tb_eigen_FMM)(F2);
+    X(tb_eigen_FMM) * F = X(drop_precision_destroy_tb_eigen_FMM_tol)(F2, tol);
     X2(destroy_triangular_banded)(A);
     X2(destroy_triangular_banded)(B);
-    X2(destroy_tb_eigen_FMM)(F2);
     free(sclrow);
     free(sclcol);
     return F;
@@ -240,10 +328,12 @@ static inline X2(triangular_banded) * X2(create_B_laguerre_to_laguerre)(const in
     return B;
 }
 
-X(tb_eigen_FMM) * X(plan_laguerre_to_laguerre)(const int norm1, const int norm2, const int n, const FLT alpha, const FLT beta) {
+X(tb_eigen_FMM) * X(plan_laguerre_to_laguerre)(const int norm1, const int norm2, const int n, const FLT alpha, const FLT beta) {return X(plan_laguerre_to_laguerre_tol)(norm1, norm2, n, alpha, beta, Y(eps)());}
+
+X(tb_eigen_FMM) * X(plan_laguerre_to_laguerre_tol)(const int norm1, const int norm2, const int n, const FLT alpha, const FLT beta, const FLT tol) {
     X2(triangular_banded) * A = X2(create_A_laguerre_to_laguerre)(n, alpha, beta);
     X2(triangular_banded) * B = X2(create_B_laguerre_to_laguerre)(n);
-    X2(tb_eigen_FMM) * F2 = X2(tb_eig_FMM)(A, B);
+    X2(tb_eigen_FMM) * F2 = X2(tb_eig_FMM_tol)(A, B, X(tol2)(tol));
     FLT2 * sclrow = malloc(n*sizeof(FLT2));
     FLT2 * sclcol = malloc(n*sizeof(FLT2));
     FLT2 alpha2 = alpha, beta2 = beta;
@@ -257,10 +347,9 @@ X(tb_eigen_FMM) * X(plan_laguerre_to_laguerre)(const int norm1, const int norm2,
     }
     X2(scale_rows_tb_eigen_FMM)(1, sclrow, F2);
     X2(scale_columns_tb_eigen_FMM)(1, sclcol, F2);
-    X(tb_eigen_FMM) * F = X(drop_precision_tb_eigen_FMM)(F2);
+    X(tb_eigen_FMM) * F = X(drop_precision_destroy_tb_eigen_FMM_tol)(F2, tol);
     X2(destroy_triangular_banded)(A);
     X2(destroy_triangular_banded)(B);
-    X2(destroy_tb_eigen_FMM)(F2);
     free(sclrow);
     free(sclcol);
     return F;
@@ -357,3 +446,45 @@ X(tb_eigen_FMM) * X(plan_chebyshev_to_ultraspherical)(const int normcheb, const
     }
     return F;
 }
+
+X(tb_eigen_FMM) * X(plan_associated_jacobi_to_jacobi)(const int norm2, const int n, const int c, const FLT alpha, const FLT beta, const FLT gamma, const FLT delta) {return X(plan_associated_jacobi_to_jacobi_tol)(norm2, n, c, alpha, beta, gamma, delta, Y(eps)());}
+
+X(tb_eigen_FMM) * X(plan_associated_jacobi_to_jacobi_tol)(const int norm2, const int n, const int c, const FLT alpha, const FLT beta, const FLT gamma, const FLT delta, const FLT tol) {
+    X2(triangular_banded) * A = X2(create_A_associated_jacobi_to_jacobi)(n, alpha, beta, gamma, delta);
+    X2(triangular_banded) * B = X2(create_B_associated_jacobi_to_jacobi)(n, gamma, delta);
+    X2(triangular_banded) * C = X2(create_C_associated_jacobi_to_jacobi)(n, gamma, delta);
+    FLT2 alpha2 = alpha, beta2 = beta, gamma2 = gamma, delta2 = delta;
+    FLT2 * lambda = malloc(n*sizeof(FLT2));
+    for (int j = 0; j < n; j++)
+        lambda[j] = (j+alpha2+beta2+2*c-1)*(j+alpha2+beta2+2*c+1) + (j+3)*(j-ONE(FLT2));
+    X2(tb_eigen_FMM) * F2 = X2(tb_eig_FMM_3arg)(A, B, lambda, C, MAX(tol, Y(eps)()));
+    FLT2 * sclrow = malloc(n*sizeof(FLT2));
+    FLT2 * sclcol = malloc(n*sizeof(FLT2));
+    if (n > 0) {
+        sclrow[0] = norm2 ? Y2(sqrt)(Y2(pow)(2, gamma2+delta2+1)*Y2(tgamma)(gamma2+1)*Y2(tgamma)(delta2+1)/Y2(tgamma)(gamma2+delta2+2)) : 1;
+        sclcol[0] = 1;
+    }
+    if (n > 1) {
+        sclrow[1] = norm2 ? Y2(sqrt)((gamma2+1)*(delta2+1)/(gamma2+delta2+3))*sclrow[0] : 1;
+        sclcol[1] = (2*c+alpha2+beta2+1)/(c+alpha2+beta2+1)*(2*c+alpha2+beta2+2)/(1+c)/(gamma2+delta2+2);
+    }
+    for (int i = 2; i < n; i++) {
+        sclrow[i] = norm2 ? Y2(sqrt)((i+gamma2)/i*(i+delta2)/(i+gamma2+delta2)*(2*i+gamma2+delta2-1)/(2*i+gamma2+delta2+1))*sclrow[i-1] : 1;
+        sclcol[i] = (2*(i+c)+alpha2+beta2-1)/(i+c+alpha2+beta2)*(2*(i+c)+alpha2+beta2)/(2*i+gamma2+delta2-1)*(i+gamma2+delta2)/(2*i+gamma2+delta2)*i/(i+c)*sclcol[i-1];
+    }
+    X2(scale_rows_tb_eigen_FMM)(1, sclrow, F2);
+    X2(scale_columns_tb_eigen_FMM)(1, sclcol, F2);
+    X(tb_eigen_FMM) * F = X(drop_precision_destroy_tb_eigen_FMM_tol)(F2, tol);
+    X2(destroy_triangular_banded)(A);
+    X2(destroy_triangular_banded)(B);
+    X2(destroy_triangular_banded)(C);
+    free(lambda);
+    free(sclrow);
+    free(sclcol);
+    return F;
+}
+
+// The product carries the rounding errors of the chain, and compressing below them only adds rank.
+X(tb_eigen_FMM) * X(plan_composite)(const int k, X(tb_eigen_FMM) ** P, FLT ** D) {
+    return X(tb_compose_FMM)(k, P, D, 8*k*Y(eps)());
+}
@@ -44,6 +44,59 @@ int main(void) {
     test_bandedl(&checksum);
     printf("\n\tQuadruple precision.\n\n");
     test_bandedq(&checksum);
+    printf("\n\tDouble-double arithmetic.\n\n");
+    for (int n = 256; n < 2048; n *= 2) {
+        ft_triangular_bandedq * A = ft_create_A_testq(n), * B = ft_create_B_testq(n);
+        ft_triangular_bandeddd * Add = ft_calloc_triangular_bandeddd(n, 2), * Bdd = ft_calloc_triangular_bandeddd(n, 2);
+        for (int j = 0; j < n; j++)
+            for (int i = j < 2 ? 0 : j-2; i <= j; i++) {
+                ft_set_triangular_banded_indexdd(Add, ft_get_triangular_banded_indexq(A, i, j), i, j);
+                ft_set_triangular_banded_indexdd(Bdd, ft_get_triangular_banded_indexq(B, i, j), i, j);
+            }
+        ft_tb_eigen_FMMq * F = ft_tb_eig_FMMq(A, B);
+        ft_tb_eigen_FMMdd * Fdd = ft_tb_eig_FMMdd(Add, Bdd);
+        quadruple * x = malloc(n*sizeof(quadruple));
+        quadruple * y = malloc(n*sizeof(quadruple));
+        for (int i = 0; i < n; i++)
+            x[i] = y[i] = 1/(i+1.0Q);
+        ft_bfmvq('N', F, x);
+        ft_bfmvdd('N', Fdd, y);
+        quadruple err = ft_norm_2argq(x, y, n)/ft_norm_1argq(x, n);
+        printf("Comparison with quadruple precision \t (%5i×%5i) \t |%20.2e ", n, n, (double) err);
+        // Double-double carries 106 of the 113 bits of quadruple precision.
+        ft_checktestq(err, 128*n, &checksum);
+        ft_destroy_triangular_bandedq(A);
+        ft_destroy_triangular_bandedq(B);
+        ft_destroy_triangular_bandeddd(Add);
+        ft_destroy_triangular_bandeddd(Bdd);
+        ft_destroy_tb_eigen_FMMq(F);
+        ft_destroy_tb_eigen_FMMdd(Fdd);
+        free(x);
+        free(y);
+    }
+    // The transposed product scales y by β even when A has no rows, and overwrites it if β = 0.
+    for (int m = 0; m <= 300; m += 150) {
+        int n = 8;
+        quadruple * A = malloc((m+1)*n*sizeof(quadruple));
+        quadruple * x = malloc((m+1)*sizeof(quadruple));
+        quadruple y[8], z[8];
+        for (int i = 0; i < (m+1)*n; i++)
+            A[i] = 1/(i+1.0Q);
+        for (int i = 0; i <= m; i++)
+            x[i] = 1/(i+2.0Q);
+        for (int k = 0; k < 3; k++) {
+            quadruple beta = k == 0 ? 0 : k == 1 ? 1 : -0.75Q;
+            for (int i = 0; i < n; i++)
+                y[i] = z[i] = k == 0 ? NAN : i+1.0Q;
+            ft_gemvq('T', m, n, 1, A, m+1, x, beta, y);
+            ft_gemvdd('T', m, n, 1, A, m+1, x, beta, z);
+            quadruple err = ft_norm_2argq(y, z, n);
+            printf("Transposed product with β = %5.2f \t (%5i×%5i) \t |%20.2e ", (double) beta, m, n, (double) err);
+            ft_checktestq(err, 128*m+1, &checksum);
+        }
+        free(A);
+        free(x);
+    }
     printf("\n");
     return checksum;
 }
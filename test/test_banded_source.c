@@ -172,6 +172,44 @@ void X(inner_test_banded)(int * checksum, int n) {
     printf("Check row/column scalings \t\t (%5i×%5i) \t |%20.2e ", n, n, (double) err);
     X(checktest)(err, n, checksum);
 
+    err = 0;
+    for (int howmany = 1; howmany < 100; howmany += 69) {
+        FLT * C = malloc(n*howmany*sizeof(FLT));
+        FLT * R = malloc(n*howmany*sizeof(FLT));
+        FLT * D = malloc(n*howmany*sizeof(FLT));
+        for (char TRANS = 'N'; TRANS != 'U'; TRANS = TRANS == 'N' ? 'T' : 'U') {
+            for (int j = 0; j < howmany; j++)
+                for (int i = 0; i < n; i++)
+                    R[j+i*howmany] = C[i+j*n] = D[i+j*n] = ONE(FLT)/(i+j+1);
+            for (int j = 0; j < howmany; j++)
+                X(bfmv)(TRANS, F, D+j*n);
+            X(bfmv_many)(TRANS, F, C, 1, n, howmany);
+            X(bfmv_many)(TRANS, F, R, howmany, 1, howmany);
+            err += X(norm_2arg)(C, D, n*howmany)/X(norm_1arg)(D, n*howmany);
+            for (int j = 0; j < howmany; j++)
+                for (int i = 0; i < n; i++)
+                    C[i+j*n] = R[j+i*howmany];
+            err += X(norm_2arg)(C, D, n*howmany)/X(norm_1arg)(D, n*howmany);
+            for (int j = 0; j < howmany; j++)
+                for (int i = 0; i < n; i++)
+                    C[i+j*n] = R[j+i*howmany] = D[i+j*n];
+            for (int j = 0; j < howmany; j++)
+                X(bfsv)(TRANS, F, D+j*n);
+            X(bfsv_many)(TRANS, F, C, 1, n, howmany);
+            X(bfsv_many)(TRANS, F, R, howmany, 1, howmany);
+            err += X(norm_2arg)(C, D, n*howmany)/X(norm_1arg)(D, n*howmany);
+            for (int j = 0; j < howmany; j++)
+                for (int i = 0; i < n; i++)
+                    C[i+j*n] = R[j+i*howmany];
+            err += X(norm_2arg)(C, D, n*howmany)/X(norm_1arg)(D, n*howmany);
+        }
+        free(C);
+        free(R);
+        free(D);
+    }
+    printf("Check batched strided multiplies and solves \t\t |%20.2e ", (double) err);
+    X(checktest)(err, n, checksum);
+
     X(destroy_triangular_banded)(A);
     X(destroy_triangular_banded)(B);
     X(destroy_tb_eigen_FMM)(F);
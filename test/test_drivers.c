@@ -1,7 +1,16 @@
 #include "fasttransforms.h"
 #include "ftutilities.h"
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+#endif
 
 double * aligned_copymat(double * A, int n, int m);
+void write_test_array(const char * filename, const double * A, const size_t n);
+void read_test_array(const char * filename, double * A, const size_t n);
+double * map_test_array(const char * filename, const double * A, const size_t n);
+void unmap_test_array(double * A, const size_t n);
 
 int main(int argc, const char * argv[]) {
     struct timeval start, end;
@@ -1085,6 +1094,551 @@ int main(int argc, const char * argv[]) {
     }
     printf("];\n");
 
+    printf("\nTesting spherical harmonic transforms called from a parallel region.\n\n");
+    printf("err12 = [\n");
+    for (int i = 0; i < IERR; i++) {
+        N = 64*pow(2, i)+J;
+        M = 2*N-1;
+
+        A = sphrand(N, M);
+        B = malloc(4*N*M*sizeof(double));
+        for (int f = 0; f < 2; f++) {
+            P = ft_plan_sph2fourier_with_flags(N, f ? FT_HARMONIC_FMM : FT_HARMONIC_DENSE);
+            ft_set_harmonic_plan_num_threads(P, 2);
+
+            Ac = copymat(A, N, M);
+            ft_execute_sph2fourier(P, Ac, N, M);
+            for (int k = 0; k < 4; k++)
+                for (int l = 0; l < N*M; l++)
+                    B[l+k*N*M] = A[l];
+            #pragma omp parallel for num_threads(4)
+            for (int k = 0; k < 4; k++)
+                ft_execute_sph2fourier(P, B+k*N*M, N, M);
+
+            for (int k = 0; k < 4; k++)
+                printf("%1.2e  ", ft_norm_2arg(B+k*N*M, Ac, N*M)/ft_norm_1arg(Ac, N*M));
+            free(Ac);
+            ft_destroy_harmonic_plan(P);
+        }
+        printf("%d\n", ft_get_num_threads());
+
+        free(A);
+        free(B);
+    }
+    printf("];\n");
+
+    printf("\nTesting streamed execution against the full workspace.\n\n");
+    printf("err13 = [\n");
+    for (int i = 0; i < IERR; i++) {
+        N = 64*pow(2, i)+J;
+
+        M = 2*N-1;
+        A = sphrand(N, M);
+        B = copymat(A, N, M);
+        P = ft_plan_sph2fourier(N);
+        ft_execute_sph2fourier(P, A, N, M);
+        ft_set_harmonic_plan_streaming(P, 1);
+        ft_execute_sph2fourier(P, B, N, M);
+        printf("%1.2e  ", ft_norm_2arg(A, B, N*M)/ft_norm_1arg(A, N*M));
+        ft_execute_fourier2sph(P, A, N, M);
+        ft_set_harmonic_plan_streaming(P, 0);
+        ft_execute_fourier2sph(P, B, N, M);
+        printf("%1.2e  ", ft_norm_2arg(A, B, N*M)/ft_norm_1arg(A, N*M));
+        free(A);
+        free(B);
+        ft_destroy_harmonic_plan(P);
+
+        M = N;
+        A = trirand(N, M);
+        B = copymat(A, N, M);
+        P = ft_plan_tri2cheb(N, alpha, beta, gamma);
+        ft_execute_tri2cheb(P, A, N, M);
+        ft_set_harmonic_plan_streaming(P, 1);
+        ft_execute_tri2cheb(P, B, N, M);
+        printf("%1.2e  ", ft_norm_2arg(A, B, N*M)/ft_norm_1arg(A, N*M));
+        free(A);
+        free(B);
+        ft_destroy_harmonic_plan(P);
+
+        M = 4*N-3;
+        A = diskrand(N, M);
+        B = copymat(A, N, M);
+        P = ft_plan_disk2cxf(N);
+        ft_harmonic_plan * Q = ft_plan_disk2cxf_with_flags(N, FT_HARMONIC_STREAMING);
+        ft_execute_disk2cxf(P, A, N, M);
+        ft_execute_disk2cxf(Q, B, N, M);
+        printf("%1.2e  ", ft_norm_2arg(A, B, N*M)/ft_norm_1arg(A, N*M));
+        printf("%d  ", Q->B == NULL);
+        free(A);
+        free(B);
+        ft_destroy_harmonic_plan(P);
+        ft_destroy_harmonic_plan(Q);
+
+        L = M = N/2;
+        A = tetrand(N/2, L, M);
+        B = copymat(A, N/2, L*M);
+        TP = ft_plan_tet2cheb(N/2, alpha, beta, gamma, delta);
+        ft_tetrahedral_harmonic_plan * TQ = ft_plan_tet2cheb_with_flags(N/2, alpha, beta, gamma, delta, FT_HARMONIC_STREAMING);
+        ft_execute_tet2cheb(TP, A, N/2, L, M);
+        ft_execute_tet2cheb(TQ, B, N/2, L, M);
+        printf("%1.2e  ", ft_norm_2arg(A, B, N/2*L*M)/ft_norm_1arg(A, N/2*L*M));
+        printf("%d\n", TQ->B == NULL);
+        free(A);
+        free(B);
+        ft_destroy_tetrahedral_harmonic_plan(TP);
+        ft_destroy_tetrahedral_harmonic_plan(TQ);
+    }
+    printf("];\n");
+
+    printf("\nScaling of the tetrahedral harmonic drivers with the number of threads.\n\n");
+    printf("t13 = [\n");
+    for (int i = 0; i < MIN(ITIME, 3); i++) {
+        N = 64*pow(2, i)+J;
+        L = M = N;
+        NLOOPS = 1 + pow(128/N, 2);
+
+        A = tetones(N, L, M);
+        B = aligned_copymat(A, N, L*M);
+
+        RP1 = ft_plan_rottriangle(N, alpha, beta, gamma + delta + 1.0);
+        RP2 = ft_plan_rottriangle(N, beta, gamma, delta);
+
+        int NT = ft_get_num_threads();
+        for (int nt = 1; ; nt = MIN(2*nt, NT)) {
+            FT_SET_NUM_THREADS(nt);
+
+            gettimeofday(&start, NULL);
+            for (int ntimes = 0; ntimes < NLOOPS; ntimes++) {
+                ft_execute_tet_hi2lo_AVX512(RP1, RP2, A, B, L, M);
+            }
+            gettimeofday(&end, NULL);
+
+            printf("%d  %d  %.6f", N, nt, elapsed(&start, &end, NLOOPS));
+
+            gettimeofday(&start, NULL);
+            for (int ntimes = 0; ntimes < NLOOPS; ntimes++) {
+                ft_execute_tet_lo2hi_AVX512(RP1, RP2, A, B, L, M);
+            }
+            gettimeofday(&end, NULL);
+
+            printf("  %.6f\n", elapsed(&start, &end, NLOOPS));
+
+            if (nt == NT)
+                break;
+        }
+        FT_SET_NUM_THREADS(NT);
+
+        free(A);
+        VFREE(B);
+        ft_destroy_rotation_plan(RP1);
+        ft_destroy_rotation_plan(RP2);
+    }
+    printf("];\n");
+
+    printf("\nTesting harmonic plans that apply the inverse connections by triangular solves.\n\n");
+    printf("err14 = [\n");
+    for (int i = 0; i < IERR; i++) {
+        N = 64*pow(2, i)+J;
+
+        M = 2*N-1;
+        A = sphrand(N, M);
+        B = copymat(A, N, M);
+        P = ft_plan_sph2fourier_with_flags(N, FT_HARMONIC_SOLVE);
+        ft_execute_sph2fourier(P, A, N, M);
+        ft_execute_fourier2sph(P, A, N, M);
+        printf("%1.2e  ", ft_norm_2arg(A, B, N*M)/ft_norm_1arg(B, N*M));
+        ft_execute_sphv2fourier(P, A, N, M);
+        ft_execute_fourier2sphv(P, A, N, M);
+        printf("%1.2e  ", ft_norm_2arg(A, B, N*M)/ft_norm_1arg(B, N*M));
+        free(A);
+        free(B);
+        ft_destroy_harmonic_plan(P);
+
+        M = N;
+        A = trirand(N, M);
+        B = copymat(A, N, M);
+        P = ft_plan_tri2cheb_with_flags(N, alpha, beta, gamma, FT_HARMONIC_SOLVE);
+        ft_execute_tri2cheb(P, A, N, M);
+        ft_execute_cheb2tri(P, A, N, M);
+        printf("%1.2e  ", ft_norm_2arg(A, B, N*M)/ft_norm_1arg(B, N*M));
+        free(A);
+        free(B);
+        ft_destroy_harmonic_plan(P);
+
+        M = 4*N-3;
+        A = diskrand(N, M);
+        B = copymat(A, N, M);
+        P = ft_plan_disk2cxf_with_flags(N, FT_HARMONIC_SOLVE);
+        ft_execute_disk2cxf(P, A, N, M);
+        ft_execute_cxf2disk(P, A, N, M);
+        printf("%1.2e  ", ft_norm_2arg(A, B, N*M)/ft_norm_1arg(B, N*M));
+        free(A);
+        free(B);
+        ft_destroy_harmonic_plan(P);
+
+        L = M = N/2;
+        A = tetrand(N/2, L, M);
+        B = copymat(A, N/2, L*M);
+        TP = ft_plan_tet2cheb_with_flags(N/2, alpha, beta, gamma, delta, FT_HARMONIC_SOLVE);
+        ft_execute_tet2cheb(TP, A, N/2, L, M);
+        ft_execute_cheb2tet(TP, A, N/2, L, M);
+        printf("%1.2e\n", ft_norm_2arg(A, B, N/2*L*M)/ft_norm_1arg(B, N/2*L*M));
+        free(A);
+        free(B);
+        ft_destroy_tetrahedral_harmonic_plan(TP);
+    }
+    printf("];\n");
+
+    printf("\nTesting spherical harmonic transforms of one parity.\n\n");
+    printf("err15 = [\n");
+    for (int i = 0; i < IERR; i++) {
+        N = 16*pow(2, i)+J;
+        M = 2*N-1;
+        P = ft_plan_sph2fourier(N);
+        for (int parity = FT_PARITY_EVEN; parity <= FT_PARITY_ODD; parity++) {
+            A = sphrand(N, M);
+            for (int j = 0; j < M; j++)
+                for (int k = 2-parity; k < N; k += 2)
+                    A[k+N*j] = 0.0;
+            B = copymat(A, N, M);
+            Ac = copymat(A, N, M);
+            ft_execute_sph2fourier(P, A, N, M);
+            ft_execute_sph2fourier_parity(P, B, N, M, parity);
+            printf("%1.2e  ", ft_norm_2arg(A, B, N*M)/ft_norm_1arg(A, N*M));
+            ft_execute_fourier2sph_parity(P, B, N, M, parity);
+            printf("%1.2e  ", ft_norm_2arg(B, Ac, N*M)/ft_norm_1arg(Ac, N*M));
+            free(A);
+            free(B);
+            free(Ac);
+        }
+        A = sphrand(N, M);
+        B = copymat(A, N, M);
+        ft_execute_sph2fourier(P, A, N, M);
+        ft_execute_sph2fourier_parity(P, B, N, M, FT_PARITY_BOTH);
+        printf("%1.2e\n", ft_norm_2arg(A, B, N*M)/ft_norm_1arg(A, N*M));
+        free(A);
+        free(B);
+        ft_destroy_harmonic_plan(P);
+    }
+    printf("];\n");
+
+    printf("\nTesting harmonic plans with FMM connections against dense ones.\n\n");
+    printf("err16 = [\n");
+    for (int i = 0; i < IERR; i++) {
+        N = 256*pow(2, i)+J;
+
+        M = 2*N-1;
+        A = sphrand(N, M);
+        B = copymat(A, N, M);
+        Ac = copymat(A, N, M);
+        P = ft_plan_sph2fourier_with_flags(N, FT_HARMONIC_FMM);
+        ft_harmonic_plan * Q = ft_plan_sph2fourier_with_flags(N, FT_HARMONIC_DENSE);
+        ft_execute_sph2fourier(P, A, N, M);
+        ft_execute_sph2fourier(Q, B, N, M);
+        printf("%1.2e  ", ft_norm_2arg(A, B, N*M)/ft_norm_1arg(B, N*M));
+        // More threads than the factorizations were built for.
+        ft_set_harmonic_plan_num_threads(P, 2*ft_get_num_threads()+1);
+        ft_execute_fourier2sph(P, A, N, M);
+        printf("%1.2e  ", ft_norm_2arg(A, Ac, N*M)/ft_norm_1arg(Ac, N*M));
+        free(A);
+        free(B);
+        free(Ac);
+        ft_destroy_harmonic_plan(P);
+        ft_destroy_harmonic_plan(Q);
+
+        M = N;
+        A = trirand(N, M);
+        B = copymat(A, N, M);
+        Ac = copymat(A, N, M);
+        P = ft_plan_tri2cheb_with_flags(N, alpha, beta, gamma, FT_HARMONIC_FMM);
+        Q = ft_plan_tri2cheb_with_flags(N, alpha, beta, gamma, FT_HARMONIC_DENSE);
+        ft_execute_tri2cheb(P, A, N, M);
+        ft_execute_tri2cheb(Q, B, N, M);
+        printf("%1.2e  ", ft_norm_2arg(A, B, N*M)/ft_norm_1arg(B, N*M));
+        ft_execute_cheb2tri(P, A, N, M);
+        printf("%1.2e  ", ft_norm_2arg(A, Ac, N*M)/ft_norm_1arg(Ac, N*M));
+        free(A);
+        free(B);
+        free(Ac);
+        ft_destroy_harmonic_plan(P);
+        ft_destroy_harmonic_plan(Q);
+
+        M = 4*N-3;
+        A = diskrand(N, M);
+        B = copymat(A, N, M);
+        Ac = copymat(A, N, M);
+        P = ft_plan_disk2cxf_with_flags(N, FT_HARMONIC_FMM);
+        Q = ft_plan_disk2cxf_with_flags(N, FT_HARMONIC_DENSE);
+        ft_execute_disk2cxf(P, A, N, M);
+        ft_execute_disk2cxf(Q, B, N, M);
+        printf("%1.2e  ", ft_norm_2arg(A, B, N*M)/ft_norm_1arg(B, N*M));
+        ft_execute_cxf2disk(P, A, N, M);
+        printf("%1.2e  ", ft_norm_2arg(A, Ac, N*M)/ft_norm_1arg(Ac, N*M));
+        free(A);
+        free(B);
+        free(Ac);
+        ft_destroy_harmonic_plan(P);
+        ft_destroy_harmonic_plan(Q);
+
+        L = M = N/4;
+        A = tetrand(N/4, L, M);
+        B = copymat(A, N/4, L*M);
+        Ac = copymat(A, N/4, L*M);
+        TP = ft_plan_tet2cheb_with_flags(N/4, alpha, beta, gamma, delta, FT_HARMONIC_FMM);
+        ft_tetrahedral_harmonic_plan * TQ = ft_plan_tet2cheb_with_flags(N/4, alpha, beta, gamma, delta, FT_HARMONIC_DENSE);
+        ft_execute_tet2cheb(TP, A, N/4, L, M);
+        ft_execute_tet2cheb(TQ, B, N/4, L, M);
+        printf("%1.2e  ", ft_norm_2arg(A, B, N/4*L*M)/ft_norm_1arg(B, N/4*L*M));
+        ft_execute_cheb2tet(TP, A, N/4, L, M);
+        printf("%1.2e\n", ft_norm_2arg(A, Ac, N/4*L*M)/ft_norm_1arg(Ac, N/4*L*M));
+        free(A);
+        free(B);
+        free(Ac);
+        ft_destroy_tetrahedral_harmonic_plan(TP);
+        ft_destroy_tetrahedral_harmonic_plan(TQ);
+    }
+    printf("];\n");
+
+    printf("\nTesting harmonic plans that share their components through the plan cache.\n\n");
+    printf("err17 = [\n");
+    for (int i = 0; i < IERR; i++) {
+        N = 64*pow(2, i)+J;
+        M = N;
+        A = trirand(N, M);
+        B = copymat(A, N, M);
+        ft_harmonic_plan * Q = ft_plan_tri2cheb(N, alpha, beta, gamma);
+        ft_set_plan_cache_budget(((size_t) 1) << 30);
+        P = ft_plan_tri2cheb(N, alpha, beta, gamma);
+        ft_harmonic_plan * R = ft_plan_tri2cheb(N, alpha, beta, gamma);
+        printf("%d  ", P->RP == R->RP && P->P1 == R->P1 && P->P2inv == R->P2inv && P->RP != Q->RP);
+        ft_execute_tri2cheb(R, A, N, M);
+        ft_execute_tri2cheb(Q, B, N, M);
+        printf("%1.2e  ", ft_norm_2arg(A, B, N*M)/ft_norm_1arg(B, N*M));
+        ft_destroy_harmonic_plan(P);
+        ft_destroy_harmonic_plan(R);
+        R = ft_plan_tri2cheb(N, alpha, beta, gamma);
+        ft_execute_cheb2tri(R, A, N, M);
+        ft_execute_cheb2tri(Q, B, N, M);
+        printf("%1.2e  ", ft_norm_2arg(A, B, N*M)/ft_norm_1arg(B, N*M));
+        ft_destroy_harmonic_plan(R);
+        ft_destroy_harmonic_plan(Q);
+        printf("%d  ", ft_get_plan_cache_size() > 0);
+        ft_set_plan_cache_budget(0);
+        printf("%d\n", ft_get_plan_cache_size() == 0);
+        free(A);
+        free(B);
+    }
+    printf("];\n");
+
+    printf("\nTesting harmonic plans saved to and mapped from plan files.\n\n");
+    printf("err18 = [\n");
+    for (int i = 0; i < IERR; i++) {
+        N = 256*pow(2, i)+J;
+        for (int k = 0; k < 2; k++) {
+            int flags = k ? FT_HARMONIC_FMM : FT_HARMONIC_DENSE;
+            M = N;
+            A = trirand(N, M);
+            B = copymat(A, N, M);
+            P = ft_plan_tri2cheb_with_flags(N, alpha, beta, gamma, flags);
+            ft_save_harmonic_plan(P, "test_drivers.ftplan");
+            ft_plan_file * PF = ft_open_plan_file("test_drivers.ftplan");
+            ft_harmonic_plan * Q = ft_load_harmonic_plan(PF);
+            ft_execute_tri2cheb(P, A, N, M);
+            ft_execute_tri2cheb(Q, B, N, M);
+            printf("%1.2e  ", ft_norm_2arg(A, B, N*M)/ft_norm_1arg(A, N*M));
+            ft_execute_cheb2tri(P, A, N, M);
+            ft_set_harmonic_plan_streaming(Q, 1);
+            ft_execute_cheb2tri(Q, B, N, M);
+            printf("%1.2e  ", ft_norm_2arg(A, B, N*M)/ft_norm_1arg(A, N*M));
+            free(A);
+            free(B);
+            // The file keeps the components it mapped and owns the extended ones.
+            ft_extend_tri2cheb(P, N+64);
+            ft_extend_tri2cheb(Q, N+64);
+            M = N+64;
+            A = trirand(N+64, M);
+            B = copymat(A, N+64, M);
+            ft_execute_tri2cheb(P, A, N+64, M);
+            ft_execute_tri2cheb(Q, B, N+64, M);
+            printf("%1.2e  ", ft_norm_2arg(A, B, (N+64)*M)/ft_norm_1arg(A, (N+64)*M));
+            ft_close_plan_file(PF);
+            ft_destroy_harmonic_plan(P);
+            free(A);
+            free(B);
+        }
+        printf("\n");
+    }
+    remove("test_drivers.ftplan");
+    printf("];\n");
+
+    printf("\nTesting views of harmonic plans at smaller degrees.\n\n");
+    printf("err19 = [\n");
+    for (int i = 0; i < IERR; i++) {
+        N = 64*pow(2, i)+J;
+        ft_harmonic_plan * Q[3] = {ft_plan_sph2fourier_with_flags(2*N+1, FT_HARMONIC_DENSE), ft_plan_tri2cheb_with_flags(2*N+1, alpha, beta, gamma, FT_HARMONIC_DENSE), ft_plan_disk2cxf_with_flags(2*N+1, FT_HARMONIC_DENSE)};
+        P = ft_view_harmonic_plan(Q[0], N);
+        ft_harmonic_plan * R = ft_plan_sph2fourier_with_flags(N, FT_HARMONIC_DENSE);
+        M = 2*N-1;
+        A = sphrand(N, M);
+        B = copymat(A, N, M);
+        ft_execute_sph2fourier(P, A, N, M);
+        ft_execute_sph2fourier(R, B, N, M);
+        printf("%1.2e  ", ft_norm_2arg(A, B, N*M)/ft_norm_1arg(B, N*M));
+        ft_execute_fourier2sph(P, A, N, M);
+        ft_execute_fourier2sph(R, B, N, M);
+        printf("%1.2e  ", ft_norm_2arg(A, B, N*M)/ft_norm_1arg(B, N*M));
+        ft_destroy_harmonic_plan_view(P);
+        ft_destroy_harmonic_plan(R);
+        free(A);
+        free(B);
+        P = ft_view_harmonic_plan(Q[1], N);
+        R = ft_plan_tri2cheb_with_flags(N, alpha, beta, gamma, FT_HARMONIC_DENSE);
+        M = N;
+        A = trirand(N, M);
+        B = copymat(A, N, M);
+        ft_execute_tri2cheb(P, A, N, M);
+        ft_execute_tri2cheb(R, B, N, M);
+        printf("%1.2e  ", ft_norm_2arg(A, B, N*M)/ft_norm_1arg(B, N*M));
+        ft_execute_cheb2tri(P, A, N, M);
+        ft_execute_cheb2tri(R, B, N, M);
+        printf("%1.2e  ", ft_norm_2arg(A, B, N*M)/ft_norm_1arg(B, N*M));
+        ft_destroy_harmonic_plan_view(P);
+        ft_destroy_harmonic_plan(R);
+        free(A);
+        free(B);
+        P = ft_view_harmonic_plan(Q[2], N);
+        R = ft_plan_disk2cxf_with_flags(N, FT_HARMONIC_DENSE);
+        M = 4*N-3;
+        A = diskrand(N, M);
+        B = copymat(A, N, M);
+        ft_execute_disk2cxf(P, A, N, M);
+        ft_execute_disk2cxf(R, B, N, M);
+        printf("%1.2e  ", ft_norm_2arg(A, B, N*M)/ft_norm_1arg(B, N*M));
+        ft_execute_cxf2disk(P, A, N, M);
+        ft_execute_cxf2disk(R, B, N, M);
+        printf("%1.2e\n", ft_norm_2arg(A, B, N*M)/ft_norm_1arg(B, N*M));
+        ft_destroy_harmonic_plan_view(P);
+        ft_destroy_harmonic_plan(R);
+        free(A);
+        free(B);
+        for (int k = 0; k < 3; k++)
+            ft_destroy_harmonic_plan(Q[k]);
+    }
+    printf("];\n");
+
+    printf("\nTesting harmonic plans extended to higher degrees.\n\n");
+    printf("err20 = [\n");
+    for (int i = 0; i < IERR; i++) {
+        N = 64*pow(2, i)+J;
+        ft_set_plan_cache_budget(((size_t) 1) << 30);
+        ft_harmonic_plan * Q[3] = {ft_plan_sph2fourier_with_flags(N/2, FT_HARMONIC_DENSE), ft_plan_tri2cheb_with_flags(N/2, alpha, beta, gamma, FT_HARMONIC_DENSE), ft_plan_disk2cxf_with_flags(N/2, FT_HARMONIC_DENSE)};
+        ft_harmonic_plan * R = ft_plan_tri2cheb_with_flags(N/2, alpha, beta, gamma, FT_HARMONIC_DENSE);
+        ft_extend_sph2fourier(Q[0], N);
+        ft_extend_tri2cheb(Q[1], N);
+        ft_extend_disk2cxf(Q[2], N);
+        ft_set_plan_cache_budget(0);
+        P = ft_plan_sph2fourier_with_flags(N, FT_HARMONIC_DENSE);
+        M = 2*N-1;
+        A = sphrand(N, M);
+        B = copymat(A, N, M);
+        ft_execute_sph2fourier(Q[0], A, N, M);
+        ft_execute_sph2fourier(P, B, N, M);
+        printf("%1.2e  ", ft_norm_2arg(A, B, N*M)/ft_norm_1arg(B, N*M));
+        ft_execute_fourier2sph(Q[0], A, N, M);
+        ft_execute_fourier2sph(P, B, N, M);
+        printf("%1.2e  ", ft_norm_2arg(A, B, N*M)/ft_norm_1arg(B, N*M));
+        ft_destroy_harmonic_plan(P);
+        free(A);
+        free(B);
+        P = ft_plan_tri2cheb_with_flags(N, alpha, beta, gamma, FT_HARMONIC_DENSE);
+        M = N;
+        A = trirand(N, M);
+        B = copymat(A, N, M);
+        ft_execute_tri2cheb(Q[1], A, N, M);
+        ft_execute_tri2cheb(P, B, N, M);
+        printf("%1.2e  ", ft_norm_2arg(A, B, N*M)/ft_norm_1arg(B, N*M));
+        ft_execute_cheb2tri(Q[1], A, N, M);
+        ft_execute_cheb2tri(P, B, N, M);
+        printf("%1.2e  ", ft_norm_2arg(A, B, N*M)/ft_norm_1arg(B, N*M));
+        ft_destroy_harmonic_plan(P);
+        free(A);
+        free(B);
+        P = ft_plan_tri2cheb_with_flags(N/2, alpha, beta, gamma, FT_HARMONIC_DENSE);
+        A = trirand(N/2, N/2);
+        B = copymat(A, N/2, N/2);
+        ft_execute_tri2cheb(R, A, N/2, N/2);
+        ft_execute_tri2cheb(P, B, N/2, N/2);
+        printf("%1.2e  ", ft_norm_2arg(A, B, N/2*(N/2))/ft_norm_1arg(B, N/2*(N/2)));
+        ft_destroy_harmonic_plan(P);
+        ft_destroy_harmonic_plan(R);
+        free(A);
+        free(B);
+        P = ft_plan_disk2cxf_with_flags(N, FT_HARMONIC_DENSE);
+        M = 4*N-3;
+        A = diskrand(N, M);
+        B = copymat(A, N, M);
+        ft_execute_disk2cxf(Q[2], A, N, M);
+        ft_execute_disk2cxf(P, B, N, M);
+        printf("%1.2e  ", ft_norm_2arg(A, B, N*M)/ft_norm_1arg(B, N*M));
+        ft_execute_cxf2disk(Q[2], A, N, M);
+        ft_execute_cxf2disk(P, B, N, M);
+        printf("%1.2e\n", ft_norm_2arg(A, B, N*M)/ft_norm_1arg(B, N*M));
+        ft_destroy_harmonic_plan(P);
+        free(A);
+        free(B);
+        for (int k = 0; k < 3; k++)
+            ft_destroy_harmonic_plan(Q[k]);
+    }
+    printf("];\n");
+
+    printf("\nTesting out-of-core execution against in-core execution.\n\n");
+    printf("err21 = [\n");
+    size_t block = ft_get_out_of_core_block_size();
+    for (int i = 0; i < IERR; i++) {
+        N = 64*pow(2, i)+J;
+        M = 2*N-1;
+        // Windows of 48 columns and a header before the array exercise the seams between windows.
+        ft_set_out_of_core_block_size(48*N*sizeof(double));
+        A = sphrand(N, M);
+        B = copymat(A, N, M);
+        Ac = copymat(A, N, M);
+        P = ft_plan_sph2fourier(N);
+        write_test_array("test_drivers.ftarray", A, N*M);
+        Ac = map_test_array("test_drivers_mapped.ftarray", A, N*M);
+        ft_execute_sph2fourier(P, A, N, M);
+        ft_execute_sph2fourier_file(P, "test_drivers.ftarray", 8*sizeof(double), N, M);
+        ft_execute_sph2fourier_mapped(P, Ac, N, M);
+        read_test_array("test_drivers.ftarray", B, N*M);
+        printf("%1.2e  ", ft_norm_2arg(A, B, N*M)/ft_norm_1arg(A, N*M));
+        printf("%1.2e  ", ft_norm_2arg(A, Ac, N*M)/ft_norm_1arg(A, N*M));
+        ft_execute_fourier2sph(P, A, N, M);
+        ft_execute_fourier2sph_file(P, "test_drivers.ftarray", 8*sizeof(double), N, M);
+        ft_execute_fourier2sph_mapped(P, Ac, N, M);
+        read_test_array("test_drivers.ftarray", B, N*M);
+        printf("%1.2e  ", ft_norm_2arg(A, B, N*M)/ft_norm_1arg(A, N*M));
+        printf("%1.2e  ", ft_norm_2arg(A, Ac, N*M)/ft_norm_1arg(A, N*M));
+        ft_destroy_harmonic_plan(P);
+        unmap_test_array(Ac, N*M);
+        ft_tb_eigen_FMM * F = ft_plan_legendre_to_chebyshev(1, 1, N);
+        ft_set_out_of_core_block_size(5*N*sizeof(double));
+        write_test_array("test_drivers.ftarray", A, N*M);
+        Ac = map_test_array("test_drivers_mapped.ftarray", A, N*M);
+        ft_bfmm('N', F, A, N, M);
+        ft_bfmm_file('N', F, "test_drivers.ftarray", 8*sizeof(double), M);
+        ft_bfmm_mapped('N', F, Ac, M);
+        read_test_array("test_drivers.ftarray", B, N*M);
+        printf("%1.2e  ", ft_norm_2arg(A, B, N*M)/ft_norm_1arg(A, N*M));
+        printf("%1.2e\n", ft_norm_2arg(A, Ac, N*M)/ft_norm_1arg(A, N*M));
+        ft_destroy_tb_eigen_FMM(F);
+        unmap_test_array(Ac, N*M);
+        free(A);
+        free(B);
+    }
+    ft_set_out_of_core_block_size(block);
+    remove("test_drivers.ftarray");
+    remove("test_drivers_mapped.ftarray");
+    printf("];\n");
+
     return 0;
 }
 
@@ -1100,3 +1654,50 @@ double * aligned_copymat(double * A, int n, int m) {
             B[(i)+VALIGN(n)*(j)] = 0.0;
     return B;
 }
+
+// The out-of-core arrays follow a header of 8 doubles in their files.
+void write_test_array(const char * filename, const double * A, const size_t n) {
+    FILE * fp = fopen(filename, "wb");
+    if (fp == NULL || fwrite(A, sizeof(double), 8, fp) != 8 || fwrite(A, sizeof(double), n, fp) != n || fclose(fp) != 0) {
+        printf("Cannot write %s.\n", filename);
+        exit(EXIT_FAILURE);
+    }
+}
+
+void read_test_array(const char * filename, double * A, const size_t n) {
+    FILE * fp = fopen(filename, "rb");
+    if (fp == NULL || fseek(fp, 8*sizeof(double), SEEK_SET) != 0 || fread(A, sizeof(double), n, fp) != n) {
+        printf("Cannot read %s.\n", filename);
+        exit(EXIT_FAILURE);
+    }
+    fclose(fp);
+}
+
+// A shared mapping of the array written to filename, so that the mapped drivers write through
+// to the file. Without mmap, it is a copy in memory.
+double * map_test_array(const char * filename, const double * A, const size_t n) {
+    #ifdef _WIN32
+        double * B = malloc(n*sizeof(double));
+        for (size_t k = 0; k < n; k++)
+            B[k] = A[k];
+        return B;
+    #else
+        write_test_array(filename, A, n);
+        int fd = open(filename, O_RDWR);
+        double * B = fd < 0 ? MAP_FAILED : mmap(NULL, (8+n)*sizeof(double), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (B == MAP_FAILED) {
+            printf("Cannot map %s.\n", filename);
+            exit(EXIT_FAILURE);
+        }
+        close(fd);
+        return B+8;
+    #endif
+}
+
+void unmap_test_array(double * A, const size_t n) {
+    #ifdef _WIN32
+        free(A);
+    #else
+        munmap(A-8, (8+n)*sizeof(double));
+    #endif
+}
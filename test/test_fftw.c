@@ -382,5 +382,72 @@ int main(int argc, const char * argv[]) {
     }
     printf("];\n");
 
+    printf("\nTesting spherical and triangular harmonic transforms + FFTW synthesis on arrays with a leading dimension.\n\n");
+    printf("err6 = [\n");
+    for (int i = 0; i < IERR; i++) {
+        N = 64*pow(2, i)+J;
+        int LDA = N+3;
+        double * C;
+
+        M = 2*N-1;
+        A = sphrand(N, M);
+        B = copymat(A, N, M);
+        C = calloc(LDA*M, sizeof(double));
+        for (int j = 0; j < M; j++)
+            for (int k = 0; k < N; k++)
+                C[k+j*LDA] = A[k+j*N];
+        P = ft_plan_sph2fourier(N);
+        PS = ft_plan_sph_synthesis(N, M);
+        PA = ft_plan_sph_synthesis_lda(N, M, LDA);
+
+        ft_execute_sph2fourier(P, A, N, M);
+        ft_execute_sph_synthesis(PS, A, N, M);
+        ft_execute_sph2fourier_lda(P, C, N, M, LDA);
+        ft_execute_sph_synthesis(PA, C, N, M);
+        for (int j = 0; j < M; j++)
+            for (int k = 0; k < N; k++)
+                B[k+j*N] = C[k+j*LDA];
+
+        printf("%1.2e  ", ft_norm_2arg(A, B, N*M)/ft_norm_1arg(A, N*M));
+        printf("%1.2e  ", ft_normInf_2arg(A, B, N*M)/ft_normInf_1arg(A, N*M));
+
+        free(A);
+        free(B);
+        free(C);
+        ft_destroy_harmonic_plan(P);
+        ft_destroy_sphere_fftw_plan(PS);
+        ft_destroy_sphere_fftw_plan(PA);
+
+        M = N;
+        A = trirand(N, M);
+        B = copymat(A, N, M);
+        C = calloc(LDA*M, sizeof(double));
+        for (int j = 0; j < M; j++)
+            for (int k = 0; k < N; k++)
+                C[k+j*LDA] = A[k+j*N];
+        P = ft_plan_tri2cheb(N, alpha, beta, gamma);
+        QS = ft_plan_tri_synthesis(N, M);
+        QA = ft_plan_tri_synthesis_lda(N, M, LDA);
+
+        ft_execute_tri2cheb(P, A, N, M);
+        ft_execute_tri_synthesis(QS, A, N, M);
+        ft_execute_tri2cheb_lda(P, C, N, M, LDA);
+        ft_execute_tri_synthesis(QA, C, N, M);
+        for (int j = 0; j < M; j++)
+            for (int k = 0; k < N; k++)
+                B[k+j*N] = C[k+j*LDA];
+
+        printf("%1.2e  ", ft_norm_2arg(A, B, N*M)/ft_norm_1arg(A, N*M));
+        printf("%1.2e\n", ft_normInf_2arg(A, B, N*M)/ft_normInf_1arg(A, N*M));
+
+        free(A);
+        free(B);
+        free(C);
+        ft_destroy_harmonic_plan(P);
+        ft_destroy_triangle_fftw_plan(QS);
+        ft_destroy_triangle_fftw_plan(QA);
+    }
+    printf("];\n");
+
     return 0;
 }
@@ -112,6 +112,19 @@ void Y(test_tdc)(int * checksum) {
     printf("Numerical error in FMM'ed tdc ||VᵀAV - Λ|| / ||Λ|| \t |%20.2e ", (double) err);
     X(checktest)(err, n*n, checksum);
 
+    X(save_tdc_eigen)(F, "test_tdc_eigen.ftplan");
+    ft_plan_file * PF = ft_open_plan_file("test_tdc_eigen.ftplan");
+    X(tdc_eigen) * G = X(load_tdc_eigen)(PF);
+    for (int j = 0; j < n; j++) {
+        X(tdmv)('N', 1, F, Id+j*n, 0, V+j*n);
+        X(tdmv)('N', 1, G, Id+j*n, 0, VtAV+j*n);
+    }
+    err = X(norm_2arg)(VtAV, V, n*n)/X(norm_1arg)(V, n*n);
+    printf("Comparison of a saved and mapped tdc with the original \t |%20.2e ", (double) err);
+    X(checktest)(err, 1, checksum);
+    ft_close_plan_file(PF);
+    remove("test_tdc_eigen.ftplan");
+
     X(destroy_symmetric_tridiagonal)(T);
     X(destroy_symmetric_tridiagonal)(S);
     X(destroy_tdc_eigen)(F);
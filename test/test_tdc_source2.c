@@ -129,6 +129,124 @@ void X(inner_test_tdc_drop_precision)(int * checksum, int n) {
     free(VtBV);
 }
 
+X2(symmetric_dpr1) * X(test_drop_precision_dpr1)(int n) {
+    X2(symmetric_dpr1) * A = malloc(sizeof(X2(symmetric_dpr1)));
+    A->d = malloc(n*sizeof(*A->d));
+    A->z = malloc(n*sizeof(*A->z));
+    for (int i = 0; i < n; i++) {
+        A->d[i] = (i+1)*(i+2);
+        A->z[i] = i+1;
+    }
+    A->rho = 1.0;
+    A->n = n;
+    return A;
+}
+
+// The variants that destroy the extended precision factorization must drop it to the same one.
+void X(inner_test_drop_precision_destroy)(int * checksum, int n) {
+    X2(symmetric_tridiagonal) * T2 = X2(create_A_shtsdtev)(n, n/2, 0, 'E');
+    X2(symmetric_tridiagonal) * S2 = X2(create_B_shtsdtev)(n, 0, 'E');
+    FLT * x = malloc(n*sizeof(FLT));
+    FLT * y = malloc(n*sizeof(FLT));
+    FLT * z = malloc(n*sizeof(FLT));
+    for (int i = 0; i < n; i++)
+        x[i] = 1.0/(i+1);
+    FLT err;
+
+    X2(tdc_eigen) * F2 = X2(sdtdc_eig)(T2, S2);
+    X(tdc_eigen) * F = X(drop_precision_tdc_eigen)(F2);
+    X(tdc_eigen) * G = X(drop_precision_destroy_tdc_eigen)(F2);
+    X(tdmv)('N', 1, F, x, 0, y);
+    X(tdmv)('N', 1, G, x, 0, z);
+    err = X(norm_2arg)(y, z, n)/X(norm_1arg)(y, n);
+    printf("Destroying and copying drop in tdc \t\t\t |%20.2e ", (double) err);
+    X(checktest)(err, 1, checksum);
+    X(destroy_tdc_eigen)(F);
+    X(destroy_tdc_eigen)(G);
+
+    X2(tdc_eigen_FMM) * HF2 = X2(sdtdc_eig_FMM)(T2, S2);
+    X(tdc_eigen_FMM) * HF = X(drop_precision_tdc_eigen_FMM)(HF2);
+    X(tdc_eigen_FMM) * HG = X(drop_precision_destroy_tdc_eigen_FMM)(HF2);
+    X(tfmv)('N', 1, HF, x, 0, y);
+    X(tfmv)('N', 1, HG, x, 0, z);
+    err = X(norm_2arg)(y, z, n)/X(norm_1arg)(y, n);
+    printf("Destroying and copying drop in FMM'ed tdc \t\t |%20.2e ", (double) err);
+    X(checktest)(err, 1, checksum);
+    X(destroy_tdc_eigen_FMM)(HF);
+    X(destroy_tdc_eigen_FMM)(HG);
+
+    X2(symmetric_dpr1) * A2 = X(test_drop_precision_dpr1)(n);
+    X2(symmetric_dpr1_eigen) * D2 = X2(symmetric_dpr1_eig)(A2);
+    X(symmetric_dpr1_eigen) * D = X(drop_precision_symmetric_dpr1_eigen)(D2);
+    X(symmetric_dpr1_eigen) * E = X(drop_precision_destroy_symmetric_dpr1_eigen)(D2);
+    X(dvmv)('N', 1, D, x, 0, y);
+    X(dvmv)('N', 1, E, x, 0, z);
+    err = X(norm_2arg)(y, z, n)/X(norm_1arg)(y, n);
+    printf("Destroying and copying drop in dpr1 \t\t\t |%20.2e ", (double) err);
+    X(checktest)(err, 1, checksum);
+    X(destroy_symmetric_dpr1_eigen)(D);
+    X(destroy_symmetric_dpr1_eigen)(E);
+    X2(destroy_symmetric_dpr1)(A2);
+
+    A2 = X(test_drop_precision_dpr1)(n);
+    X2(symmetric_dpr1_eigen_FMM) * HD2 = X2(symmetric_dpr1_eig_FMM)(A2);
+    X(symmetric_dpr1_eigen_FMM) * HD = X(drop_precision_symmetric_dpr1_eigen_FMM)(HD2);
+    X(symmetric_dpr1_eigen_FMM) * HE = X(drop_precision_destroy_symmetric_dpr1_eigen_FMM)(HD2);
+    X(dfmv)('N', 1, HD, x, 0, y);
+    X(dfmv)('N', 1, HE, x, 0, z);
+    err = X(norm_2arg)(y, z, n)/X(norm_1arg)(y, n);
+    printf("Destroying and copying drop in FMM'ed dpr1 \t\t |%20.2e ", (double) err);
+    X(checktest)(err, 1, checksum);
+    X(destroy_symmetric_dpr1_eigen_FMM)(HD);
+    X(destroy_symmetric_dpr1_eigen_FMM)(HE);
+    X2(destroy_symmetric_dpr1)(A2);
+
+    X2(destroy_symmetric_tridiagonal)(T2);
+    X2(destroy_symmetric_tridiagonal)(S2);
+    free(x);
+    free(y);
+    free(z);
+}
+
+// An integer shift in the Jacobi parameters is a banded plan, whose banded factor is dropped as it is.
+void X(inner_test_drop_precision_banded)(int * checksum, int n) {
+    FLT * x = malloc(n*sizeof(FLT));
+    FLT * y = malloc(n*sizeof(FLT));
+    FLT * z = malloc(n*sizeof(FLT));
+    for (int i = 0; i < n; i++)
+        x[i] = y[i] = z[i] = 1.0/(i+1);
+    FLT err;
+
+    X(tb_eigen_FMM) * F = X(plan_jacobi_to_jacobi)(1, 1, n, -0.25, 0.5, 1.75, 1.5);
+    X2(tb_eigen_FMM) * F2 = X2(plan_jacobi_to_jacobi)(1, 1, n, -0.25, 0.5, 1.75, 1.5);
+    X(tb_eigen_FMM) * G = X(drop_precision_tb_eigen_FMM)(F2);
+    X(bfmv)('N', F, y);
+    X(bfmv)('N', G, z);
+    err = X(norm_2arg)(y, z, n)/X(norm_1arg)(y, n);
+    printf("Comparison of a dropped and a banded plan \t\t |%20.2e ", (double) err);
+    X(checktest)(err, 8*Y(sqrt)(n), checksum);
+    X(bfsv)('N', G, z);
+    err = X(norm_2arg)(x, z, n)/X(norm_1arg)(x, n);
+    printf("Error in the dropped banded solve \t\t\t |%20.2e ", (double) err);
+    X(checktest)(err, 8*Y(sqrt)(n), checksum);
+
+    X(tb_eigen_FMM) * H = X(drop_precision_destroy_tb_eigen_FMM)(F2);
+    for (int i = 0; i < n; i++)
+        y[i] = z[i] = 1.0/(i+1);
+    X(bfmv)('T', G, y);
+    X(bfmv)('T', H, z);
+    err = X(norm_2arg)(y, z, n)/X(norm_1arg)(y, n);
+    printf("Destroying and copying drop in a banded plan \t\t |%20.2e ", (double) err);
+    X(checktest)(err, 1, checksum);
+
+    X(destroy_tb_eigen_FMM)(F);
+    X(destroy_tb_eigen_FMM)(G);
+    X(destroy_tb_eigen_FMM)(H);
+    free(x);
+    free(y);
+    free(z);
+}
+
 void Y(test_tdc_drop_precision)(int * checksum) {
     printf("\t\t\t Test \t\t\t\t | 2-norm Relative Error\n");
     printf("---------------------------------------------------------|----------------------\n");
@@ -137,4 +255,7 @@ void Y(test_tdc_drop_precision)(int * checksum) {
 
     for (int n = nmin; n < nmax; n *= 2)
         X(inner_test_tdc_drop_precision)(checksum, n);
+
+    X(inner_test_drop_precision_destroy)(checksum, nmin);
+    X(inner_test_drop_precision_banded)(checksum, nmin);
 }
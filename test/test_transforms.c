@@ -56,6 +56,252 @@ int main(void) {
         free(Pnc1);
         free(colsum);
     }
+    for (int c = 1; c < 9; c += 3) {
+        n = 1024;
+        double * V = plan_associated_jacobi_to_jacobi(1, n, c, 0.5, -0.25, -0.125, 0.75);
+        ft_tb_eigen_FMM * F = ft_plan_associated_jacobi_to_jacobi(1, n, c, 0.5, -0.25, -0.125, 0.75);
+        double * x = malloc(n*sizeof(double));
+        double * y = malloc(n*sizeof(double));
+        double * z = malloc(n*sizeof(double));
+        for (int i = 0; i < n; i++)
+            x[i] = y[i] = z[i] = 1.0/(i+1);
+        cblas_dtrmv(CblasColMajor, CblasUpper, CblasNoTrans, CblasNonUnit, n, V, n, y, 1);
+        ft_bfmv('N', F, z);
+        double err = ft_norm_2arg(y, z, n)/ft_norm_1arg(y, n);
+        printf("Comparison of associated FMM and dense plans (c = %i) \t |%20.2e ", c, err);
+        ft_checktest(err, 8*sqrt(n), &checksum);
+        ft_bfsv('N', F, z);
+        err = ft_norm_2arg(x, z, n)/ft_norm_1arg(x, n);
+        printf("Error in the associated FMM solve (c = %i) \t\t |%20.2e ", c, err);
+        ft_checktest(err, 8*sqrt(n), &checksum);
+        ft_destroy_tb_eigen_FMM(F);
+        free(V);
+        free(x);
+        free(y);
+        free(z);
+    }
+    printf("\n\tBanded plans for integer shifts.\n\n");
+    n = 1024;
+    for (int norm = 0; norm < 4; norm++) {
+        int norm1 = norm&1, norm2 = norm>>1;
+        for (int t = 0; t < 4; t++) {
+            double alpha = -0.25, beta = 0.5, lambda = 0.75;
+            int k[4] = {1, 2, 0, 1}, l[4] = {1, 0, 1, 0};
+            double * V = t < 3 ? plan_jacobi_to_jacobi(norm1, norm2, n, alpha, beta, alpha+k[t], beta+l[t]) : plan_ultraspherical_to_ultraspherical(norm1, norm2, n, lambda, lambda+2);
+            ft_tb_eigen_FMM * F = t < 3 ? ft_plan_jacobi_to_jacobi(norm1, norm2, n, alpha, beta, alpha+k[t], beta+l[t]) : ft_plan_ultraspherical_to_ultraspherical(norm1, norm2, n, lambda, lambda+2);
+            double * x = malloc(n*sizeof(double));
+            double * y = malloc(n*sizeof(double));
+            double * z = malloc(n*sizeof(double));
+            for (int i = 0; i < n; i++)
+                x[i] = y[i] = z[i] = 1.0/(i+1);
+            cblas_dtrmv(CblasColMajor, CblasUpper, CblasNoTrans, CblasNonUnit, n, V, n, y, 1);
+            ft_bfmv('N', F, z);
+            double err = ft_norm_2arg(y, z, n)/ft_norm_1arg(y, n);
+            printf("Comparison of banded and dense plans (%i, %i, t = %i) \t |%20.2e ", norm1, norm2, t, err);
+            ft_checktest(err, 8*sqrt(n), &checksum);
+            ft_bfsv('N', F, z);
+            err = ft_norm_2arg(x, z, n)/ft_norm_1arg(x, n);
+            printf("Error in the banded solve (%i, %i, t = %i) \t\t |%20.2e ", norm1, norm2, t, err);
+            ft_checktest(err, 8*sqrt(n), &checksum);
+            int howmany = 5;
+            double * A = malloc(n*howmany*sizeof(double));
+            double * B = malloc(n*howmany*sizeof(double));
+            err = 0;
+            for (int l = 0; l < 4; l++) {
+                char TRANS = l&1 ? 'T' : 'N';
+                for (int i = 0; i < n*howmany; i++)
+                    A[i] = B[i] = 1.0/(i%n+1+i/n);
+                if (l < 2)
+                    ft_bfmv_many(TRANS, F, A, 1, n, howmany);
+                else
+                    ft_bfsv_many(TRANS, F, A, 1, n, howmany);
+                for (int j = 0; j < howmany; j++) {
+                    if (l < 2)
+                        ft_bfmv(TRANS, F, B+j*n);
+                    else
+                        ft_bfsv(TRANS, F, B+j*n);
+                }
+                err += ft_norm_2arg(A, B, n*howmany)/ft_norm_1arg(B, n*howmany);
+            }
+            printf("Batched and one-by-one banded plans (%i, %i, t = %i) \t |%20.2e ", norm1, norm2, t, err);
+            ft_checktest(err, 1, &checksum);
+            ft_save_tb_eigen_FMM(F, "test_transforms.ftplan");
+            ft_plan_file * PF = ft_open_plan_file("test_transforms.ftplan");
+            ft_tb_eigen_FMM * G = ft_load_tb_eigen_FMM(PF);
+            for (int i = 0; i < n; i++)
+                y[i] = z[i] = 1.0/(i+1);
+            ft_bfmv('N', F, y);
+            ft_bfmv('N', G, z);
+            err = ft_norm_2arg(y, z, n)/ft_norm_1arg(y, n);
+            printf("Saved and mapped banded plans (%i, %i, t = %i) \t\t |%20.2e ", norm1, norm2, t, err);
+            ft_checktest(err, 1, &checksum);
+            ft_close_plan_file(PF);
+            remove("test_transforms.ftplan");
+            free(A);
+            free(B);
+            ft_destroy_tb_eigen_FMM(F);
+            free(V);
+            free(x);
+            free(y);
+            free(z);
+        }
+    }
+    printf("\n\tComposite plans.\n\n");
+    for (n = 64; n < 2048; n *= 4) {
+        ft_tb_eigen_FMM * P[3] = {ft_plan_jacobi_to_jacobi(1, 1, n, 0.0, 0.0, 0.5, -0.25), ft_plan_jacobi_to_jacobi(1, 1, n, 0.5, -0.25, 1.0, 0.5), ft_plan_ultraspherical_to_ultraspherical(1, 1, n, 1.25, 1.5)};
+        double * d = malloc(n*sizeof(double));
+        for (int i = 0; i < n; i++)
+            d[i] = 1.0/(i+1.0);
+        double * D[3] = {d, NULL, d};
+        ft_tb_eigen_FMM * V = ft_plan_composite(3, P, D);
+        double * x = malloc(n*sizeof(double));
+        double * y = malloc(n*sizeof(double));
+        for (int i = 0; i < n; i++)
+            x[i] = y[i] = 1.0/(i+1);
+        for (int l = 0; l < 3; l++) {
+            ft_bfmv('N', P[l], x);
+            if (D[l] != NULL)
+                for (int i = 0; i < n; i++)
+                    x[i] *= D[l][i];
+        }
+        ft_bfmv('N', V, y);
+        double err = ft_norm_2arg(x, y, n)/ft_norm_1arg(x, n);
+        printf("Comparison of a composite plan and its chain \t (n = %4i) |%20.2e ", n, err);
+        ft_checktest(err, 8*sqrt(n), &checksum);
+        for (int i = 0; i < n; i++)
+            x[i] = y[i] = 1.0/(i+1);
+        for (int l = 0; l < 3; l++) {
+            if (D[2-l] != NULL)
+                for (int i = 0; i < n; i++)
+                    x[i] *= D[2-l][i];
+            ft_bfmv('T', P[2-l], x);
+        }
+        ft_bfmv('T', V, y);
+        err = ft_norm_2arg(x, y, n)/ft_norm_1arg(x, n);
+        printf("Comparison of its transpose \t\t\t (n = %4i) |%20.2e ", n, err);
+        ft_checktest(err, 8*sqrt(n), &checksum);
+        for (int l = 0; l < 3; l++)
+            ft_destroy_tb_eigen_FMM(P[l]);
+        ft_destroy_tb_eigen_FMM(V);
+        free(d);
+        free(x);
+        free(y);
+    }
+    // The dense product would take 32 GB.
+    n = 65536;
+    {
+        ft_tb_eigen_FMM * P[3] = {ft_plan_jacobi_to_jacobi(1, 1, n, 0.0, 0.0, 1.0, 0.0), ft_plan_jacobi_to_jacobi(1, 1, n, 1.0, 0.0, 1.0, 1.0), ft_plan_legendre_to_chebyshev(1, 1, n)};
+        double * d = malloc(n*sizeof(double));
+        for (int i = 0; i < n; i++)
+            d[i] = 1.0/(i+1.0);
+        double * D[3] = {d, NULL, NULL};
+        ft_tb_eigen_FMM * V = ft_plan_composite(3, P, D);
+        double * x = malloc(n*sizeof(double));
+        double * y = malloc(n*sizeof(double));
+        for (int i = 0; i < n; i++)
+            x[i] = y[i] = 1.0/(i+1);
+        for (int l = 0; l < 3; l++) {
+            ft_bfmv('N', P[l], x);
+            if (D[l] != NULL)
+                for (int i = 0; i < n; i++)
+                    x[i] *= D[l][i];
+        }
+        ft_bfmv('N', V, y);
+        double err = ft_norm_2arg(x, y, n)/ft_norm_1arg(x, n);
+        printf("Comparison of a composite plan and its chain \t (n = %i) |%20.2e ", n, err);
+        ft_checktest(err, 8*sqrt(n), &checksum);
+        ft_destroy_tb_eigen_FMM(P[0]);
+        ft_destroy_tb_eigen_FMM(P[1]);
+        ft_destroy_tb_eigen_FMM(P[2]);
+        ft_destroy_tb_eigen_FMM(V);
+        free(d);
+        free(x);
+        free(y);
+    }
+    printf("\n\tPlans to a tolerance.\n\n");
+    n = 2048;
+    ft_tb_eigen_FMM * P = ft_plan_legendre_to_chebyshev(1, 1, n);
+    double ratio0 = 1;
+    for (double tol = 1e-12; tol < 1e-3; tol *= 1e4) {
+        ft_tb_eigen_FMM * Q = ft_plan_legendre_to_chebyshev_tol(1, 1, n, tol);
+        double * x = malloc(n*sizeof(double));
+        double * y = malloc(n*sizeof(double));
+        for (int i = 0; i < n; i++)
+            x[i] = y[i] = 1.0/(i+1);
+        ft_bfmv('N', P, x);
+        ft_bfmv('N', Q, y);
+        double err = ft_norm_2arg(x, y, n)/ft_norm_1arg(x, n);
+        printf("Comparison with the full plan \t\t (tol = %7.1e) |%20.2e ", tol, err);
+        ft_checktest(err, tol/eps(), &checksum);
+        double ratio = (double) ft_summary_size_tb_eigen_FMM(Q)/ft_summary_size_tb_eigen_FMM(P);
+        printf("Ratio of the sizes of the plans \t (tol = %7.1e) |%20.2e ", tol, ratio);
+        // Every coarser tolerance must give a smaller plan.
+        ft_checktest(ratio < ratio0 ? 0 : ratio, 1, &checksum);
+        ratio0 = ratio;
+        ft_destroy_tb_eigen_FMM(Q);
+        free(x);
+        free(y);
+    }
+    ft_destroy_tb_eigen_FMM(P);
+    // A tolerance below the working precision gives the same plan.
+    P = ft_plan_associated_jacobi_to_jacobi(1, n, 2, 0.5, -0.25, -0.125, 0.75);
+    ft_tb_eigen_FMM * Q = ft_plan_associated_jacobi_to_jacobi_tol(1, n, 2, 0.5, -0.25, -0.125, 0.75, eps()/4);
+    double * x = malloc(n*sizeof(double));
+    double * y = malloc(n*sizeof(double));
+    for (int i = 0; i < n; i++)
+        x[i] = y[i] = 1.0/(i+1);
+    ft_bfmv('N', P, x);
+    ft_bfmv('N', Q, y);
+    double err = ft_norm_2arg(x, y, n)/ft_norm_1arg(x, n) + fabs((double) ft_summary_size_tb_eigen_FMM(Q)/ft_summary_size_tb_eigen_FMM(P) - 1);
+    printf("Associated plan below the working precision \t\t |%20.2e ", err);
+    ft_checktest(err, 1, &checksum);
+    ft_destroy_tb_eigen_FMM(P);
+    ft_destroy_tb_eigen_FMM(Q);
+    free(x);
+    free(y);
+    printf("\n\tToeplitz-Hankel plans.\n\n");
+    for (n = 1000; n < 20000; n = 4*n+1) {
+        for (int norm = 0; norm < 4; norm++) {
+            int norm1 = norm&1, norm2 = norm>>1;
+            ft_tb_eigen_FMM * F = ft_plan_legendre_to_chebyshev(norm1, norm2, n);
+            ft_tb_eigen_FMM * G = ft_plan_chebyshev_to_legendre(norm1, norm2, n);
+            ft_toeplitz_hankel_plan * TF = ft_plan_legendre_to_chebyshev_th(norm1, norm2, n);
+            ft_toeplitz_hankel_plan * TG = ft_plan_chebyshev_to_legendre_th(norm1, norm2, n);
+            double * x = malloc(n*sizeof(double));
+            double * y = malloc(n*sizeof(double));
+            for (char TRANS = 'N'; TRANS <= 'T'; TRANS += 'T'-'N') {
+                for (int i = 0; i < n; i++)
+                    x[i] = y[i] = 1.0/(i+1);
+                ft_bfmv(TRANS, F, x);
+                ft_thmv(TRANS, TF, y);
+                double err = ft_norm_2arg(x, y, n)/ft_norm_1arg(x, n);
+                printf("Legendre-Chebyshev, FMM and Toeplitz-Hankel (%i, %i, %c, n = %5i) |%20.2e ", norm1, norm2, TRANS, n, err);
+                ft_checktest(err, 8*sqrt(n), &checksum);
+                for (int i = 0; i < n; i++)
+                    x[i] = y[i] = 1.0/(i+1);
+                ft_bfmv(TRANS, G, x);
+                ft_thmv(TRANS, TG, y);
+                err = ft_norm_2arg(x, y, n)/ft_norm_1arg(x, n);
+                printf("Chebyshev-Legendre, FMM and Toeplitz-Hankel (%i, %i, %c, n = %5i) |%20.2e ", norm1, norm2, TRANS, n, err);
+                ft_checktest(err, 8*sqrt(n), &checksum);
+            }
+            double * w = fftw_malloc(ft_work_size_toeplitz_hankel_plan(TG)*sizeof(double));
+            for (int i = 0; i < n; i++)
+                x[i] = y[i] = 1.0/(i+1);
+            ft_thmv('T', TG, x);
+            ft_thmv_work('T', TG, y, w);
+            double err = ft_norm_2arg(x, y, n)/ft_norm_1arg(x, n);
+            printf("Toeplitz-Hankel with the plan's and the caller's scratch (%i, %i) |%20.2e ", norm1, norm2, err);
+            ft_checktest(err, 1, &checksum);
+            fftw_free(w);
+            ft_destroy_tb_eigen_FMM(F);
+            ft_destroy_tb_eigen_FMM(G);
+            ft_destroy_toeplitz_hankel_plan(TF);
+            ft_destroy_toeplitz_hankel_plan(TG);
+            free(x);
+            free(y);
+        }
+    }
     printf("\n");
     return checksum;
 }